@@ -0,0 +1,65 @@
+#ifndef BATCHOPERATION_HPP
+#define BATCHOPERATION_HPP
+
+#include <string>
+
+#include "Result.hpp"
+
+namespace cse4733
+{
+
+    /**
+     * @brief The kinds of operation a batch can hold.
+     */
+    enum class BatchOperationType
+    {
+        /* Create an empty file, as FileSystem::createFile. */
+        Create,
+
+        /* Replace a file's content, as FileSystem::writeFile. */
+        Write,
+
+        /* Read a whole file, as FileSystem::readFile. */
+        Read,
+
+        /* Delete a file, as FileSystem::deleteFile. */
+        Delete
+    };
+
+    /**
+     * @brief The outcome of one operation in a batch; never ErrorCode::Unformatted, which fails the whole batch.
+     */
+    using BatchStatus = ErrorCode;
+
+    /**
+     * @struct BatchOperation
+     * @brief One operation submitted to FileSystem::runBatch.
+     */
+    struct BatchOperation
+    {
+        /* What to do. */
+        BatchOperationType type;
+
+        /* The path of the file, resolved like any other FileSystem path. */
+        std::string path;
+
+        /* The new content for a Write; ignored otherwise. */
+        std::string data;
+    };
+
+    /**
+     * @struct BatchResult
+     * @brief The outcome of one batch operation.
+     */
+    struct BatchResult
+    {
+        /* Whether the operation succeeded, or why it did not. */
+        BatchStatus status;
+
+        /* The file's content for a successful Read; empty otherwise. */
+        std::string data;
+    };
+
+} // namespace cse4733
+
+#endif // BATCHOPERATION_HPP
@@ -0,0 +1,411 @@
+#include "BlockCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+namespace cse4733
+{
+
+    BlockCache::BlockCache(std::unique_ptr<BlockStore> store, size_t capacityBytes)
+        : store(std::move(store)), blockSize(this->store->getBlockSize())
+    {
+        // 1. Size the frames from the budget, capped at the number of blocks the store holds
+        // 2. Use fewer shards for small budgets, so each shard has room to pick a victim
+        // 3. Keep spans to a fraction of a shard's frames, so a working set that fits the cache
+        //    is spread over every shard instead of crowding into one
+        // 4. Limit a prefetch to the spans that fill the smallest shard to half its frames;
+        //    spans are dealt to the shards in turn, so each gets the same number of blocks
+        // 5. Spread the frames evenly over the shards
+        size_t frameCount = std::min(capacityBytes / blockSize, this->store->getBlockCount());
+        shardCount = std::clamp<size_t>(frameCount / MIN_SHARD_FRAMES, 1, SHARD_COUNT);
+        frameCount = std::max(frameCount, shardCount);
+        capacity = frameCount;
+        size_t shardFrames = frameCount / shardCount;
+        shardSpan = std::clamp<size_t>(shardFrames / SPANS_PER_SHARD, 1, MAX_SHARD_SPAN);
+        prefetchLimit = shardFrames / 2 / shardSpan * shardSpan * shardCount;
+        shards = std::make_unique<Shard[]>(shardCount);
+        for (size_t i = 0; i < shardCount; ++i)
+        {
+            size_t frames = frameCount / shardCount + (i < frameCount % shardCount ? 1 : 0);
+            shards[i].frames.resize(frames);
+            shards[i].data = std::make_unique<char[]>(frames * blockSize);
+            shards[i].resident.reserve(frames);
+        }
+    }
+
+    BlockCache::~BlockCache()
+    {
+        try
+        {
+            flush();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Failed to write back cached blocks: " << e.what() << "\n";
+        }
+    }
+
+    BlockCache::Shard &BlockCache::shardFor(uint32_t block) const
+    {
+        return shards[(block / shardSpan) % shardCount];
+    }
+
+    char *BlockCache::frameData(Shard &shard, uint32_t frame) const
+    {
+        return shard.data.get() + static_cast<size_t>(frame) * blockSize;
+    }
+
+    void BlockCache::setDirty(Shard &shard, Frame &frame, bool dirty)
+    {
+        if (frame.dirty == dirty)
+        {
+            return;
+        }
+        frame.dirty = dirty;
+        if (dirty)
+        {
+            ++shard.dirtyCount;
+            dirtyTotal.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            --shard.dirtyCount;
+            dirtyTotal.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    void BlockCache::writeRun(Shard &shard, uint32_t start, uint32_t count)
+    {
+        // A single block is written straight from its frame; a run is gathered first.
+        // Frames are only marked clean once the store write has succeeded.
+        if (count == 1)
+        {
+            store->write(start, 1, frameData(shard, shard.resident.at(start)));
+        }
+        else
+        {
+            shard.writeBuffer.resize(static_cast<size_t>(count) * blockSize);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                std::memcpy(shard.writeBuffer.data() + static_cast<size_t>(i) * blockSize,
+                            frameData(shard, shard.resident.at(start + i)), blockSize);
+            }
+            store->write(start, count, shard.writeBuffer.data());
+        }
+        ++shard.storeWrites;
+        shard.writeBacks += count;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            setDirty(shard, shard.frames[shard.resident.at(start + i)], false);
+        }
+    }
+
+    void BlockCache::writeCluster(Shard &shard, uint32_t block)
+    {
+        // Grow the run both ways over resident dirty blocks, without leaving the block's span
+        auto dirtyResident = [&](uint32_t candidate) {
+            auto it = shard.resident.find(candidate);
+            return it != shard.resident.end() && shard.frames[it->second].dirty;
+        };
+        uint32_t spanStart = block - block % static_cast<uint32_t>(shardSpan);
+        uint32_t spanEnd = spanStart + static_cast<uint32_t>(shardSpan);
+        uint32_t first = block;
+        uint32_t last = block + 1;
+        while (first > spanStart && dirtyResident(first - 1))
+        {
+            --first;
+        }
+        while (last < spanEnd && dirtyResident(last))
+        {
+            ++last;
+        }
+        writeRun(shard, first, last - first);
+    }
+
+    uint32_t BlockCache::claimFrame(Shard &shard)
+    {
+        // 1. Sweep the hand over the frames, taking the first empty one
+        // 2. Clear the referenced bit of each recently used block passed over
+        // 3. Evict the first block not referenced since the last sweep, writing it back,
+        //    with its dirty neighbours, if it is dirty
+        while (true)
+        {
+            uint32_t index = static_cast<uint32_t>(shard.hand);
+            shard.hand = (shard.hand + 1) % shard.frames.size();
+            Frame &frame = shard.frames[index];
+            if (frame.block == NO_BLOCK)
+            {
+                return index;
+            }
+            if (frame.referenced)
+            {
+                frame.referenced = false;
+                continue;
+            }
+            if (frame.dirty)
+            {
+                writeCluster(shard, frame.block);
+            }
+            if (frame.prefetched)
+            {
+                ++shard.prefetchEvictions;
+            }
+            shard.resident.erase(frame.block);
+            frame = Frame();
+            ++shard.evictions;
+            return index;
+        }
+    }
+
+    uint32_t BlockCache::install(Shard &shard, uint32_t block, const char *data, bool referenced)
+    {
+        uint32_t index = claimFrame(shard);
+        std::memcpy(frameData(shard, index), data, blockSize);
+        Frame &frame = shard.frames[index];
+        frame.block = block;
+        frame.referenced = referenced;
+        shard.resident.emplace(block, index);
+        return index;
+    }
+
+    void BlockCache::touch(Shard &shard, uint32_t frame)
+    {
+        ++shard.hits;
+        Frame &entry = shard.frames[frame];
+        entry.referenced = true;
+        if (entry.prefetched)
+        {
+            entry.prefetched = false;
+            ++shard.prefetchHits;
+        }
+    }
+
+    uint32_t BlockCache::missingRun(Shard &shard, uint32_t block, uint32_t limit) const
+    {
+        uint32_t count = 0;
+        while (count < limit && shard.resident.find(block + count) == shard.resident.end())
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    const char *BlockCache::loadRun(Shard &shard, uint32_t start, uint32_t count)
+    {
+        shard.readBuffer.resize(static_cast<size_t>(count) * blockSize);
+        store->read(start, count, shard.readBuffer.data());
+        ++shard.storeReads;
+        return shard.readBuffer.data();
+    }
+
+    uint32_t BlockCache::frameFor(Shard &shard, uint32_t block, bool load)
+    {
+        auto it = shard.resident.find(block);
+        if (it != shard.resident.end())
+        {
+            touch(shard, it->second);
+            return it->second;
+        }
+
+        // The frame is only recorded once it is filled, so a failed load leaves it empty
+        ++shard.misses;
+        if (load)
+        {
+            return install(shard, block, loadRun(shard, block, 1), true);
+        }
+        uint32_t index = claimFrame(shard);
+        Frame &frame = shard.frames[index];
+        frame.block = block;
+        frame.referenced = true;
+        shard.resident.emplace(block, index);
+        return index;
+    }
+
+    void BlockCache::read(uint32_t block, size_t offset, char *out, size_t length)
+    {
+        // 1. Split the range at shard spans, so each piece is served under one lock
+        // 2. Copy resident blocks straight out of their frames
+        // 3. Load each run of missing blocks with one store read, copying the bytes out
+        //    before keeping the blocks, since keeping them may evict earlier ones
+        block += static_cast<uint32_t>(offset / blockSize);
+        offset %= blockSize;
+        while (length > 0)
+        {
+            Shard &shard = shardFor(block);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            uint32_t spanEnd = (block / shardSpan + 1) * static_cast<uint32_t>(shardSpan);
+            while (length > 0 && block < spanEnd)
+            {
+                auto it = shard.resident.find(block);
+                if (it != shard.resident.end())
+                {
+                    touch(shard, it->second);
+                    size_t chunk = std::min(length, blockSize - offset);
+                    std::memcpy(out, frameData(shard, it->second) + offset, chunk);
+                    out += chunk;
+                    length -= chunk;
+                    offset = 0;
+                    ++block;
+                    continue;
+                }
+
+                size_t wanted = (offset + length + blockSize - 1) / blockSize;
+                uint32_t run = missingRun(shard, block, static_cast<uint32_t>(std::min<size_t>(spanEnd - block, wanted)));
+                const char *data = loadRun(shard, block, run);
+                shard.misses += run;
+                for (uint32_t i = 0; i < run; ++i)
+                {
+                    const char *blockData = data + static_cast<size_t>(i) * blockSize;
+                    size_t chunk = std::min(length, blockSize - offset);
+                    std::memcpy(out, blockData + offset, chunk);
+                    out += chunk;
+                    length -= chunk;
+                    offset = 0;
+                    install(shard, block, blockData, true);
+                    ++block;
+                }
+            }
+        }
+    }
+
+    void BlockCache::prefetch(uint32_t start, uint32_t count)
+    {
+        // Same walk as read, but only missing blocks are touched; the range is cut to the prefetch
+        // limit, so each shard gives up at most half its frames
+        size_t end = std::min(static_cast<size_t>(start) + std::min<size_t>(count, prefetchLimit), store->getBlockCount());
+        size_t block = start;
+        while (block < end)
+        {
+            Shard &shard = shardFor(static_cast<uint32_t>(block));
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            size_t spanEnd = std::min((block / shardSpan + 1) * shardSpan, end);
+            while (block < spanEnd)
+            {
+                uint32_t run = missingRun(shard, static_cast<uint32_t>(block), static_cast<uint32_t>(spanEnd - block));
+                if (run == 0)
+                {
+                    ++block;
+                    continue;
+                }
+                const char *data = loadRun(shard, static_cast<uint32_t>(block), run);
+                for (uint32_t i = 0; i < run; ++i)
+                {
+                    uint32_t index = install(shard, static_cast<uint32_t>(block + i), data + static_cast<size_t>(i) * blockSize, false);
+                    shard.frames[index].prefetched = true;
+                }
+                shard.prefetchedBlocks += run;
+                block += run;
+            }
+        }
+    }
+
+    void BlockCache::write(uint32_t block, size_t offset, const char *data, size_t length, bool preserve)
+    {
+        Shard &shard = shardFor(block);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        uint32_t index = frameFor(shard, block, preserve && (offset != 0 || length != blockSize));
+        std::memcpy(frameData(shard, index) + offset, data, length);
+        setDirty(shard, shard.frames[index], true);
+    }
+
+    void BlockCache::discard(uint32_t start, uint32_t count)
+    {
+        for (uint32_t block = start; block < start + count; ++block)
+        {
+            Shard &shard = shardFor(block);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.resident.find(block);
+            if (it == shard.resident.end())
+            {
+                continue;
+            }
+            Frame &frame = shard.frames[it->second];
+            setDirty(shard, frame, false);
+            frame = Frame();
+            shard.resident.erase(it);
+        }
+    }
+
+    void BlockCache::writeBack()
+    {
+        // Sort each shard's dirty blocks so runs of neighbours go out in one store write each
+        std::vector<uint32_t> dirty;
+        for (size_t i = 0; i < shardCount; ++i)
+        {
+            Shard &shard = shards[i];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            dirty.clear();
+            for (const Frame &frame : shard.frames)
+            {
+                if (frame.dirty)
+                {
+                    dirty.push_back(frame.block);
+                }
+            }
+            std::sort(dirty.begin(), dirty.end());
+            size_t first = 0;
+            while (first < dirty.size())
+            {
+                size_t last = first + 1;
+                while (last < dirty.size() && dirty[last] == dirty[last - 1] + 1 && dirty[last] % shardSpan != 0)
+                {
+                    ++last;
+                }
+                writeRun(shard, dirty[first], static_cast<uint32_t>(last - first));
+                first = last;
+            }
+        }
+    }
+
+    bool BlockCache::needsWriteBack() const
+    {
+        return dirtyTotal.load(std::memory_order_relaxed) * 2 > capacity;
+    }
+
+    void BlockCache::flush()
+    {
+        writeBack();
+        store->sync();
+    }
+
+    CacheStats BlockCache::getStats() const
+    {
+        CacheStats stats;
+        for (size_t i = 0; i < shardCount; ++i)
+        {
+            const Shard &shard = shards[i];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            stats.hits += shard.hits;
+            stats.misses += shard.misses;
+            stats.evictions += shard.evictions;
+            stats.writeBacks += shard.writeBacks;
+            stats.storeReads += shard.storeReads;
+            stats.storeWrites += shard.storeWrites;
+            stats.prefetchedBlocks += shard.prefetchedBlocks;
+            stats.prefetchHits += shard.prefetchHits;
+            stats.prefetchEvictions += shard.prefetchEvictions;
+            stats.dirtyBlocks += shard.dirtyCount;
+            stats.residentBlocks += shard.resident.size();
+            stats.capacityBlocks += shard.frames.size();
+        }
+        return stats;
+    }
+
+    size_t BlockCache::getBlockSize() const
+    {
+        return blockSize;
+    }
+
+    size_t BlockCache::getCapacity() const
+    {
+        return capacity;
+    }
+
+    size_t BlockCache::getPrefetchLimit() const
+    {
+        return prefetchLimit;
+    }
+
+} // namespace cse4733
@@ -0,0 +1,362 @@
+#ifndef BLOCKCACHE_HPP
+#define BLOCKCACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "BlockStore.hpp"
+
+namespace cse4733
+{
+
+    /**
+     * @struct CacheStats
+     * @brief Counters describing a BlockCache, summed over its shards.
+     */
+    struct CacheStats
+    {
+        /* Accesses served from a resident frame. */
+        size_t hits = 0;
+
+        /* Accesses that had to claim a frame. */
+        size_t misses = 0;
+
+        /* Resident blocks dropped to make room for others. */
+        size_t evictions = 0;
+
+        /* Dirty blocks written to the store, by eviction, write-back or flush. */
+        size_t writeBacks = 0;
+
+        /* Read calls made to the store; each loads a run of consecutive blocks. */
+        size_t storeReads = 0;
+
+        /* Write calls made to the store; each writes back a run of consecutive blocks. */
+        size_t storeWrites = 0;
+
+        /* Blocks loaded by prefetch before anyone asked for them. */
+        size_t prefetchedBlocks = 0;
+
+        /* Hits on prefetched blocks, counted once per block. */
+        size_t prefetchHits = 0;
+
+        /* Prefetched blocks evicted before anyone used them. */
+        size_t prefetchEvictions = 0;
+
+        /* Resident blocks modified since they were last written to the store. */
+        size_t dirtyBlocks = 0;
+
+        /* Blocks currently held in frames. */
+        size_t residentBlocks = 0;
+
+        /* The number of frames, the most blocks that can be resident at once. */
+        size_t capacityBlocks = 0;
+    };
+
+    /**
+     * @class BlockCache
+     * @brief Bounded write-back cache of blocks in front of a BlockStore.
+     *
+     * Blocks are kept in a fixed number of frames sized from a memory budget. A miss
+     * claims a frame with the CLOCK algorithm: the hand sweeps the frames, giving each
+     * recently referenced block a second chance, and evicts the first block that has
+     * not been referenced since the hand last passed it. Writes only mark the frame
+     * dirty; the block reaches the store when it is evicted, written back or flushed.
+     *
+     * Store I/O is coalesced: a read loads each run of consecutive missing blocks with
+     * one store read, and writing back a dirty block takes its dirty neighbours along
+     * in the same store write. Blocks can also be prefetched ahead of a sequential
+     * reader; they enter unreferenced, so a prefetch that is never used is evicted first.
+     *
+     * Every method is safe to call from several threads at once. Frames are split
+     * over independently locked shards, each with its own clock hand. Blocks are
+     * assigned to shards in short spans, so neighbouring blocks share a shard for
+     * coalesced I/O, while a span is small next to a shard's frames so that any
+     * working set smaller than the cache spreads over all of the shards.
+     */
+    class BlockCache
+    {
+    public:
+        /**
+         * @brief Constructs an empty cache.
+         *
+         * @param store The store holding every block; the cache takes ownership.
+         * @param capacityBytes The memory budget for block frames, rounded down to whole blocks; at least one frame per shard is kept.
+         */
+        BlockCache(std::unique_ptr<BlockStore> store, size_t capacityBytes);
+
+        /**
+         * @brief Writes back every dirty block. Errors are reported on stderr, not thrown.
+         */
+        ~BlockCache();
+
+        BlockCache(const BlockCache &) = delete;
+        BlockCache &operator=(const BlockCache &) = delete;
+
+        /**
+         * @brief Copies length bytes starting at offset within a block into out, loading missing blocks.
+         *
+         * The range may continue into the following blocks.
+         *
+         * @throw BlockStoreException if the store fails.
+         */
+        void read(uint32_t block, size_t offset, char *out, size_t length);
+
+        /**
+         * @brief Loads the missing blocks of a range without copying them anywhere.
+         *
+         * Blocks past the end of the store are ignored, and the range is cut to
+         * getPrefetchLimit blocks, so at most half of each shard's frames are filled and
+         * a prefetch cannot flush the blocks a reader is using.
+         *
+         * @throw BlockStoreException if the store fails.
+         */
+        void prefetch(uint32_t start, uint32_t count);
+
+        /**
+         * @brief Copies length bytes into a block at offset and marks it dirty.
+         *
+         * On a miss the block is only loaded first if the write leaves part of it
+         * uncovered and preserve asks for the rest of its bytes to be kept.
+         *
+         * @param preserve False if the bytes outside the written range hold nothing worth keeping.
+         * @throw BlockStoreException if the store fails.
+         */
+        void write(uint32_t block, size_t offset, const char *data, size_t length, bool preserve = true);
+
+        /**
+         * @brief Drops count blocks starting at start without writing them back.
+         *
+         * Used when blocks are freed, since their contents no longer matter.
+         */
+        void discard(uint32_t start, uint32_t count);
+
+        /**
+         * @brief Writes back every dirty block, without syncing the store. The blocks stay resident.
+         *
+         * @throw BlockStoreException if the store fails.
+         */
+        void writeBack();
+
+        /**
+         * @brief Returns true once more than half of the frames are dirty, so a writeBack is due.
+         */
+        bool needsWriteBack() const;
+
+        /**
+         * @brief Writes back every dirty block, then syncs the store.
+         *
+         * @throw BlockStoreException if the store fails.
+         */
+        void flush();
+
+        /**
+         * @brief Returns the current counters.
+         */
+        CacheStats getStats() const;
+
+        /**
+         * @brief Returns the size of each block in bytes.
+         */
+        size_t getBlockSize() const;
+
+        /**
+         * @brief Returns the number of frames.
+         */
+        size_t getCapacity() const;
+
+        /**
+         * @brief Returns the most blocks one prefetch loads: whole rounds of spans over the shards
+         * that fill no shard past half its frames.
+         */
+        size_t getPrefetchLimit() const;
+
+    private:
+        /**
+         * @brief Marks a frame that holds no block.
+         */
+        static constexpr uint32_t NO_BLOCK = UINT32_MAX;
+
+        /**
+         * @brief The most shards a cache is split into.
+         */
+        static constexpr size_t SHARD_COUNT = 16;
+
+        /**
+         * @brief The fewest frames a shard gets before the cache uses fewer shards.
+         */
+        static constexpr size_t MIN_SHARD_FRAMES = 8;
+
+        /**
+         * @brief The most consecutive blocks assigned to the same shard.
+         */
+        static constexpr size_t MAX_SHARD_SPAN = 64;
+
+        /**
+         * @brief The part of a shard's frames one span may fill, as a divisor.
+         */
+        static constexpr size_t SPANS_PER_SHARD = 4;
+
+        /**
+         * @brief What one frame holds.
+         */
+        struct Frame
+        {
+            /* The resident block, or NO_BLOCK. */
+            uint32_t block = NO_BLOCK;
+
+            /* Set on every access; cleared as the clock hand passes. */
+            bool referenced = false;
+
+            /* Set when the frame differs from the store. */
+            bool dirty = false;
+
+            /* Set when the block was prefetched; cleared by its first hit. */
+            bool prefetched = false;
+        };
+
+        /**
+         * @brief One independently locked slice of the frames, on its own cache line.
+         */
+        struct alignas(64) Shard
+        {
+            /* Guards every other member, and the store I/O for this shard's blocks. */
+            mutable std::mutex mutex;
+
+            /* The frames' bookkeeping. */
+            std::vector<Frame> frames;
+
+            /* The frames' contents, back to back. */
+            std::unique_ptr<char[]> data;
+
+            /* Maps each resident block to its frame. */
+            std::unordered_map<uint32_t, uint32_t> resident;
+
+            /* The next frame the clock hand inspects. */
+            size_t hand = 0;
+
+            /* Holds a run of blocks being loaded from the store. */
+            std::vector<char> readBuffer;
+
+            /* Holds a run of blocks being written to the store; separate, since a load may evict. */
+            std::vector<char> writeBuffer;
+
+            size_t hits = 0;
+            size_t misses = 0;
+            size_t evictions = 0;
+            size_t writeBacks = 0;
+            size_t dirtyCount = 0;
+            size_t storeReads = 0;
+            size_t storeWrites = 0;
+            size_t prefetchedBlocks = 0;
+            size_t prefetchHits = 0;
+            size_t prefetchEvictions = 0;
+        };
+
+        /**
+         * @brief Returns the shard holding a block.
+         */
+        Shard &shardFor(uint32_t block) const;
+
+        /**
+         * @brief Returns the contents of a frame.
+         */
+        char *frameData(Shard &shard, uint32_t frame) const;
+
+        /**
+         * @brief Returns the frame holding a block, claiming one on a miss. The shard must be locked.
+         *
+         * @param load Whether a newly claimed frame is filled from the store.
+         */
+        uint32_t frameFor(Shard &shard, uint32_t block, bool load);
+
+        /**
+         * @brief Advances the clock hand to a free frame, evicting a block if needed. The shard must be locked.
+         */
+        uint32_t claimFrame(Shard &shard);
+
+        /**
+         * @brief Copies a block into a newly claimed frame and returns the frame. The shard must be locked and the block not resident.
+         */
+        uint32_t install(Shard &shard, uint32_t block, const char *data, bool referenced);
+
+        /**
+         * @brief Counts a hit on a resident frame. The shard must be locked.
+         */
+        void touch(Shard &shard, uint32_t frame);
+
+        /**
+         * @brief Returns the length of the run of non-resident blocks starting at block, at most limit. The shard must be locked.
+         */
+        uint32_t missingRun(Shard &shard, uint32_t block, uint32_t limit) const;
+
+        /**
+         * @brief Loads a run of blocks from the store into the shard's read buffer. The shard must be locked.
+         */
+        const char *loadRun(Shard &shard, uint32_t start, uint32_t count);
+
+        /**
+         * @brief Writes back a dirty block together with the dirty blocks adjacent to it, in one store write.
+         *
+         * The run stays within the block's shard span. The shard must be locked.
+         */
+        void writeCluster(Shard &shard, uint32_t block);
+
+        /**
+         * @brief Writes back a run of dirty resident blocks in one store write and marks them clean. The shard must be locked.
+         */
+        void writeRun(Shard &shard, uint32_t start, uint32_t count);
+
+        /**
+         * @brief Marks a resident frame dirty or clean, keeping the dirty counts current. The shard must be locked.
+         */
+        void setDirty(Shard &shard, Frame &frame, bool dirty);
+
+        /**
+         * @brief The backing store.
+         */
+        std::unique_ptr<BlockStore> store;
+
+        /**
+         * @brief The size of each block in bytes.
+         */
+        size_t blockSize;
+
+        /**
+         * @brief The number of shards, at least one.
+         */
+        size_t shardCount;
+
+        /**
+         * @brief The number of consecutive blocks assigned to the same shard, at most a quarter of a shard's frames.
+         */
+        size_t shardSpan;
+
+        /**
+         * @brief The number of frames over all shards.
+         */
+        size_t capacity;
+
+        /**
+         * @brief The most blocks one prefetch loads.
+         */
+        size_t prefetchLimit;
+
+        /**
+         * @brief Dirty frames over all shards, readable without taking the shard locks.
+         */
+        std::atomic<size_t> dirtyTotal{0};
+
+        /**
+         * @brief The shards.
+         */
+        std::unique_ptr<Shard[]> shards;
+    };
+
+} // namespace cse4733
+
+#endif // BLOCKCACHE_HPP
@@ -1,52 +1,467 @@
 #include "BlockManager.hpp"
+#include "CorruptDataException.hpp"
+#include "Crc32c.hpp"
 #include "InvalidBlockIndexException.hpp"
 #include "NoFreeBlockAvailableException.hpp"
 
 #include <cstddef>
+#include <cstring>
 #include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <new>
+#include <stdexcept>
 
 namespace cse4733
 {
 
-    BlockManager::BlockManager(size_t totalBlocks)
-        : blockSize(64),
-          blocks(totalBlocks),
-          freeBlocks(totalBlocks, true)
+    namespace
     {
+        // Hands each thread the next slot the first time it allocates, spreading threads over the groups
+        std::atomic<size_t> nextThreadSlot{0};
+
+        size_t threadSlot()
+        {
+            thread_local size_t slot = nextThreadSlot.fetch_add(1, std::memory_order_relaxed);
+            return slot;
+        }
+    } // namespace
+
+    BlockManager::BlockManager(size_t totalBlocks, size_t blockSize, AllocationPolicy policy)
+        : blockSize(blockSize),
+          totalBlocks(totalBlocks),
+          policy(policy),
+          ownedArena(static_cast<char *>(::operator new[](totalBlocks * blockSize, std::align_val_t(ARENA_ALIGNMENT)))),
+          ownedLengths(totalBlocks, 0),
+          ownedShareCounts(totalBlocks, 0),
+          ownedChecksums(totalBlocks, 0),
+          ownedBitmapWords(FreeSpaceBitmap::wordsFor(totalBlocks)),
+          verifyOnRead(true),
+          buddy(policy == AllocationPolicy::Buddy ? totalBlocks : 0),
+          fingerprints(std::make_unique<FingerprintIndex>()),
+          scrubState(std::make_unique<ScrubState>())
+    {
+        // The arena is left uninitialized; blockLengths marks every block as empty,
+        // so untouched pages are never read and the OS only commits what is written.
+        arena = ownedArena.get();
+        initializeOwned();
+    }
+
+    BlockManager::BlockManager(size_t totalBlocks, size_t blockSize, AllocationPolicy policy,
+                               std::unique_ptr<BlockStore> store, size_t cacheBytes)
+        : blockSize(blockSize),
+          totalBlocks(totalBlocks),
+          policy(policy),
+          arena(nullptr),
+          ownedLengths(totalBlocks, 0),
+          ownedShareCounts(totalBlocks, 0),
+          ownedChecksums(totalBlocks, 0),
+          ownedBitmapWords(FreeSpaceBitmap::wordsFor(totalBlocks)),
+          verifyOnRead(true),
+          buddy(policy == AllocationPolicy::Buddy ? totalBlocks : 0),
+          fingerprints(std::make_unique<FingerprintIndex>()),
+          scrubState(std::make_unique<ScrubState>())
+    {
+        cache = std::make_unique<BlockCache>(std::move(store), cacheBytes);
+        initializeOwned();
+    }
+
+    void BlockManager::initializeOwned()
+    {
+        blockLengths = ownedLengths.data();
+        shareCounts = ownedShareCounts.data();
+        checksums = ownedChecksums.data();
+        FreeSpaceBitmap::clear(ownedBitmapWords.data(), totalBlocks);
+        createGroups(ownedBitmapWords.data());
+        for (size_t i = 0; i < groupCount; ++i)
+        {
+            AllocationGroup &group = groups[i];
+            if (policy == AllocationPolicy::BestFit && group.length > 0)
+            {
+                insertFreeExtent(group, group.start, group.length);
+            }
+            group.freeIndexBuilt = true;
+        }
+    }
+
+    BlockManager::BlockManager(size_t totalBlocks, size_t blockSize, AllocationPolicy policy, const BlockRegions &regions)
+        : blockSize(blockSize),
+          totalBlocks(totalBlocks),
+          policy(policy),
+          arena(regions.data),
+          blockLengths(regions.lengths),
+          shareCounts(regions.shareCounts),
+          checksums(regions.checksums),
+          verifyOnRead(true),
+          buddy(policy == AllocationPolicy::Buddy ? totalBlocks : 0, false),
+          fingerprints(std::make_unique<FingerprintIndex>()),
+          scrubState(std::make_unique<ScrubState>())
+    {
+        createGroups(regions.bitmapWords);
+    }
+
+    void BlockManager::createGroups(uint64_t *bitmapWords)
+    {
+        // 1. Buddies merge across the whole volume, so the buddy policy gets a single group
+        // 2. Otherwise aim for MAX_GROUPS groups, none smaller than GROUP_ALIGNMENT blocks
+        // 3. Round the group size up to GROUP_ALIGNMENT and attach each group to its words
+        if (policy == AllocationPolicy::Buddy)
+        {
+            groupBlocks = std::max<size_t>(totalBlocks, 1);
+        }
+        else
+        {
+            size_t wanted = std::clamp<size_t>(totalBlocks / GROUP_ALIGNMENT, 1, MAX_GROUPS);
+            groupBlocks = (totalBlocks + wanted - 1) / wanted;
+            groupBlocks = std::max<size_t>((groupBlocks + GROUP_ALIGNMENT - 1) / GROUP_ALIGNMENT, 1) * GROUP_ALIGNMENT;
+        }
+        groupCount = std::max<size_t>((totalBlocks + groupBlocks - 1) / groupBlocks, 1);
+        groups = std::make_unique<AllocationGroup[]>(groupCount);
+
+        for (size_t i = 0; i < groupCount; ++i)
+        {
+            AllocationGroup &group = groups[i];
+            size_t start = i * groupBlocks;
+            size_t length = std::min(groupBlocks, totalBlocks - std::min(start, totalBlocks));
+            uint64_t *words = bitmapWords + start / 64;
+            group.start = static_cast<uint32_t>(start);
+            group.length = static_cast<uint32_t>(length);
+            group.freeBlocks = FreeSpaceBitmap(words, length, FreeSpaceBitmap::countFree(words, length));
+        }
+    }
+
+    BlockManager::AllocationGroup &BlockManager::groupOf(uint32_t blockIndex) const
+    {
+        return groups[blockIndex / groupBlocks];
+    }
+
+    size_t BlockManager::homeGroup() const
+    {
+        return threadSlot() % groupCount;
+    }
+
+    void BlockManager::ensureFreeIndex(AllocationGroup &group)
+    {
+        // Walk the group's bitmap run by run and feed each free run to the active policy
+        if (group.freeIndexBuilt)
+        {
+            return;
+        }
+        group.freeIndexBuilt = true;
+
+        size_t position = 0;
+        while (position < group.length)
+        {
+            size_t runStart = group.freeBlocks.findFree(position);
+            if (runStart == FreeSpaceBitmap::npos || runStart < position)
+            {
+                break;
+            }
+            size_t runEnd = group.freeBlocks.findUsed(runStart);
+            uint32_t start = group.start + static_cast<uint32_t>(runStart);
+            uint32_t length = static_cast<uint32_t>(runEnd - runStart);
+            if (policy == AllocationPolicy::Buddy)
+            {
+                buddy.free(start, length);
+            }
+            else
+            {
+                insertFreeExtent(group, start, length);
+            }
+            position = runEnd;
+        }
+    }
+
+    size_t BlockManager::largestFreeRun(AllocationGroup &group)
+    {
+        ensureFreeIndex(group);
+        if (policy == AllocationPolicy::Buddy)
+        {
+            return buddy.getLargestFreeRun();
+        }
+        return group.freeExtentsBySize.empty() ? 0 : std::prev(group.freeExtentsBySize.end())->first;
+    }
+
+    void BlockManager::ArenaDeleter::operator()(char *arena) const
+    {
+        ::operator delete[](arena, std::align_val_t(ARENA_ALIGNMENT));
+    }
+
+    char *BlockManager::blockPointer(unsigned int blockIndex) const
+    {
+        return arena + static_cast<size_t>(blockIndex) * blockSize;
+    }
+
+    void BlockManager::copyIn(size_t position, const char *data, size_t size, bool preserve)
+    {
+        // Without an arena the range is split at block boundaries; a block that holds
+        // no valid bytes yet never needs loading, whatever the caller asks
+        if (arena)
+        {
+            std::memcpy(arena + position, data, size);
+            return;
+        }
+        while (size > 0)
+        {
+            uint32_t block = static_cast<uint32_t>(position / blockSize);
+            size_t offset = position % blockSize;
+            size_t chunk = std::min(size, blockSize - offset);
+            cache->write(block, offset, data, chunk, preserve && blockLengths[block] != 0);
+            position += chunk;
+            data += chunk;
+            size -= chunk;
+        }
+    }
+
+    void BlockManager::copyOut(size_t position, char *out, size_t size) const
+    {
+        // The cache loads the missing blocks of the whole range in runs, so it gets the range in one call
+        if (arena)
+        {
+            std::memcpy(out, arena + position, size);
+            return;
+        }
+        if (size > 0)
+        {
+            cache->read(static_cast<uint32_t>(position / blockSize), position % blockSize, out, size);
+        }
+    }
+
+    const char *BlockManager::blockContents(uint32_t blockIndex, std::vector<char> &scratch) const
+    {
+        if (arena)
+        {
+            return blockPointer(blockIndex);
+        }
+        scratch.resize(blockSize);
+        copyOut(static_cast<size_t>(blockIndex) * blockSize, scratch.data(), blockLengths[blockIndex]);
+        return scratch.data();
+    }
+
+    void BlockManager::checkExtent(const Extent &extent) const
+    {
+        if (static_cast<size_t>(extent.start) + extent.length > totalBlocks)
+        {
+            throw InvalidBlockIndexException(extent.start + extent.length - 1);
+        }
+    }
+
+    void BlockManager::updateChecksums(uint32_t start, uint32_t length)
+    {
+        std::vector<char> scratch;
+        for (uint32_t block = start; block < start + length; ++block)
+        {
+            checksums[block] = Crc32c::compute(blockContents(block, scratch), blockLengths[block]);
+        }
+    }
+
+    bool BlockManager::checksumMatches(uint32_t blockIndex) const
+    {
+        std::vector<char> scratch;
+        return Crc32c::compute(blockContents(blockIndex, scratch), blockLengths[blockIndex]) == checksums[blockIndex];
+    }
+
+    void BlockManager::verifyBlocks(uint32_t start, uint32_t length) const
+    {
+        if (!verifyOnRead)
+        {
+            return;
+        }
+        for (uint32_t block = start; block < start + length; ++block)
+        {
+            if (!checksumMatches(block))
+            {
+                throw CorruptDataException("checksum mismatch in block " + std::to_string(block));
+            }
+        }
+    }
+
+    void BlockManager::carveFreeExtent(AllocationGroup &group, uint32_t start, uint32_t length)
+    {
+        // 1. Find the free run that contains start (the last run beginning at or before it)
+        // 2. Remove that run from both indexes
+        // 3. Re-insert whatever is left on either side of the carved range
+        auto it = std::prev(group.freeExtentsByStart.upper_bound(start));
+        uint32_t runStart = it->first;
+        uint32_t runLength = it->second;
+        group.freeExtentsByStart.erase(it);
+        group.freeExtentsBySize.erase({runLength, runStart});
+
+        if (start > runStart)
+        {
+            uint32_t leftLength = start - runStart;
+            group.freeExtentsByStart.emplace(runStart, leftLength);
+            group.freeExtentsBySize.emplace(leftLength, runStart);
+        }
+        uint32_t runEnd = runStart + runLength;
+        uint32_t carvedEnd = start + length;
+        if (carvedEnd < runEnd)
+        {
+            uint32_t rightLength = runEnd - carvedEnd;
+            group.freeExtentsByStart.emplace(carvedEnd, rightLength);
+            group.freeExtentsBySize.emplace(rightLength, carvedEnd);
+        }
+    }
+
+    Extent BlockManager::takeRun(AllocationGroup &group, size_t length)
+    {
+        // 1. Under the buddy policy, let the buddy allocator pick and split a run
+        // 2. Otherwise take the best-fit run from the group's free-extent index
+        // 3. Mark the chosen blocks used in the bitmap
+        ensureFreeIndex(group);
+        Extent extent;
+        if (policy == AllocationPolicy::Buddy)
+        {
+            extent = buddy.allocate(length);
+        }
+        else
+        {
+            auto it = group.freeExtentsBySize.lower_bound({static_cast<uint32_t>(length), 0});
+            if (length == 0 || it == group.freeExtentsBySize.end())
+            {
+                throw cse4733::NoFreeBlockAvailableException();
+            }
+            extent = Extent{it->second, static_cast<uint32_t>(length)};
+            carveFreeExtent(group, extent.start, extent.length);
+        }
+        group.freeBlocks.markRangeUsed(extent.start - group.start, extent.length);
+        return extent;
+    }
+
+    void BlockManager::dropReferences(AllocationGroup &group, uint32_t start, uint32_t length,
+                                      const std::unique_lock<std::mutex> &indexLock)
+    {
+        // Blocks that are already free or still shared split the range into separately released runs
+        ensureFreeIndex(group);
+        uint32_t end = start + length;
+        uint32_t runStart = start;
+        for (uint32_t block = start; block <= end; ++block)
+        {
+            if (block == end || group.freeBlocks.isFree(block - group.start) || shareCounts[block] > 0)
+            {
+                if (block > runStart)
+                {
+                    if (indexLock.owns_lock())
+                    {
+                        forgetFingerprints(runStart, block - runStart);
+                    }
+                    releaseRun(group, runStart, block - runStart);
+                    group.freeBlocks.markRangeFree(runStart - group.start, block - runStart);
+                }
+                if (block < end && shareCounts[block] > 0)
+                {
+                    --shareCounts[block];
+                }
+                runStart = block + 1;
+            }
+        }
+    }
+
+    void BlockManager::releaseRun(AllocationGroup &group, uint32_t start, uint32_t length)
+    {
+        // Freed blocks hold no valid data until they are written again, so cached copies need no write-back
+        std::fill(blockLengths + start, blockLengths + start + length, 0);
+        std::fill(checksums + start, checksums + start + length, 0);
+        if (cache)
+        {
+            cache->discard(start, length);
+        }
+        if (policy == AllocationPolicy::Buddy)
+        {
+            buddy.free(start, length);
+        }
+        else
+        {
+            insertFreeExtent(group, start, length);
+        }
+    }
+
+    void BlockManager::insertFreeExtent(AllocationGroup &group, uint32_t start, uint32_t length)
+    {
+        // 1. Merge with the preceding run if it ends exactly where this one starts
+        // 2. Merge with the following run if it starts exactly where this one ends
+        // 3. Insert the merged run into both indexes
+        auto next = group.freeExtentsByStart.lower_bound(start);
+        if (next != group.freeExtentsByStart.begin())
+        {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == start)
+            {
+                start = prev->first;
+                length += prev->second;
+                group.freeExtentsBySize.erase({prev->second, prev->first});
+                group.freeExtentsByStart.erase(prev);
+            }
+        }
+        if (next != group.freeExtentsByStart.end() && start + length == next->first)
+        {
+            length += next->second;
+            group.freeExtentsBySize.erase({next->second, next->first});
+            group.freeExtentsByStart.erase(next);
+        }
+        group.freeExtentsByStart.emplace(start, length);
+        group.freeExtentsBySize.emplace(length, start);
     }
 
     unsigned int BlockManager::allocateBlock()
     {
-        // 1. Use std::find_if to find the first free block
-        // 2. Check if a free block was found
-        //    a. Mark the block as allocated
-        //    b. Return the index of the allocated block
-        // 3. No free block available, throw NoFreeBlockAvailableException
-        auto it = std::find_if(freeBlocks.begin(), freeBlocks.end(), [](bool isFree)
-                               { return isFree; });
+        Result<unsigned int> blockIndex = tryAllocateBlock();
+        if (!blockIndex)
+        {
+            throw cse4733::NoFreeBlockAvailableException();
+        }
+        return blockIndex.value();
+    }
 
-        // Check if a free block was found
-        if (it != freeBlocks.end())
+    Result<unsigned int> BlockManager::tryAllocateBlock()
+    {
+        // 1. Try the home group first, then each following group in turn
+        // 2. Take a block from the first group that has one
+        // 3. Every group is full, report ErrorCode::NoSpace
+        size_t home = homeGroup();
+        for (size_t i = 0; i < groupCount; ++i)
+        {
+            AllocationGroup &group = groups[(home + i) % groupCount];
+            std::lock_guard<std::mutex> guard(group.mutex);
+            if (group.freeBlocks.getFreeCount() > 0)
+            {
+                return takeBlock(group);
+            }
+        }
+        return ErrorCode::NoSpace;
+    }
+
+    unsigned int BlockManager::takeBlock(AllocationGroup &group)
+    {
+        // 1. Under the buddy policy, take a one-block run from the buddy allocator
+        // 2. Otherwise search the group's bitmap starting at its next-fit cursor
+        // 3. Mark the block as allocated, advance the cursor past it and return it
+        if (policy == AllocationPolicy::Buddy)
         {
-            // Mark the block as allocated
-            *it = false;
-            // Return the index of the allocated block
-            return std::distance(freeBlocks.begin(), it);
+            return takeRun(group, 1).start;
         }
+        ensureFreeIndex(group);
 
-        // No free block available
-        throw cse4733::NoFreeBlockAvailableException();
+        size_t slot = group.freeBlocks.findFree(group.nextFitCursor);
+        group.freeBlocks.markUsed(slot);
+        unsigned int blockIndex = group.start + static_cast<unsigned int>(slot);
+        carveFreeExtent(group, blockIndex, 1);
+        group.nextFitCursor = slot + 1 < group.length ? slot + 1 : 0;
+        return blockIndex;
     }
 
     void BlockManager::freeBlock(unsigned int blockIndex)
     {
         // 1. Check if the block index is within bounds
-        //   a. Mark the block as free
+        //   a. Drop one reference if the block is shared
+        //   b. Otherwise mark the block as free
         // 2. If the block index is out of bounds, throw InvalidBlockIndexException
-        if (blockIndex < freeBlocks.size())
+        if (blockIndex < totalBlocks)
         {
-            freeBlocks[blockIndex] = true;
+            std::unique_lock<std::mutex> indexLock = lockFingerprintIndex();
+            AllocationGroup &group = groupOf(blockIndex);
+            std::lock_guard<std::mutex> guard(group.mutex);
+            dropReferences(group, blockIndex, 1, indexLock);
         }
         else
         {
@@ -103,14 +518,336 @@ namespace cse4733
         return allocatedBlocks;
     }
 
+    Extent BlockManager::allocateExtent(size_t length)
+    {
+        Result<Extent> extent = tryAllocateExtent(length);
+        if (!extent)
+        {
+            throw cse4733::NoFreeBlockAvailableException();
+        }
+        return extent.value();
+    }
+
+    Result<Extent> BlockManager::tryAllocateExtent(size_t length)
+    {
+        // Best fit (or the smallest buddy order) in the first group, from home onwards, that holds the whole request
+        size_t home = homeGroup();
+        for (size_t i = 0; i < groupCount && length > 0; ++i)
+        {
+            AllocationGroup &group = groups[(home + i) % groupCount];
+            std::lock_guard<std::mutex> guard(group.mutex);
+            if (largestFreeRun(group) >= length)
+            {
+                return takeRun(group, length);
+            }
+        }
+        return ErrorCode::NoSpace;
+    }
+
+    std::vector<Extent> BlockManager::allocateExtents(size_t numBlocks)
+    {
+        Result<std::vector<Extent>> extents = tryAllocateExtents(numBlocks);
+        if (!extents)
+        {
+            throw cse4733::NoFreeBlockAvailableException();
+        }
+        return std::move(extents).value();
+    }
+
+    Result<std::vector<Extent>> BlockManager::tryAllocateExtents(size_t numBlocks)
+    {
+        // 1. Take a single run for the whole request from the first group, from home onwards, that holds one
+        // 2. Otherwise take the largest free runs, draining the home group before moving to the next
+        // 3. If the groups run dry first, give back everything taken and report ErrorCode::NoSpace
+        // 4. Return the extents in allocation order
+        if (numBlocks == 0)
+        {
+            return std::vector<Extent>();
+        }
+        size_t home = homeGroup();
+        for (size_t i = 0; i < groupCount; ++i)
+        {
+            AllocationGroup &group = groups[(home + i) % groupCount];
+            std::lock_guard<std::mutex> guard(group.mutex);
+            if (largestFreeRun(group) >= numBlocks)
+            {
+                return std::vector<Extent>{takeRun(group, numBlocks)};
+            }
+        }
+
+        std::vector<Extent> extents;
+        size_t remaining = numBlocks;
+        for (size_t i = 0; i < groupCount && remaining > 0; ++i)
+        {
+            AllocationGroup &group = groups[(home + i) % groupCount];
+            std::lock_guard<std::mutex> guard(group.mutex);
+            while (remaining > 0 && group.freeBlocks.getFreeCount() > 0)
+            {
+                Extent extent = takeRun(group, std::min(remaining, largestFreeRun(group)));
+                extents.push_back(extent);
+                remaining -= extent.length;
+            }
+        }
+        if (remaining > 0)
+        {
+            for (const Extent &extent : extents)
+            {
+                freeExtent(extent);
+            }
+            return ErrorCode::NoSpace;
+        }
+        return extents;
+    }
+
+    size_t BlockManager::extendExtent(Extent &extent, size_t maxBlocks)
+    {
+        // 1. Count the free blocks that immediately follow the extent, up to the end of their group
+        // 2. Carve them out of the free run that starts at the extent's end
+        // 3. Mark them used and grow the extent
+        if (policy != AllocationPolicy::BestFit)
+        {
+            return 0;
+        }
+        checkExtent(extent);
+        size_t end = static_cast<size_t>(extent.start) + extent.length;
+        if (end >= totalBlocks)
+        {
+            return 0;
+        }
+        AllocationGroup &group = groupOf(static_cast<uint32_t>(end));
+        std::lock_guard<std::mutex> guard(group.mutex);
+        ensureFreeIndex(group);
+
+        size_t groupEnd = static_cast<size_t>(group.start) + group.length;
+        size_t taken = 0;
+        while (taken < maxBlocks && end + taken < groupEnd && group.freeBlocks.isFree(end + taken - group.start))
+        {
+            ++taken;
+        }
+        if (taken > 0)
+        {
+            carveFreeExtent(group, static_cast<uint32_t>(end), static_cast<uint32_t>(taken));
+            group.freeBlocks.markRangeUsed(end - group.start, taken);
+            extent.length += static_cast<uint32_t>(taken);
+        }
+        return taken;
+    }
+
+    void BlockManager::freeExtent(const Extent &extent)
+    {
+        // 1. Validate the extent against the volume size
+        // 2. Split it at group boundaries and lock each group in turn
+        // 3. Drop one reference from every shared block and release the rest
+        checkExtent(extent);
+        std::unique_lock<std::mutex> indexLock = lockFingerprintIndex();
+
+        uint32_t end = extent.start + extent.length;
+        for (uint32_t pieceStart = extent.start; pieceStart < end;)
+        {
+            AllocationGroup &group = groupOf(pieceStart);
+            uint32_t pieceEnd = std::min(end, group.start + group.length);
+            std::lock_guard<std::mutex> guard(group.mutex);
+            dropReferences(group, pieceStart, pieceEnd - pieceStart, indexLock);
+            pieceStart = pieceEnd;
+        }
+    }
+
+    void BlockManager::shareExtent(const Extent &extent)
+    {
+        checkExtent(extent);
+        uint32_t end = extent.start + extent.length;
+        for (uint32_t pieceStart = extent.start; pieceStart < end;)
+        {
+            AllocationGroup &group = groupOf(pieceStart);
+            uint32_t pieceEnd = std::min(end, group.start + group.length);
+            std::lock_guard<std::mutex> guard(group.mutex);
+            for (uint32_t block = pieceStart; block < pieceEnd; ++block)
+            {
+                ++shareCounts[block];
+            }
+            pieceStart = pieceEnd;
+        }
+    }
+
+    uint64_t BlockManager::fingerprint(const char *data, size_t size)
+    {
+        // Mix the contents a word at a time with a multiply and xor-shift, then finalize
+        uint64_t hash = 0x9E3779B97F4A7C15ull ^ size;
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+        {
+            uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+            hash ^= hash >> 32;
+        }
+        if (i < size)
+        {
+            uint64_t word = 0;
+            std::memcpy(&word, data + i, size - i);
+            hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+        }
+        hash ^= hash >> 33;
+        hash *= 0xC4CEB9FE1A85EC53ull;
+        return hash ^ (hash >> 33);
+    }
+
+    std::unique_lock<std::mutex> BlockManager::lockFingerprintIndex() const
+    {
+        if (!fingerprints->populated.load(std::memory_order_acquire))
+        {
+            return std::unique_lock<std::mutex>();
+        }
+        return std::unique_lock<std::mutex>(fingerprints->mutex);
+    }
+
+    void BlockManager::forgetFingerprints(uint32_t start, uint32_t length)
+    {
+        // Only blocks whose current contents hash to an entry naming them are in the index
+        std::unordered_map<uint64_t, uint32_t> &entries = fingerprints->entries;
+        if (entries.empty())
+        {
+            return;
+        }
+        std::vector<char> scratch;
+        for (uint32_t block = start; block < start + length; ++block)
+        {
+            auto it = entries.find(fingerprint(blockContents(block, scratch), blockLengths[block]));
+            if (it != entries.end() && it->second == block)
+            {
+                entries.erase(it);
+            }
+        }
+    }
+
+    unsigned int BlockManager::storeBlock(const char *data, size_t size)
+    {
+        Result<unsigned int> blockIndex = tryStoreBlock(data, size);
+        if (!blockIndex)
+        {
+            throw cse4733::NoFreeBlockAvailableException();
+        }
+        return blockIndex.value();
+    }
+
+    Result<unsigned int> BlockManager::tryStoreBlock(const char *data, size_t size)
+    {
+        // 1. Look the contents up in the fingerprint index
+        // 2. On a hit with identical bytes, take another reference to the indexed block
+        // 3. Otherwise allocate a block, copy the data in and index it
+        //
+        // The index lock is held throughout, so an indexed block cannot be freed before
+        // its new reference is counted: freeing forgets a block under the same lock.
+        size = std::min(size, blockSize);
+        uint64_t hash = fingerprint(data, size);
+        std::lock_guard<std::mutex> indexGuard(fingerprints->mutex);
+        fingerprints->populated.store(true, std::memory_order_release);
+        ++fingerprints->logicalBlocks;
+
+        auto it = fingerprints->entries.find(hash);
+        std::vector<char> scratch;
+        if (it != fingerprints->entries.end() && blockLengths[it->second] == size &&
+            std::memcmp(blockContents(it->second, scratch), data, size) == 0)
+        {
+            AllocationGroup &group = groupOf(it->second);
+            std::lock_guard<std::mutex> guard(group.mutex);
+            ++shareCounts[it->second];
+            return it->second;
+        }
+
+        Result<unsigned int> allocated = tryAllocateBlock();
+        if (!allocated)
+        {
+            return allocated;
+        }
+        unsigned int blockIndex = allocated.value();
+        copyIn(static_cast<size_t>(blockIndex) * blockSize, data, size, false);
+        blockLengths[blockIndex] = static_cast<uint32_t>(size);
+        updateChecksums(blockIndex, 1);
+        fingerprints->entries[hash] = blockIndex;
+        ++fingerprints->storedBlocks;
+        return blockIndex;
+    }
+
+    DedupStats BlockManager::getDedupStats() const
+    {
+        // Each index entry is a heap node holding the key, value, next pointer and cached hash
+        std::lock_guard<std::mutex> indexGuard(fingerprints->mutex);
+        const std::unordered_map<uint64_t, uint32_t> &entries = fingerprints->entries;
+        size_t nodeBytes = sizeof(std::pair<const uint64_t, uint32_t>) + 2 * sizeof(void *);
+        size_t indexBytes = entries.size() * nodeBytes + entries.bucket_count() * sizeof(void *);
+        return DedupStats{fingerprints->logicalBlocks, fingerprints->storedBlocks, entries.size(), indexBytes};
+    }
+
+    uint32_t BlockManager::getReferenceCount(unsigned int blockIndex) const
+    {
+        if (blockIndex >= totalBlocks)
+        {
+            throw InvalidBlockIndexException(blockIndex);
+        }
+        AllocationGroup &group = groupOf(blockIndex);
+        std::lock_guard<std::mutex> guard(group.mutex);
+        return group.freeBlocks.isFree(blockIndex - group.start) ? 0 : shareCounts[blockIndex] + 1;
+    }
+
+    void BlockManager::unindexExtent(const Extent &extent)
+    {
+        checkExtent(extent);
+        std::unique_lock<std::mutex> indexLock = lockFingerprintIndex();
+        if (indexLock.owns_lock())
+        {
+            forgetFingerprints(extent.start, extent.length);
+        }
+    }
+
+    void BlockManager::copyExtent(const Extent &source, uint32_t destination)
+    {
+        // Blocks are contiguous in the arena, so one memcpy moves the whole run; cached blocks are copied one at a time
+        checkExtent(source);
+        checkExtent(Extent{destination, source.length});
+        {
+            std::unique_lock<std::mutex> indexLock = lockFingerprintIndex();
+            if (indexLock.owns_lock())
+            {
+                forgetFingerprints(destination, source.length);
+            }
+        }
+        if (arena)
+        {
+            std::memcpy(blockPointer(destination), blockPointer(source.start), static_cast<size_t>(source.length) * blockSize);
+        }
+        else
+        {
+            std::vector<char> scratch;
+            for (uint32_t i = 0; i < source.length; ++i)
+            {
+                copyIn(static_cast<size_t>(destination + i) * blockSize, blockContents(source.start + i, scratch),
+                       blockLengths[source.start + i], false);
+            }
+        }
+        std::copy(blockLengths + source.start, blockLengths + source.start + source.length, blockLengths + destination);
+        std::copy(checksums + source.start, checksums + source.start + source.length, checksums + destination);
+    }
+
     void BlockManager::writeBlock(unsigned int blockIndex, const std::string &data)
     {
         // 1. Check if the block index is within bounds
-        //    a. Write the data to the block
+        //    a. Copy at most blockSize bytes into the block's slot in the arena
+        //    b. Record how many bytes of the block are valid
         // 2. If the block index is out of bounds, throw InvalidBlockIndexException
-        if (blockIndex < blocks.size())
+        if (blockIndex < totalBlocks)
         {
-            blocks[blockIndex] = data.substr(0, blockSize); // Ensure data fits in the block
+            size_t length = std::min(data.size(), blockSize); // Ensure data fits in the block
+            {
+                std::unique_lock<std::mutex> indexLock = lockFingerprintIndex();
+                if (indexLock.owns_lock())
+                {
+                    forgetFingerprints(blockIndex, 1);
+                }
+            }
+            copyIn(static_cast<size_t>(blockIndex) * blockSize, data.data(), length, false);
+            blockLengths[blockIndex] = static_cast<uint32_t>(length);
+            updateChecksums(blockIndex, 1);
         }
         else
         {
@@ -121,12 +858,15 @@ namespace cse4733
     std::string BlockManager::readBlock(unsigned int blockIndex) const
     {
         // 1. Check if the block index is within bounds
-        //    a. Read the data from the block
+        //    a. Verify the block against its checksum
         //    b. Return the data
         // 2. If the block index is out of bounds, throw InvalidBlockIndexException
-        if (blockIndex < blocks.size())
+        if (blockIndex < totalBlocks)
         {
-            return blocks[blockIndex];
+            verifyBlocks(blockIndex, 1);
+            std::string data(blockLengths[blockIndex], '\0');
+            copyOut(static_cast<size_t>(blockIndex) * blockSize, data.data(), data.size());
+            return data;
         }
         else
         {
@@ -134,6 +874,234 @@ namespace cse4733
         }
     }
 
+    void BlockManager::writeExtent(const Extent &extent, const char *data, size_t size)
+    {
+        // 1. Validate the extent against the volume size
+        // 2. Copy the data into the arena in one memcpy, since the extent is contiguous
+        // 3. Record full lengths for every block and the remainder for the last one written, and checksum them
+        checkExtent(extent);
+
+        size = std::min(size, static_cast<size_t>(extent.length) * blockSize);
+        {
+            std::unique_lock<std::mutex> indexLock = lockFingerprintIndex();
+            if (indexLock.owns_lock())
+            {
+                forgetFingerprints(extent.start, extent.length);
+            }
+        }
+        copyIn(static_cast<size_t>(extent.start) * blockSize, data, size, false);
+        for (uint32_t i = 0; i < extent.length; ++i)
+        {
+            size_t offset = static_cast<size_t>(i) * blockSize;
+            size_t length = offset < size ? std::min(blockSize, size - offset) : 0;
+            blockLengths[extent.start + i] = static_cast<uint32_t>(length);
+        }
+        updateChecksums(extent.start, extent.length);
+    }
+
+    void BlockManager::writeExtentAt(const Extent &extent, size_t offset, const char *data, size_t size)
+    {
+        // 1. Validate the extent against the volume size
+        // 2. Copy the data into the arena in one memcpy
+        // 3. Grow the recorded length of every touched block to cover the bytes written
+        // 4. Recompute the checksums of the touched blocks
+        checkExtent(extent);
+        if (size == 0)
+        {
+            return;
+        }
+
+        size_t end = offset + size;
+        uint32_t firstBlock = extent.start + static_cast<uint32_t>(offset / blockSize);
+        uint32_t touchedBlocks = static_cast<uint32_t>((end - 1) / blockSize - offset / blockSize + 1);
+        {
+            std::unique_lock<std::mutex> indexLock = lockFingerprintIndex();
+            if (indexLock.owns_lock())
+            {
+                forgetFingerprints(firstBlock, touchedBlocks);
+            }
+        }
+        copyIn(static_cast<size_t>(extent.start) * blockSize + offset, data, size, true);
+        for (size_t block = offset / blockSize; block * blockSize < end; ++block)
+        {
+            size_t blockEnd = std::min(end - block * blockSize, blockSize);
+            uint32_t &length = blockLengths[extent.start + block];
+            length = std::max(length, static_cast<uint32_t>(blockEnd));
+        }
+        updateChecksums(firstBlock, touchedBlocks);
+    }
+
+    void BlockManager::readExtent(const Extent &extent, std::string &out) const
+    {
+        // 1. Validate the extent against the volume size
+        // 2. Walk the blocks, growing a run while blocks are full
+        // 3. Copy each run, ending at the first partially filled block, with a single append
+        checkExtent(extent);
+        verifyBlocks(extent.start, extent.length);
+
+        uint32_t end = extent.start + extent.length;
+        uint32_t runStart = extent.start;
+        for (uint32_t block = extent.start; block < end; ++block)
+        {
+            if (blockLengths[block] != blockSize || block + 1 == end)
+            {
+                size_t runBytes = static_cast<size_t>(block - runStart) * blockSize + blockLengths[block];
+                if (arena)
+                {
+                    out.append(blockPointer(runStart), runBytes);
+                }
+                else
+                {
+                    size_t used = out.size();
+                    out.resize(used + runBytes);
+                    copyOut(static_cast<size_t>(runStart) * blockSize, &out[used], runBytes);
+                }
+                runStart = block + 1;
+            }
+        }
+    }
+
+    std::string_view BlockManager::viewExtent(const Extent &extent, size_t length) const
+    {
+        // The extent is contiguous in the arena, so a single view covers it; only the viewed blocks are verified
+        if (!arena)
+        {
+            throw std::logic_error("viewExtent needs memory-resident blocks");
+        }
+        checkExtent(extent);
+        length = std::min(length, static_cast<size_t>(extent.length) * blockSize);
+        verifyBlocks(extent.start, static_cast<uint32_t>((length + blockSize - 1) / blockSize));
+        return std::string_view(blockPointer(extent.start), length);
+    }
+
+    void BlockManager::readExtentAt(const Extent &extent, size_t offset, char *out, size_t length) const
+    {
+        checkExtent(extent);
+        if (length == 0)
+        {
+            return;
+        }
+        // The copy comes first so a cache loads the touched blocks in runs; verifying them then hits the cache
+        uint32_t firstBlock = extent.start + static_cast<uint32_t>(offset / blockSize);
+        uint32_t touchedBlocks = static_cast<uint32_t>((offset + length - 1) / blockSize - offset / blockSize + 1);
+        copyOut(static_cast<size_t>(extent.start) * blockSize + offset, out, length);
+        verifyBlocks(firstBlock, touchedBlocks);
+    }
+
+    bool BlockManager::isMemoryResident() const
+    {
+        return arena != nullptr;
+    }
+
+    void BlockManager::prefetch(const Extent &extent, size_t offset, size_t length) const
+    {
+        if (!cache || length == 0)
+        {
+            return;
+        }
+        checkExtent(extent);
+        size_t end = std::min(offset + length, static_cast<size_t>(extent.length) * blockSize);
+        if (offset >= end)
+        {
+            return;
+        }
+        uint32_t firstBlock = static_cast<uint32_t>(offset / blockSize);
+        uint32_t lastBlock = static_cast<uint32_t>((end - 1) / blockSize);
+        cache->prefetch(extent.start + firstBlock, lastBlock - firstBlock + 1);
+    }
+
+    size_t BlockManager::getCacheCapacity() const
+    {
+        return cache ? cache->getCapacity() : 0;
+    }
+
+    size_t BlockManager::getPrefetchLimit() const
+    {
+        return cache ? cache->getPrefetchLimit() : 0;
+    }
+
+    bool BlockManager::needsWriteBack() const
+    {
+        return cache && cache->needsWriteBack();
+    }
+
+    void BlockManager::writeBack()
+    {
+        if (cache)
+        {
+            cache->writeBack();
+        }
+    }
+
+    void BlockManager::flush()
+    {
+        if (cache)
+        {
+            cache->flush();
+        }
+    }
+
+    CacheStats BlockManager::getCacheStats() const
+    {
+        return cache ? cache->getStats() : CacheStats();
+    }
+
+    void BlockManager::setVerifyOnRead(bool enabled)
+    {
+        verifyOnRead = enabled;
+    }
+
+    bool BlockManager::isVerifyingOnRead() const
+    {
+        return verifyOnRead;
+    }
+
+    size_t BlockManager::findUsedBlock(size_t from) const
+    {
+        // Search one group at a time under its lock, moving on while groups are empty from here on
+        while (from < totalBlocks)
+        {
+            AllocationGroup &group = groupOf(static_cast<uint32_t>(from));
+            size_t slot;
+            {
+                std::lock_guard<std::mutex> guard(group.mutex);
+                slot = group.freeBlocks.findUsed(from - group.start);
+            }
+            if (slot < group.length)
+            {
+                return group.start + slot;
+            }
+            from = static_cast<size_t>(group.start) + group.length;
+        }
+        return totalBlocks;
+    }
+
+    ScrubResult BlockManager::scrub(size_t maxBlocks)
+    {
+        // 1. Resume at the cursor and skip free runs using the bitmap
+        // 2. Verify allocated blocks until the budget is spent or the end of the volume is reached
+        // 3. Wrap the cursor to the start once a pass completes
+        std::lock_guard<std::mutex> scrubGuard(scrubState->mutex);
+        ScrubResult result{0, {}, false};
+        size_t block = findUsedBlock(scrubState->cursor);
+        while (result.blocksChecked < maxBlocks && block < totalBlocks)
+        {
+            if (!checksumMatches(static_cast<uint32_t>(block)))
+            {
+                result.corruptBlocks.push_back(static_cast<uint32_t>(block));
+            }
+            ++result.blocksChecked;
+            block = findUsedBlock(block + 1);
+        }
+        if (block >= totalBlocks)
+        {
+            result.passComplete = true;
+            block = 0;
+        }
+        scrubState->cursor = block;
+        return result;
+    }
+
     size_t BlockManager::getBlockSize() const
     {
         // Return the size of each block
@@ -143,15 +1111,24 @@ namespace cse4733
     size_t BlockManager::getTotalBlocks() const
     {
         // Return the total number of blocks
-        return blocks.size();
+        return totalBlocks;
+    }
+
+    AllocationPolicy BlockManager::getAllocationPolicy() const
+    {
+        return policy;
     }
 
     size_t BlockManager::getFreeBlockCount() const
     {
-        // Count the number of free blocks where freeBlocks[i] is true
-        size_t count = std::count_if(freeBlocks.begin(), freeBlocks.end(), [](bool free)
-                                     { return free; });
-        return count;
+        // Each group's bitmap keeps its free count up to date on every allocate and free
+        size_t freeCount = 0;
+        for (size_t i = 0; i < groupCount; ++i)
+        {
+            std::lock_guard<std::mutex> guard(groups[i].mutex);
+            freeCount += groups[i].freeBlocks.getFreeCount();
+        }
+        return freeCount;
     }
 
 } // namespace cse4733
@@ -1,18 +1,161 @@
+#ifndef BLOCKMANAGER_HPP
+#define BLOCKMANAGER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "BlockCache.hpp"
+#include "BlockStore.hpp"
+#include "BuddyAllocator.hpp"
+#include "Extent.hpp"
+#include "FreeSpaceBitmap.hpp"
+#include "Result.hpp"
+
 namespace cse4733
 {
 
+    /**
+     * @brief Strategy BlockManager uses to choose which free blocks to hand out.
+     */
+    enum class AllocationPolicy
+    {
+        /* Next-fit bitmap scan for single blocks, best fit from the free-extent index for runs. */
+        BestFit,
+
+        /* Binary buddy system: power-of-two runs that merge back together when freed. */
+        Buddy
+    };
+
+    /**
+     * @brief External memory a BlockManager can attach to instead of allocating its own, e.g. a mapped disk image.
+     */
+    struct BlockRegions
+    {
+        /* Block data, totalBlocks * blockSize bytes. */
+        char *data;
+
+        /* Valid byte count of each block, totalBlocks entries. */
+        uint32_t *lengths;
+
+        /* References to each block beyond its first owner, totalBlocks entries. */
+        uint32_t *shareCounts;
+
+        /* CRC-32C of the valid bytes of each block, totalBlocks entries. */
+        uint32_t *checksums;
+
+        /* Free-space bitmap words, FreeSpaceBitmap::wordsFor(totalBlocks) entries. */
+        uint64_t *bitmapWords;
+    };
+
+    /**
+     * @brief Counters describing content-addressed deduplication, see BlockManager::storeBlock.
+     */
+    struct DedupStats
+    {
+        /* Blocks passed to storeBlock. */
+        size_t logicalBlocks;
+
+        /* Blocks storeBlock had to allocate because no identical block was indexed. */
+        size_t storedBlocks;
+
+        /* Entries in the fingerprint index. */
+        size_t indexEntries;
+
+        /* Approximate memory used by the fingerprint index, in bytes. */
+        size_t indexBytes;
+    };
+
+    /**
+     * @brief Outcome of one BlockManager::scrub call.
+     */
+    struct ScrubResult
+    {
+        /* Allocated blocks whose checksums were verified. */
+        size_t blocksChecked;
+
+        /* Blocks whose contents no longer match their checksums. */
+        std::vector<uint32_t> corruptBlocks;
+
+        /* True if this call reached the end of the volume, so the next call starts a new pass. */
+        bool passComplete;
+    };
+
+    /**
+     * @class BlockManager
+     * @brief Allocates, frees and stores the blocks of a volume.
+     *
+     * The volume is split into allocation groups, each a range of at least
+     * GROUP_ALIGNMENT blocks with its own lock, slice of the bitmap and free-run index.
+     * Every thread has a home group, assigned round-robin the first time it allocates,
+     * and moves on to the following groups only when its home group cannot satisfy a
+     * request. Threads writing at once therefore rarely touch the same lock, and the
+     * files one thread writes stay clustered together. Free runs never span groups.
+     * Under the buddy policy the whole volume is a single group.
+     *
+     * Allocation, freeing, sharing and deduplication are thread-safe, so any number of
+     * threads may call them at once. Reads and writes of block
+     * contents take no lock; callers must make sure no two threads write the same
+     * block, or read a block while another thread writes it. Shared blocks are never
+     * written in place, so they can be read by their owners concurrently.
+     *
+     * Block contents live either in memory (an arena of its own or external memory
+     * such as a mapped disk image) or in a BlockStore behind a bounded BlockCache.
+     * Only memory-resident contents can be viewed in place; everything else works in
+     * both modes. Block metadata (lengths, checksums, share counts and the bitmap)
+     * always stays in memory.
+     */
     class BlockManager
     {
     public:
         /**
          * @brief Constructs a BlockManager with a specified number of blocks.
          *
+         * All block data lives in a single contiguous, cache-line aligned arena of
+         * totalBlocks * blockSize bytes, so the whole volume costs one allocation.
+         *
          * @param totalBlocks The total number of blocks in the filesystem.
+         * @param blockSize The size of each block in bytes.
+         * @param policy The allocation policy used for every allocation and free.
          */
-        BlockManager(size_t totalBlocks);
+        BlockManager(size_t totalBlocks, size_t blockSize = 64, AllocationPolicy policy = AllocationPolicy::BestFit);
+
+        /**
+         * @brief Constructs a BlockManager over existing block state in external memory.
+         *
+         * Nothing is copied here and the bitmap is only counted; each group's free-run
+         * index is rebuilt from the bitmap the first time that group is used.
+         *
+         * @param totalBlocks The total number of blocks in the filesystem.
+         * @param blockSize The size of each block in bytes.
+         * @param policy The allocation policy used for every allocation and free.
+         * @param regions The external memory holding the blocks. It must outlive the BlockManager.
+         */
+        BlockManager(size_t totalBlocks, size_t blockSize, AllocationPolicy policy, const BlockRegions &regions);
+
+        /**
+         * @brief Constructs a BlockManager whose block contents live in a store behind a cache.
+         *
+         * Only cacheBytes of block contents are held in memory, so the volume may be much
+         * larger than RAM. The metadata is allocated as for an owned arena.
+         *
+         * @param totalBlocks The total number of blocks in the filesystem.
+         * @param blockSize The size of each block in bytes.
+         * @param policy The allocation policy used for every allocation and free.
+         * @param store The store holding the blocks, at least totalBlocks blocks of blockSize bytes.
+         * @param cacheBytes The memory budget of the cache in front of the store.
+         */
+        BlockManager(size_t totalBlocks, size_t blockSize, AllocationPolicy policy,
+                     std::unique_ptr<BlockStore> store, size_t cacheBytes);
 
         /**
          * @brief Frees a specific block by index.
@@ -22,7 +165,7 @@ namespace cse4733
         void freeBlock(unsigned int blockIndex);
 
         /**
-         * @brief Allocates a single free block.
+         * @brief Allocates a single free block, from the calling thread's home group if it has one.
          *
          * @return The index of the allocated block.
          * @throw NoFreeBlockAvailableException if no free blocks are available.
@@ -30,6 +173,13 @@ namespace cse4733
          */
         unsigned int allocateBlock();
 
+        /**
+         * @brief Allocates a single free block like allocateBlock, without throwing.
+         *
+         * @return The index of the allocated block, or ErrorCode::NoSpace.
+         */
+        Result<unsigned int> tryAllocateBlock();
+
         /**
          * @brief Allocates multiple blocks as requested.
          *
@@ -38,6 +188,135 @@ namespace cse4733
          */
         std::vector<int> allocateBlocks(size_t numBlocks);
 
+        /**
+         * @brief Allocates a single contiguous run of blocks using best fit.
+         *
+         * The smallest free run in the first group, starting at the calling thread's
+         * home group, that can hold the request is chosen, so large runs are preserved
+         * for large requests.
+         *
+         * @param length The number of contiguous blocks to allocate.
+         * @return The allocated extent.
+         * @throw NoFreeBlockAvailableException if no free run of the requested length exists.
+         */
+        Extent allocateExtent(size_t length);
+
+        /**
+         * @brief Allocates a single contiguous run like allocateExtent, without throwing.
+         *
+         * @return The allocated extent, or ErrorCode::NoSpace.
+         */
+        Result<Extent> tryAllocateExtent(size_t length);
+
+        /**
+         * @brief Allocates numBlocks blocks in as few contiguous runs as possible.
+         *
+         * A single best-fit run is used whenever one is large enough; otherwise the
+         * largest free runs are taken until the request is satisfied, draining the
+         * calling thread's home group before its neighbours. Either every block is
+         * allocated or none are.
+         *
+         * @param numBlocks The total number of blocks to allocate.
+         * @return The allocated extents, in the order the data should be laid out.
+         * @throw NoFreeBlockAvailableException if fewer than numBlocks blocks are free.
+         */
+        std::vector<Extent> allocateExtents(size_t numBlocks);
+
+        /**
+         * @brief Allocates numBlocks blocks like allocateExtents, without throwing.
+         *
+         * @return The allocated extents, or ErrorCode::NoSpace with nothing allocated.
+         */
+        Result<std::vector<Extent>> tryAllocateExtents(size_t numBlocks);
+
+        /**
+         * @brief Grows an allocated extent in place by taking the free blocks directly after it.
+         *
+         * Only the best-fit policy extends in place; under the buddy policy no blocks are
+         * taken. The extent never grows past the end of the group holding the block after it.
+         *
+         * @param extent The extent to grow. Its length is increased by the number of blocks taken.
+         * @param maxBlocks The maximum number of blocks to take.
+         * @return The number of blocks taken, which may be zero.
+         */
+        size_t extendExtent(Extent &extent, size_t maxBlocks);
+
+        /**
+         * @brief Drops one reference to every block in an extent, freeing the blocks no one else references.
+         *
+         * Freed blocks are merged with neighbouring free runs; blocks that are still
+         * shared only lose a reference and keep their data.
+         *
+         * @param extent The extent to free.
+         * @throw InvalidBlockIndexException if the extent reaches past the end of the volume.
+         */
+        void freeExtent(const Extent &extent);
+
+        /**
+         * @brief Adds a reference to every block in an allocated extent, so it can be owned by several files.
+         *
+         * Each reference is dropped by one freeExtent or freeBlock call; the blocks return
+         * to the free pool when the last one is dropped.
+         *
+         * @param extent The extent to share. Every block in it must be allocated.
+         * @throw InvalidBlockIndexException if the extent reaches past the end of the volume.
+         */
+        void shareExtent(const Extent &extent);
+
+        /**
+         * @brief Stores one block of data, sharing an existing block with identical contents instead if one is indexed.
+         *
+         * The contents are hashed and looked up in a fingerprint index of blocks stored
+         * this way; a hit is confirmed byte for byte and then gains a reference. A miss
+         * allocates a new block and indexes it. A block leaves the index as soon as it
+         * is written in place or freed.
+         *
+         * @param data Pointer to the data to store.
+         * @param size The number of bytes to store, at most blockSize.
+         * @return The index of the block holding the data; the caller owns one reference to it.
+         * @throw NoFreeBlockAvailableException if the data is new and no block is free.
+         */
+        unsigned int storeBlock(const char *data, size_t size);
+
+        /**
+         * @brief Stores one block of data like storeBlock, without throwing.
+         *
+         * @return The index of the block holding the data, or ErrorCode::NoSpace.
+         */
+        Result<unsigned int> tryStoreBlock(const char *data, size_t size);
+
+        /**
+         * @brief Returns the deduplication counters of this BlockManager.
+         */
+        DedupStats getDedupStats() const;
+
+        /**
+         * @brief Returns the number of owners of a block: 0 if it is free, 1 if it is private, more if it is shared.
+         *
+         * @throw InvalidBlockIndexException if the block index is out of bounds.
+         */
+        uint32_t getReferenceCount(unsigned int blockIndex) const;
+
+        /**
+         * @brief Removes an extent's blocks from the deduplication index before they are written in place.
+         *
+         * Once this returns, storeBlock cannot hand out new references to the blocks, so a
+         * caller that then finds them unshared may write them without copying.
+         *
+         * @param extent The extent about to be written.
+         * @throw InvalidBlockIndexException if the extent reaches past the end of the volume.
+         */
+        void unindexExtent(const Extent &extent);
+
+        /**
+         * @brief Copies the contents and valid lengths of an extent's blocks to another run of blocks.
+         *
+         * @param source The extent to copy from.
+         * @param destination The first block of the run to copy to, source.length blocks long.
+         * @throw InvalidBlockIndexException if either run reaches past the end of the volume.
+         */
+        void copyExtent(const Extent &source, uint32_t destination);
+
         /**
          * @brief Writes data to a specific block.
          *
@@ -53,9 +332,146 @@ namespace cse4733
          * @param blockIndex The index of the block to read from.
          * @return The data read from the block.
          * @throw InvalidBlockIndexException if the block index is out of bounds.
+         * @throw CorruptDataException if verification is on and the block does not match its checksum.
          */
         std::string readBlock(unsigned int blockIndex) const;
 
+        /**
+         * @brief Writes data across the blocks of an extent with a single copy.
+         *
+         * Every block but the last is filled completely; the last block holds the remainder.
+         *
+         * @param extent The extent to write to.
+         * @param data Pointer to the data to write.
+         * @param size The number of bytes to write. At most extent.length * blockSize bytes are written.
+         * @throw InvalidBlockIndexException if the extent reaches past the end of the volume.
+         */
+        void writeExtent(const Extent &extent, const char *data, size_t size);
+
+        /**
+         * @brief Writes data into an extent starting at a byte offset, leaving the rest of the extent untouched.
+         *
+         * @param extent The extent to write to.
+         * @param offset The byte offset within the extent to start writing at.
+         * @param data Pointer to the data to write.
+         * @param size The number of bytes to write. The write must end within the extent.
+         * @throw InvalidBlockIndexException if the extent reaches past the end of the volume.
+         */
+        void writeExtentAt(const Extent &extent, size_t offset, const char *data, size_t size);
+
+        /**
+         * @brief Appends the contents of every block in an extent to a string.
+         *
+         * Runs of full blocks are copied with a single memcpy.
+         *
+         * @param extent The extent to read.
+         * @param out The string the data is appended to.
+         * @throw InvalidBlockIndexException if the extent reaches past the end of the volume.
+         * @throw CorruptDataException if verification is on and a block does not match its checksum.
+         */
+        void readExtent(const Extent &extent, std::string &out) const;
+
+        /**
+         * @brief Copies bytes of an extent starting at a byte offset into a buffer.
+         *
+         * Works whether or not the blocks are memory-resident; only the blocks touched are verified.
+         *
+         * @param extent The extent to read.
+         * @param offset The byte offset within the extent to start reading at.
+         * @param out The buffer to copy into, at least length bytes.
+         * @param length The number of bytes to copy. The read must end within the extent.
+         * @throw InvalidBlockIndexException if the extent reaches past the end of the volume.
+         * @throw CorruptDataException if verification is on and a touched block does not match its checksum.
+         */
+        void readExtentAt(const Extent &extent, size_t offset, char *out, size_t length) const;
+
+        /**
+         * @brief Returns a view of the first bytes of an extent directly in block storage, without copying.
+         *
+         * The view stays valid until the blocks are written or the BlockManager is destroyed or replaced.
+         * Only available when isMemoryResident() is true.
+         *
+         * @param extent The extent to view.
+         * @param length The number of bytes to view. At most extent.length * blockSize bytes are viewed.
+         * @return A view of the extent's bytes.
+         * @throw InvalidBlockIndexException if the extent reaches past the end of the volume.
+         * @throw CorruptDataException if verification is on and a viewed block does not match its checksum.
+         * @throw std::logic_error if the blocks live in a BlockStore.
+         */
+        std::string_view viewExtent(const Extent &extent, size_t length) const;
+
+        /**
+         * @brief Returns true if block contents live in memory and can be viewed in place.
+         */
+        bool isMemoryResident() const;
+
+        /**
+         * @brief Starts loading the blocks of a byte range of an extent into the cache, ahead of a sequential reader.
+         *
+         * Does nothing when memory-resident. The range is clipped to the extent.
+         *
+         * @throw InvalidBlockIndexException if the extent reaches past the end of the volume.
+         * @throw BlockStoreException if the store fails.
+         */
+        void prefetch(const Extent &extent, size_t offset, size_t length) const;
+
+        /**
+         * @brief Returns the number of blocks the cache holds, or 0 when memory-resident.
+         */
+        size_t getCacheCapacity() const;
+
+        /**
+         * @brief Returns the most blocks one prefetch loads into the cache, or 0 when memory-resident.
+         */
+        size_t getPrefetchLimit() const;
+
+        /**
+         * @brief Returns true once enough cached blocks are dirty that writeBack is due.
+         */
+        bool needsWriteBack() const;
+
+        /**
+         * @brief Writes every dirty cached block back to the store, coalescing adjacent blocks, without syncing it.
+         *
+         * @throw BlockStoreException if the store fails.
+         */
+        void writeBack();
+
+        /**
+         * @brief Writes every dirty cached block back to the store and syncs it. Does nothing when memory-resident.
+         *
+         * @throw BlockStoreException if the store fails.
+         */
+        void flush();
+
+        /**
+         * @brief Returns the cache counters; all zero when memory-resident.
+         */
+        CacheStats getCacheStats() const;
+
+        /**
+         * @brief Turns checksum verification of readBlock, readExtent and viewExtent on or off. It starts on.
+         *
+         * Checksums are maintained on every write either way.
+         */
+        void setVerifyOnRead(bool enabled);
+
+        /**
+         * @brief Returns true if reads verify block checksums.
+         */
+        bool isVerifyingOnRead() const;
+
+        /**
+         * @brief Verifies the checksums of the next allocated blocks, resuming where the previous call stopped.
+         *
+         * Calling this repeatedly with a small budget spreads a full scrub of the volume
+         * over idle time; corrupt blocks are reported rather than thrown.
+         *
+         * @param maxBlocks The maximum number of allocated blocks to verify in this call.
+         * @return The blocks checked, those found corrupt, and whether the pass reached the end of the volume.
+         */
+        ScrubResult scrub(size_t maxBlocks);
+
         /**
          * @brief Returns the size of each block.
          *
@@ -75,25 +491,363 @@ namespace cse4733
          */
         size_t getFreeBlockCount() const;
 
+        /**
+         * @brief Returns the allocation policy chosen at construction.
+         */
+        AllocationPolicy getAllocationPolicy() const;
+
     private:
         /**
-         * @brief The total number of blocks in the filesystem.
+         * @brief Alignment of the block arena, one cache line.
+         */
+        static constexpr size_t ARENA_ALIGNMENT = 64;
+
+        /**
+         * @brief Group sizes are multiples of this many blocks, so the bitmap words of
+         *        different groups never share a cache line.
+         */
+        static constexpr size_t GROUP_ALIGNMENT = 512;
+
+        /**
+         * @brief The most allocation groups a volume is split into.
+         */
+        static constexpr size_t MAX_GROUPS = 64;
+
+        /**
+         * @brief A range of blocks allocated independently of the rest of the volume.
          *
-         * This value is set during construction and does not change.
+         * Padded to a cache line so threads working in neighbouring groups do not share one.
          */
-        size_t blockSize;
+        struct alignas(64) AllocationGroup
+        {
+            /* Guards everything below, and the share counts of the group's blocks. */
+            std::mutex mutex;
+
+            /* The first block of the group. */
+            uint32_t start = 0;
+
+            /* The number of blocks in the group. */
+            uint32_t length = 0;
+
+            /* The group's slice of the volume bitmap; slot i is block start + i. */
+            FreeSpaceBitmap freeBlocks;
+
+            /* Next-fit cursor relative to start: the slot after the most recent allocation. */
+            size_t nextFitCursor = 0;
+
+            /* Free runs keyed by their first block, used to find neighbours when merging. */
+            std::map<uint32_t, uint32_t> freeExtentsByStart;
+
+            /* Free runs ordered by (length, start), used for best-fit lookups. */
+            std::set<std::pair<uint32_t, uint32_t>> freeExtentsBySize;
+
+            /* Whether the free-run index (or the buddy free lists) reflect the bitmap yet. */
+            bool freeIndexBuilt = false;
+        };
+
+        /**
+         * @brief The fingerprint index used by storeBlock, with its lock and counters.
+         */
+        struct FingerprintIndex
+        {
+            /* Guards everything below. Taken before any group lock. */
+            std::mutex mutex;
+
+            /* Set once the first block is indexed; until then there is nothing to forget. */
+            std::atomic<bool> populated{false};
+
+            /* Blocks stored by storeBlock, keyed by the fingerprint of their contents. */
+            std::unordered_map<uint64_t, uint32_t> entries;
+
+            /* The number of blocks passed to storeBlock. */
+            size_t logicalBlocks = 0;
+
+            /* The number of blocks storeBlock allocated. */
+            size_t storedBlocks = 0;
+        };
+
+        /**
+         * @brief Where the next scrub call starts, with the lock that serializes scrubs.
+         */
+        struct ScrubState
+        {
+            std::mutex mutex;
+            size_t cursor = 0;
+        };
+
+        /**
+         * @brief Releases the block arena with the matching aligned delete.
+         */
+        struct ArenaDeleter
+        {
+            void operator()(char *arena) const;
+        };
+
+        /**
+         * @brief Clears the owned metadata and builds the free-run index of every group.
+         */
+        void initializeOwned();
+
+        /**
+         * @brief Splits the volume into allocation groups, each attached to its slice of the bitmap words.
+         */
+        void createGroups(uint64_t *bitmapWords);
+
+        /**
+         * @brief Returns the group a block belongs to.
+         *
+         * @param blockIndex The index of the block. Must already be bounds-checked.
+         */
+        AllocationGroup &groupOf(uint32_t blockIndex) const;
+
+        /**
+         * @brief Returns the index of the calling thread's home group.
+         */
+        size_t homeGroup() const;
+
+        /**
+         * @brief Returns a pointer to the first byte of a block inside the arena.
+         *
+         * @param blockIndex The index of the block. Must already be bounds-checked.
+         */
+        char *blockPointer(unsigned int blockIndex) const;
+
+        /**
+         * @brief Copies bytes into block storage at a byte position in the volume, through the cache if there is one.
+         *
+         * @param preserve False if the bytes of the touched blocks outside the copied range are being discarded,
+         *        so a cache miss need not load them first.
+         */
+        void copyIn(size_t position, const char *data, size_t size, bool preserve);
+
+        /**
+         * @brief Copies bytes out of block storage at a byte position in the volume, through the cache if there is one.
+         */
+        void copyOut(size_t position, char *out, size_t size) const;
+
+        /**
+         * @brief Returns a pointer to a block's valid bytes: in place when memory-resident, otherwise copied into scratch.
+         *
+         * @param blockIndex The index of the block. Must already be bounds-checked.
+         */
+        const char *blockContents(uint32_t blockIndex, std::vector<char> &scratch) const;
+
+        /**
+         * @brief Throws InvalidBlockIndexException unless the extent lies inside the volume.
+         */
+        void checkExtent(const Extent &extent) const;
+
+        /**
+         * @brief Recomputes the stored checksum of each block in a range from its valid bytes.
+         */
+        void updateChecksums(uint32_t start, uint32_t length);
+
+        /**
+         * @brief Returns true if a block's valid bytes match its stored checksum.
+         */
+        bool checksumMatches(uint32_t blockIndex) const;
+
+        /**
+         * @brief Throws CorruptDataException for the first block in a range whose checksum does not match, if verification is on.
+         */
+        void verifyBlocks(uint32_t start, uint32_t length) const;
+
+        /**
+         * @brief Removes an allocated range from a group's free-extent index, splitting the run that contains it.
+         *
+         * @param group The group holding the range. Its lock must be held.
+         * @param start The first block of the range. The range must currently be free.
+         * @param length The number of blocks in the range.
+         */
+        void carveFreeExtent(AllocationGroup &group, uint32_t start, uint32_t length);
+
+        /**
+         * @brief Hashes block contents for the fingerprint index.
+         */
+        static uint64_t fingerprint(const char *data, size_t size);
+
+        /**
+         * @brief Locks the fingerprint index if any block has ever been indexed.
+         *
+         * Until then the returned lock owns nothing: blocks are only indexed when
+         * storeBlock allocates them, so none of the caller's blocks can be indexed.
+         */
+        std::unique_lock<std::mutex> lockFingerprintIndex() const;
+
+        /**
+         * @brief Removes blocks from the fingerprint index before their contents change or they are freed.
+         *
+         * The fingerprint index lock must be held.
+         */
+        void forgetFingerprints(uint32_t start, uint32_t length);
+
+        /**
+         * @brief Rebuilds a group's free-run index (or the buddy free lists) from the bitmap if it has not been built yet.
+         */
+        void ensureFreeIndex(AllocationGroup &group);
+
+        /**
+         * @brief Returns the length of the longest free run in a group. Its lock must be held.
+         */
+        size_t largestFreeRun(AllocationGroup &group);
+
+        /**
+         * @brief Allocates a single block from a group. Its lock must be held and it must have a free block.
+         */
+        unsigned int takeBlock(AllocationGroup &group);
+
+        /**
+         * @brief Removes an allocated range from the structures of the active allocation policy.
+         *
+         * @param group The group to allocate from. Its lock must be held.
+         * @param length The number of contiguous blocks to take.
+         * @return The allocated extent.
+         * @throw NoFreeBlockAvailableException if no free run of the requested length exists in the group.
+         */
+        Extent takeRun(AllocationGroup &group, size_t length);
+
+        /**
+         * @brief Drops one reference to every block in a range within one group, releasing the blocks no one else references.
+         *
+         * The group's lock must be held, and the fingerprint index lock too if indexLock owns it.
+         */
+        void dropReferences(AllocationGroup &group, uint32_t start, uint32_t length,
+                            const std::unique_lock<std::mutex> &indexLock);
+
+        /**
+         * @brief Returns a freed range to the structures of the active allocation policy.
+         */
+        void releaseRun(AllocationGroup &group, uint32_t start, uint32_t length);
 
         /**
-         * @brief The list of blocks in the filesystem.
+         * @brief Adds a freed range to a group's free-extent index, merging it with adjacent free runs.
+         *
+         * @param group The group holding the range. Its lock must be held.
+         * @param start The first block of the range.
+         * @param length The number of blocks in the range.
          */
-        std::vector<std::string> blocks;
+        void insertFreeExtent(AllocationGroup &group, uint32_t start, uint32_t length);
+
+        /**
+         * @brief Returns the first allocated block at or after a block, or totalBlocks if there is none.
+         */
+        size_t findUsedBlock(size_t from) const;
+
+        /**
+         * @brief The size of each block in bytes.
+         *
+         * This value is set during construction and does not change.
+         */
+        size_t blockSize;
 
         /**
          * @brief The total number of blocks in the filesystem.
          *
          * This value is set during construction and does not change.
          */
-        std::vector<bool> freeBlocks;
+        size_t totalBlocks;
+
+        /**
+         * @brief The allocation policy chosen at construction.
+         */
+        AllocationPolicy policy;
+
+        /**
+         * @brief Contiguous storage for every block, totalBlocks * blockSize bytes.
+         *
+         * Points either into ownedArena or into external memory, or is null when the blocks live in a store.
+         */
+        char *arena;
+
+        /**
+         * @brief The arena allocation when the BlockManager owns its storage.
+         */
+        std::unique_ptr<char[], ArenaDeleter> ownedArena;
+
+        /**
+         * @brief The cache in front of the block store, used instead of an arena when arena is null.
+         */
+        std::unique_ptr<BlockCache> cache;
+
+        /**
+         * @brief The number of valid bytes stored in each block.
+         *
+         * Points either into ownedLengths or into external memory.
+         */
+        uint32_t *blockLengths;
+
+        /**
+         * @brief Storage for the block lengths when the BlockManager owns its storage.
+         */
+        std::vector<uint32_t> ownedLengths;
+
+        /**
+         * @brief The number of references to each block beyond its first owner; 0 for private and free blocks.
+         *
+         * Points either into ownedShareCounts or into external memory.
+         */
+        uint32_t *shareCounts;
+
+        /**
+         * @brief Storage for the share counts when the BlockManager owns its storage.
+         */
+        std::vector<uint32_t> ownedShareCounts;
+
+        /**
+         * @brief The CRC-32C of each block's valid bytes, kept current by every write.
+         *
+         * Points either into ownedChecksums or into external memory.
+         */
+        uint32_t *checksums;
+
+        /**
+         * @brief Storage for the checksums when the BlockManager owns its storage.
+         */
+        std::vector<uint32_t> ownedChecksums;
+
+        /**
+         * @brief Storage for the free-space bitmap words when the BlockManager owns its storage.
+         */
+        std::vector<uint64_t> ownedBitmapWords;
+
+        /**
+         * @brief Whether reads verify block checksums.
+         */
+        bool verifyOnRead;
+
+        /**
+         * @brief The number of blocks in every group but possibly the last.
+         */
+        size_t groupBlocks;
+
+        /**
+         * @brief The number of allocation groups, at least one.
+         */
+        size_t groupCount;
+
+        /**
+         * @brief The allocation groups, in block order.
+         */
+        std::unique_ptr<AllocationGroup[]> groups;
+
+        /**
+         * @brief Free lists used instead of the free-extent index under AllocationPolicy::Buddy.
+         *
+         * Guarded by the lock of the single group.
+         */
+        BuddyAllocator buddy;
+
+        /**
+         * @brief The deduplication index.
+         */
+        std::unique_ptr<FingerprintIndex> fingerprints;
+
+        /**
+         * @brief The scrub cursor.
+         */
+        std::unique_ptr<ScrubState> scrubState;
     };
 
-} // namespace cse4733
\ No newline at end of file
+} // namespace cse4733
+
+#endif // BLOCKMANAGER_HPP
@@ -0,0 +1,50 @@
+#ifndef BLOCKSTORE_HPP
+#define BLOCKSTORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cse4733
+{
+
+    /**
+     * @class BlockStore
+     * @brief Interface of the device a BlockCache keeps block contents on.
+     *
+     * A store holds a fixed number of fixed-size blocks and transfers whole blocks.
+     * Reads and writes of different blocks may run on several threads at once.
+     */
+    class BlockStore
+    {
+    public:
+        virtual ~BlockStore() = default;
+
+        /**
+         * @brief Copies count consecutive blocks, starting at block start, into out.
+         */
+        virtual void read(uint32_t start, uint32_t count, char *out) = 0;
+
+        /**
+         * @brief Overwrites count consecutive blocks, starting at block start, with data.
+         */
+        virtual void write(uint32_t start, uint32_t count, const char *data) = 0;
+
+        /**
+         * @brief Makes every completed write durable.
+         */
+        virtual void sync() = 0;
+
+        /**
+         * @brief Returns the size of each block in bytes.
+         */
+        virtual size_t getBlockSize() const = 0;
+
+        /**
+         * @brief Returns the number of blocks.
+         */
+        virtual size_t getBlockCount() const = 0;
+    };
+
+} // namespace cse4733
+
+#endif // BLOCKSTORE_HPP
@@ -0,0 +1,19 @@
+#ifndef BLOCK_STORE_EXCEPTION_HPP
+#define BLOCK_STORE_EXCEPTION_HPP
+
+#include <stdexcept>
+#include <string>
+
+namespace cse4733
+{
+
+    class BlockStoreException : public std::runtime_error
+    {
+    public:
+        BlockStoreException(const std::string &path, const std::string &reason)
+            : std::runtime_error("Block store " + path + ": " + reason) {}
+    };
+
+} // namespace cse4733
+
+#endif // BLOCK_STORE_EXCEPTION_HPP
@@ -0,0 +1,153 @@
+#include "BuddyAllocator.hpp"
+#include "NoFreeBlockAvailableException.hpp"
+
+#include <algorithm>
+
+namespace cse4733
+{
+
+    namespace
+    {
+        /**
+         * @brief Largest order whose run size does not exceed value. value must be non-zero.
+         */
+        inline unsigned floorLog2(size_t value)
+        {
+            return 63u - static_cast<unsigned>(__builtin_clzll(value));
+        }
+
+        /**
+         * @brief Smallest order whose run size is at least value. value must be non-zero.
+         */
+        inline unsigned ceilLog2(size_t value)
+        {
+            return value <= 1 ? 0 : floorLog2(value - 1) + 1;
+        }
+    } // namespace
+
+    BuddyAllocator::BuddyAllocator(size_t totalBlocks, bool allFree)
+        : totalBlocks(totalBlocks),
+          freeHeads(totalBlocks > 0 ? floorLog2(totalBlocks) + 1 : 0, NONE),
+          nextFree(totalBlocks, NONE),
+          prevFree(totalBlocks, NONE),
+          freeOrder(totalBlocks, NOT_FREE)
+    {
+        // Seed the free lists by freeing the whole range, which decomposes it into
+        // the largest aligned power-of-two runs
+        if (allFree && totalBlocks > 0)
+        {
+            free(0, static_cast<uint32_t>(totalBlocks));
+        }
+    }
+
+    Extent BuddyAllocator::allocate(size_t length)
+    {
+        // 1. Round the request up to a power-of-two order
+        // 2. Find the smallest non-empty free list at or above that order
+        // 3. Split the run down to the requested order, freeing the upper halves
+        // 4. Give back any blocks beyond the requested length
+        unsigned order = ceilLog2(length);
+        unsigned found = order;
+        while (found < freeHeads.size() && freeHeads[found] == NONE)
+        {
+            ++found;
+        }
+        if (length == 0 || found >= freeHeads.size())
+        {
+            throw cse4733::NoFreeBlockAvailableException();
+        }
+
+        uint32_t block = freeHeads[found];
+        removeFree(block, found);
+        while (found > order)
+        {
+            --found;
+            pushFree(block + (uint32_t(1) << found), found);
+        }
+
+        uint32_t runLength = uint32_t(1) << order;
+        if (length < runLength)
+        {
+            free(block + static_cast<uint32_t>(length), runLength - static_cast<uint32_t>(length));
+        }
+        return Extent{block, static_cast<uint32_t>(length)};
+    }
+
+    void BuddyAllocator::free(uint32_t start, uint32_t length)
+    {
+        // Decompose the range into maximal aligned power-of-two runs and free each one
+        while (length > 0)
+        {
+            unsigned order = floorLog2(length);
+            if (start != 0)
+            {
+                order = std::min(order, static_cast<unsigned>(__builtin_ctz(start)));
+            }
+            freeRun(start, order);
+            start += uint32_t(1) << order;
+            length -= uint32_t(1) << order;
+        }
+    }
+
+    size_t BuddyAllocator::getLargestFreeRun() const
+    {
+        for (size_t order = freeHeads.size(); order-- > 0;)
+        {
+            if (freeHeads[order] != NONE)
+            {
+                return size_t(1) << order;
+            }
+        }
+        return 0;
+    }
+
+    void BuddyAllocator::freeRun(uint32_t block, unsigned order)
+    {
+        // Keep merging while the buddy run is free and of the same order
+        while (order + 1 < freeHeads.size())
+        {
+            uint32_t buddy = block ^ (uint32_t(1) << order);
+            if (buddy >= totalBlocks || freeOrder[buddy] != order)
+            {
+                break;
+            }
+            removeFree(buddy, order);
+            block = std::min(block, buddy);
+            ++order;
+        }
+        pushFree(block, order);
+    }
+
+    void BuddyAllocator::pushFree(uint32_t block, unsigned order)
+    {
+        uint32_t head = freeHeads[order];
+        nextFree[block] = head;
+        prevFree[block] = NONE;
+        if (head != NONE)
+        {
+            prevFree[head] = block;
+        }
+        freeHeads[order] = block;
+        freeOrder[block] = static_cast<uint8_t>(order);
+    }
+
+    void BuddyAllocator::removeFree(uint32_t block, unsigned order)
+    {
+        uint32_t next = nextFree[block];
+        uint32_t prev = prevFree[block];
+        if (prev != NONE)
+        {
+            nextFree[prev] = next;
+        }
+        else
+        {
+            freeHeads[order] = next;
+        }
+        if (next != NONE)
+        {
+            prevFree[next] = prev;
+        }
+        freeOrder[block] = NOT_FREE;
+    }
+
+} // namespace cse4733
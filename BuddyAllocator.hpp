@@ -0,0 +1,104 @@
+#ifndef BUDDYALLOCATOR_HPP
+#define BUDDYALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Extent.hpp"
+
+namespace cse4733
+{
+
+    /**
+     * @class BuddyAllocator
+     * @brief Binary buddy allocator over a range of block indices.
+     *
+     * Free space is kept as aligned power-of-two runs in one free list per order.
+     * A request is served from the smallest order that fits, splitting larger runs
+     * as needed, and any blocks past the requested length are handed straight back.
+     * Freed runs merge with their buddy whenever the buddy is free and of the same
+     * order, so allocate and free both take O(log n).
+     */
+    class BuddyAllocator
+    {
+    public:
+        /**
+         * @brief Constructs an allocator over the blocks in [0, totalBlocks).
+         *
+         * @param totalBlocks The number of blocks managed. Need not be a power of two.
+         * @param allFree True to start with every block free, false to start with every block allocated.
+         */
+        explicit BuddyAllocator(size_t totalBlocks = 0, bool allFree = true);
+
+        /**
+         * @brief Allocates a contiguous run of blocks.
+         *
+         * @param length The number of blocks to allocate.
+         * @return The allocated extent, exactly length blocks long.
+         * @throw NoFreeBlockAvailableException if no free run of the required order exists.
+         */
+        Extent allocate(size_t length);
+
+        /**
+         * @brief Returns a run of allocated blocks to the free lists, merging buddies.
+         *
+         * Any allocated range may be freed, not just whole allocations.
+         *
+         * @param start The first block of the range.
+         * @param length The number of blocks in the range.
+         */
+        void free(uint32_t start, uint32_t length);
+
+        /**
+         * @brief Returns the length of the largest free run, or 0 if nothing is free.
+         */
+        size_t getLargestFreeRun() const;
+
+    private:
+        /**
+         * @brief Marker for "no block" in the free lists and "not a free run head" in freeOrder.
+         */
+        static constexpr uint32_t NONE = static_cast<uint32_t>(-1);
+        static constexpr uint8_t NOT_FREE = 0xFF;
+
+        /**
+         * @brief Frees one aligned run of 2^order blocks, merging it with free buddies.
+         */
+        void freeRun(uint32_t block, unsigned order);
+
+        /**
+         * @brief Pushes the head of a free run onto the list for its order.
+         */
+        void pushFree(uint32_t block, unsigned order);
+
+        /**
+         * @brief Unlinks the head of a free run from the list for its order.
+         */
+        void removeFree(uint32_t block, unsigned order);
+
+        /**
+         * @brief The number of blocks managed.
+         */
+        size_t totalBlocks;
+
+        /**
+         * @brief Head block of the free list for each order, or NONE.
+         */
+        std::vector<uint32_t> freeHeads;
+
+        /**
+         * @brief Intrusive doubly linked free-list links, indexed by run head block.
+         */
+        std::vector<uint32_t> nextFree;
+        std::vector<uint32_t> prevFree;
+
+        /**
+         * @brief Order of the free run starting at each block, or NOT_FREE.
+         */
+        std::vector<uint8_t> freeOrder;
+    };
+
+} // namespace cse4733
+
+#endif // BUDDYALLOCATOR_HPP
@@ -0,0 +1,55 @@
+#ifndef CODEC_HPP
+#define CODEC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace cse4733
+{
+
+    /**
+     * @class Codec
+     * @brief Interface of a compression codec FileSystem can store file data with.
+     *
+     * The codec's id is stored with every file it compressed, so an id must never be
+     * reused for a different format once data has been written with it.
+     */
+    class Codec
+    {
+    public:
+        virtual ~Codec() = default;
+
+        /**
+         * @brief Returns the id stored with data this codec compressed. Must be non-zero.
+         */
+        virtual uint8_t getId() const = 0;
+
+        /**
+         * @brief Returns a short, human-readable name for the codec.
+         */
+        virtual std::string getName() const = 0;
+
+        /**
+         * @brief Compresses data.
+         *
+         * @param data The bytes to compress.
+         * @return The compressed form, which may be larger than the input.
+         */
+        virtual std::string compress(std::string_view data) const = 0;
+
+        /**
+         * @brief Decompresses data produced by compress().
+         *
+         * @param data The compressed bytes.
+         * @param rawSize The size of the original data.
+         * @param out Set to the decompressed bytes.
+         * @return False if the data is malformed or does not decompress to exactly rawSize bytes.
+         */
+        virtual bool decompress(std::string_view data, size_t rawSize, std::string &out) const = 0;
+    };
+
+} // namespace cse4733
+
+#endif // CODEC_HPP
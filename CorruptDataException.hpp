@@ -0,0 +1,19 @@
+#ifndef CORRUPT_DATA_EXCEPTION_HPP
+#define CORRUPT_DATA_EXCEPTION_HPP
+
+#include <stdexcept>
+#include <string>
+
+namespace cse4733
+{
+
+    class CorruptDataException : public std::runtime_error
+    {
+    public:
+        explicit CorruptDataException(const std::string &reason)
+            : std::runtime_error("Corrupt data: " + reason) {}
+    };
+
+} // namespace cse4733
+
+#endif // CORRUPT_DATA_EXCEPTION_HPP
@@ -0,0 +1,123 @@
+#include "Crc32c.hpp"
+
+#include <array>
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define CRC32C_HAVE_SSE42 1
+#include <nmmintrin.h>
+#endif
+
+namespace cse4733
+{
+
+    namespace
+    {
+        // Reflected Castagnoli polynomial
+        constexpr uint32_t POLYNOMIAL = 0x82F63B78u;
+
+        using SlicingTables = std::array<std::array<uint32_t, 256>, 8>;
+
+        // tables[k][b] is the CRC of byte b followed by k zero bytes
+        SlicingTables buildTables()
+        {
+            SlicingTables tables{};
+            for (uint32_t byte = 0; byte < 256; ++byte)
+            {
+                uint32_t crc = byte;
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    crc = (crc >> 1) ^ (POLYNOMIAL & (0u - (crc & 1u)));
+                }
+                tables[0][byte] = crc;
+            }
+            for (uint32_t byte = 0; byte < 256; ++byte)
+            {
+                for (size_t k = 1; k < tables.size(); ++k)
+                {
+                    uint32_t previous = tables[k - 1][byte];
+                    tables[k][byte] = (previous >> 8) ^ tables[0][previous & 0xFF];
+                }
+            }
+            return tables;
+        }
+
+        const SlicingTables &slicingTables()
+        {
+            static const SlicingTables tables = buildTables();
+            return tables;
+        }
+    } // namespace
+
+    uint32_t Crc32c::compute(const char *data, size_t size, uint32_t crc)
+    {
+        // The CPU check runs once; afterwards every call is a single predictable branch
+        static const bool hardware = isHardwareAccelerated();
+        return hardware ? computeHardware(data, size, crc) : computeSoftware(data, size, crc);
+    }
+
+    uint32_t Crc32c::computeSoftware(const char *data, size_t size, uint32_t crc)
+    {
+        // 1. Fold eight bytes at a time through the eight tables (little-endian word order)
+        // 2. Finish the tail one byte at a time
+        const SlicingTables &t = slicingTables();
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+        crc = ~crc;
+        while (size >= 8)
+        {
+            uint32_t low = crc ^ (static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+                                  static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24);
+            crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+                  t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+            p += 8;
+            size -= 8;
+        }
+        while (size-- > 0)
+        {
+            crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+        }
+        return ~crc;
+    }
+
+#ifdef CRC32C_HAVE_SSE42
+
+    bool Crc32c::isHardwareAccelerated()
+    {
+        return __builtin_cpu_supports("sse4.2");
+    }
+
+    __attribute__((target("sse4.2"))) uint32_t Crc32c::computeHardware(const char *data, size_t size, uint32_t crc)
+    {
+        // Eight bytes per crc32 instruction, then the tail byte by byte
+        uint64_t state = ~crc;
+        while (size >= sizeof(uint64_t))
+        {
+            uint64_t word;
+            std::memcpy(&word, data, sizeof(word));
+            state = _mm_crc32_u64(state, word);
+            data += sizeof(word);
+            size -= sizeof(word);
+        }
+        uint32_t result = static_cast<uint32_t>(state);
+        while (size-- > 0)
+        {
+            result = _mm_crc32_u8(result, static_cast<unsigned char>(*data++));
+        }
+        return ~result;
+    }
+
+#else
+
+    bool Crc32c::isHardwareAccelerated()
+    {
+        return false;
+    }
+
+    uint32_t Crc32c::computeHardware(const char *data, size_t size, uint32_t crc)
+    {
+        return computeSoftware(data, size, crc);
+    }
+
+#endif
+
+} // namespace cse4733
@@ -0,0 +1,49 @@
+#ifndef CRC32C_HPP
+#define CRC32C_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cse4733
+{
+
+    /**
+     * @class Crc32c
+     * @brief CRC-32C (Castagnoli) checksums, as used for block verification.
+     *
+     * Uses the SSE4.2 crc32 instruction when the CPU supports it and a slicing-by-8
+     * table implementation otherwise; both produce identical values.
+     */
+    class Crc32c
+    {
+    public:
+        /**
+         * @brief Computes the checksum of a buffer, optionally continuing a previous checksum.
+         *
+         * @param data Pointer to the bytes to checksum.
+         * @param size The number of bytes.
+         * @param crc The checksum of the preceding bytes, or 0 to start a new checksum.
+         * @return The checksum of everything so far. The checksum of zero bytes is 0.
+         */
+        static uint32_t compute(const char *data, size_t size, uint32_t crc = 0);
+
+        /**
+         * @brief Returns true if compute() uses the SSE4.2 crc32 instruction on this CPU.
+         */
+        static bool isHardwareAccelerated();
+
+    private:
+        /**
+         * @brief Table-driven implementation, eight bytes per step.
+         */
+        static uint32_t computeSoftware(const char *data, size_t size, uint32_t crc);
+
+        /**
+         * @brief SSE4.2 implementation. Must only be called when isHardwareAccelerated() is true.
+         */
+        static uint32_t computeHardware(const char *data, size_t size, uint32_t crc);
+    };
+
+} // namespace cse4733
+
+#endif // CRC32C_HPP
@@ -0,0 +1,173 @@
+#include "DentryCache.hpp"
+
+#include "EpochReclaimer.hpp"
+
+namespace cse4733
+{
+
+    DentryCache::DentryCache(size_t capacity)
+    {
+        if (capacity == 0)
+        {
+            return;
+        }
+        size_t sets = 1;
+        while (sets * WAYS < capacity)
+        {
+            sets *= 2;
+        }
+        setMask = sets - 1;
+        slots = std::make_unique<std::atomic<const Entry *>[]>(sets * WAYS);
+        for (size_t i = 0; i < sets * WAYS; i++)
+        {
+            slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    DentryCache::~DentryCache()
+    {
+        // No reader can run any more, so the entries still cached are deleted directly
+        if (slots)
+        {
+            for (size_t i = 0; i < (setMask + 1) * WAYS; i++)
+            {
+                delete slots[i].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    size_t DentryCache::hashOf(unsigned int parentInode, const std::string &name)
+    {
+        return std::hash<std::string>()(name) ^ (static_cast<size_t>(parentInode) * 0x9E3779B97F4A7C15ull);
+    }
+
+    std::atomic<const DentryCache::Entry *> *DentryCache::setFor(size_t hash) const
+    {
+        return &slots[(hash & setMask) * WAYS];
+    }
+
+    DentryCache::Stripe &DentryCache::stripeFor(size_t hash)
+    {
+        return stripes[(hash & setMask) % STRIPE_COUNT];
+    }
+
+    bool DentryCache::matches(const Entry *entry, size_t hash, unsigned int parentInode, const std::string &name)
+    {
+        return entry != nullptr && entry->hash == hash && entry->parentInode == parentInode && entry->name == name;
+    }
+
+    std::atomic<const DentryCache::Entry *> *DentryCache::find(std::atomic<const Entry *> *set, size_t hash,
+                                                               unsigned int parentInode, const std::string &name)
+    {
+        // Only writers call this, and they are serialized by the set's stripe
+        for (size_t way = 0; way < WAYS; way++)
+        {
+            if (matches(set[way].load(std::memory_order_relaxed), hash, parentInode, name))
+            {
+                return &set[way];
+            }
+        }
+        return nullptr;
+    }
+
+    bool DentryCache::lookup(unsigned int parentInode, const std::string &name, unsigned int &inodeIndex) const
+    {
+        // Each slot is loaded once and its entry compared and read through that pointer; the guard
+        // keeps the entry alive even if a writer replaces the slot meanwhile
+        if (!slots)
+        {
+            return false;
+        }
+        size_t hash = hashOf(parentInode, name);
+        const std::atomic<const Entry *> *set = setFor(hash);
+        EpochReclaimer::Guard guard;
+        for (size_t way = 0; way < WAYS; way++)
+        {
+            const Entry *entry = set[way].load(std::memory_order_acquire);
+            if (matches(entry, hash, parentInode, name))
+            {
+                inodeIndex = entry->inodeIndex;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void DentryCache::insert(unsigned int parentInode, const std::string &name, unsigned int inodeIndex,
+                             const std::function<bool()> &stillCurrent)
+    {
+        // 1. Drop the entry if the caller's check says it went stale
+        // 2. Replace the key's slot if it is cached, else fill an empty slot of its set,
+        //    else evict the stripe's next victim way
+        // 3. Publish the new entry with one store and retire the one it replaced
+        if (!slots)
+        {
+            return;
+        }
+        size_t hash = hashOf(parentInode, name);
+        Stripe &stripe = stripeFor(hash);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        if (stillCurrent && !stillCurrent())
+        {
+            return;
+        }
+
+        std::atomic<const Entry *> *set = setFor(hash);
+        std::atomic<const Entry *> *slot = find(set, hash, parentInode, name);
+        for (size_t way = 0; slot == nullptr && way < WAYS; way++)
+        {
+            if (set[way].load(std::memory_order_relaxed) == nullptr)
+            {
+                slot = &set[way];
+            }
+        }
+        if (slot == nullptr)
+        {
+            slot = &set[stripe.nextVictim++ % WAYS];
+        }
+
+        const Entry *old = slot->load(std::memory_order_relaxed);
+        slot->store(new Entry{hash, parentInode, inodeIndex, name}, std::memory_order_release);
+        if (old != nullptr)
+        {
+            EpochReclaimer::instance().retire(const_cast<Entry *>(old));
+        }
+    }
+
+    void DentryCache::invalidate(unsigned int parentInode, const std::string &name)
+    {
+        if (!slots)
+        {
+            return;
+        }
+        size_t hash = hashOf(parentInode, name);
+        std::lock_guard<std::mutex> lock(stripeFor(hash).mutex);
+        std::atomic<const Entry *> *slot = find(setFor(hash), hash, parentInode, name);
+        if (slot != nullptr)
+        {
+            const Entry *old = slot->exchange(nullptr, std::memory_order_acq_rel);
+            EpochReclaimer::instance().retire(const_cast<Entry *>(old));
+        }
+    }
+
+    void DentryCache::clear()
+    {
+        if (!slots)
+        {
+            return;
+        }
+        for (size_t set = 0; set <= setMask; set++)
+        {
+            std::lock_guard<std::mutex> lock(stripes[set % STRIPE_COUNT].mutex);
+            for (size_t way = 0; way < WAYS; way++)
+            {
+                const Entry *old = slots[set * WAYS + way].exchange(nullptr, std::memory_order_acq_rel);
+                if (old != nullptr)
+                {
+                    EpochReclaimer::instance().retire(const_cast<Entry *>(old));
+                }
+            }
+        }
+    }
+
+} // namespace cse4733
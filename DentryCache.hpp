@@ -0,0 +1,152 @@
+#ifndef DENTRYCACHE_HPP
+#define DENTRYCACHE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace cse4733
+{
+
+    /**
+     * @class DentryCache
+     * @brief Bounded cache of directory entries keyed by (parent inode, name).
+     *
+     * Path resolution consults the cache before the parent's Directory, so hot
+     * lookups need a single hash probe per component. Entries must be invalidated
+     * whenever the corresponding directory entry is removed.
+     *
+     * Every method is safe to call from several threads at once. The cache is a
+     * fixed array of small sets of slots, each an atomic pointer to an immutable
+     * entry, so a lookup takes no lock: it only loads and compares the slots of
+     * the key's set. Inserts and invalidations lock a stripe of sets against each
+     * other, publish a slot with a single store and retire the entry they replace
+     * through the EpochReclaimer, so a lookup never sees a freed entry.
+     */
+    class DentryCache
+    {
+    public:
+        /**
+         * @brief Constructs an empty cache.
+         *
+         * @param capacity The maximum number of entries kept, rounded up to a power of two; 0 caches nothing.
+         */
+        explicit DentryCache(size_t capacity = 4096);
+
+        /**
+         * @brief Destroys every entry still cached.
+         */
+        ~DentryCache();
+
+        DentryCache(const DentryCache &) = delete;
+        DentryCache &operator=(const DentryCache &) = delete;
+
+        /**
+         * @brief Looks up a cached entry without taking a lock.
+         *
+         * @param parentInode The inode index of the directory containing the entry.
+         * @param name The name of the entry.
+         * @param inodeIndex Set to the cached inode index on a hit.
+         * @return True on a cache hit, false otherwise.
+         */
+        bool lookup(unsigned int parentInode, const std::string &name, unsigned int &inodeIndex) const;
+
+        /**
+         * @brief Adds or replaces an entry, evicting another entry of its set if the set is full.
+         *
+         * @param stillCurrent If given, called with the set locked; the entry is only added if it returns true.
+         *        A caller that looked the entry up without a lock passes a check that the directory is unchanged,
+         *        so an entry removed in the meantime (and already invalidated) is not cached again.
+         */
+        void insert(unsigned int parentInode, const std::string &name, unsigned int inodeIndex,
+                    const std::function<bool()> &stillCurrent = nullptr);
+
+        /**
+         * @brief Removes an entry if it is cached.
+         */
+        void invalidate(unsigned int parentInode, const std::string &name);
+
+        /**
+         * @brief Removes every entry.
+         */
+        void clear();
+
+    private:
+        /**
+         * @brief A cached entry. Immutable once published.
+         */
+        struct Entry
+        {
+            size_t hash;
+            unsigned int parentInode;
+            unsigned int inodeIndex;
+            std::string name;
+        };
+
+        /**
+         * @brief One lock serializing the writers of a stripe of sets, on its own cache line.
+         */
+        struct alignas(64) Stripe
+        {
+            /* Held by inserts and invalidations of keys whose set maps to this stripe. */
+            std::mutex mutex;
+
+            /* Way the next insert into a full set of this stripe evicts. */
+            size_t nextVictim = 0;
+        };
+
+        /**
+         * @brief Hashes a key.
+         */
+        static size_t hashOf(unsigned int parentInode, const std::string &name);
+
+        /**
+         * @brief Returns the first of the WAYS slots of the set a hash selects.
+         */
+        std::atomic<const Entry *> *setFor(size_t hash) const;
+
+        /**
+         * @brief Returns the stripe whose lock guards the set a hash selects.
+         */
+        Stripe &stripeFor(size_t hash);
+
+        /**
+         * @brief Returns true if an entry is non-null and caches the given key.
+         */
+        static bool matches(const Entry *entry, size_t hash, unsigned int parentInode, const std::string &name);
+
+        /**
+         * @brief Returns the slot of a set holding a key, or null if the key is not cached. The caller holds the set's stripe.
+         */
+        static std::atomic<const Entry *> *find(std::atomic<const Entry *> *set, size_t hash,
+                                                unsigned int parentInode, const std::string &name);
+
+        /// Slots per set; a key may be cached in any slot of the set its hash selects.
+        static constexpr size_t WAYS = 4;
+
+        /// Number of writer locks the sets are spread over.
+        static constexpr size_t STRIPE_COUNT = 16;
+
+        /**
+         * @brief The number of sets minus one; the set count is a power of two.
+         */
+        size_t setMask = 0;
+
+        /**
+         * @brief The slots, WAYS per set; null for an empty slot. Empty when the capacity is 0.
+         */
+        std::unique_ptr<std::atomic<const Entry *>[]> slots;
+
+        /**
+         * @brief The writer locks.
+         */
+        std::array<Stripe, STRIPE_COUNT> stripes;
+    };
+
+} // namespace cse4733
+
+#endif // DENTRYCACHE_HPP
@@ -2,79 +2,204 @@
 #include "FileAlreadyExistsException.hpp"
 #include "FileMissingException.hpp"
 
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
 namespace cse4733
 {
 
-    Directory::Directory()
+    Directory::Directory() : parentInode(0)
     {
         // Initializes an empty directory.
     }
 
+    Directory::Directory(unsigned int parentInode) : parentInode(parentInode)
+    {
+        // Initializes an empty directory inside the given parent.
+    }
+
+    Directory::Directory(const Directory &other)
+        : parentInode(other.parentInode)
+    {
+        // Copy the entries in sorted order, indexing this directory's own copies of the names
+        fileTable.reserve(other.fileTable.size());
+        other.nameIndex.forEach([this, &other](std::string_view name)
+                                {
+                                    uint32_t inodeIndex = 0;
+                                    other.fileTable.find(name, inodeIndex);
+                                    nameIndex.insert(*fileTable.insert(std::string(name), inodeIndex)); });
+    }
+
+    Directory &Directory::operator=(const Directory &other)
+    {
+        if (this != &other)
+        {
+            Directory copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
     void Directory::addFile(const std::string &filename, int inodeIndex)
     {
-        // 1. Check if the file already exists in the directory
-        //    a. If it does, throw a FileAlreadyExistsException
-        // 2. Add the file to the directory with the associated inode index
-        if (fileExists(filename))
+        // Add the entry, throwing a FileAlreadyExistsException if the name is taken
+        if (tryAddFile(filename, inodeIndex) != ErrorCode::Ok)
         {
             throw FileAlreadyExistsException(filename); // File already exists
         }
+    }
 
-        // Add the file with the associated inode index
-        fileTable[filename] = inodeIndex;
+    ErrorCode Directory::tryAddFile(const std::string &filename, int inodeIndex)
+    {
+        // 1. Insert the name with the associated inode index; the table refuses a name it already holds
+        // 2. Index the table's copy of the name
+        const std::string *name = fileTable.insert(filename, static_cast<uint32_t>(inodeIndex));
+        if (name == nullptr)
+        {
+            return ErrorCode::AlreadyExists;
+        }
+        nameIndex.insert(*name);
+        return ErrorCode::Ok;
     }
 
     void Directory::removeFile(const std::string &filename)
     {
-        // Function: removeFile
-        //
-        // Input: filename (string) - The name of the file to remove
-        //
-        // 1. Check if the file exists in the directory
-        //    a. If it does not, throw a FileMissingException
-        // 2. Attempt to erase the file from the directory
-        if (!fileExists(filename))
+        // Remove the entry, throwing a FileMissingException if there is none
+        if (tryRemoveFile(filename) != ErrorCode::Ok)
         {
             throw FileMissingException(filename); // File does not exist
         }
-        else
+    }
+
+    ErrorCode Directory::tryRemoveFile(const std::string &filename)
+    {
+        // 1. Check if the file exists in the directory
+        // 2. Drop the name from the index before the string it views is destroyed
+        if (!fileExists(filename))
         {
-            // Attempt to erase the file from the directory
-            fileTable.erase(filename);
+            return ErrorCode::NotFound;
         }
+        nameIndex.erase(filename);
+        fileTable.erase(filename);
+        return ErrorCode::Ok;
     }
 
     unsigned int Directory::getInodeIndex(const std::string &filename) const
     {
-        // Check if the file exists using the fileExists method
-        // 1. If the file exists, find the file in the fileTable using the provided filename
-        //    a. If the file is found, return the associated inode index
-        // 2. If the file does not exist, throw a FileMissingException with the provided filename
-        auto it = fileTable.find(filename);
-        if (it != fileTable.end()) {
-            return it->second;
+        // Return the associated inode index, or throw a FileMissingException with the provided filename
+        Result<unsigned int> inodeIndex = tryGetInodeIndex(filename);
+        if (!inodeIndex)
+        {
+            throw FileMissingException(filename);
+        }
+        return inodeIndex.value();
+    }
+
+    Result<unsigned int> Directory::tryGetInodeIndex(const std::string &filename) const
+    {
+        uint32_t inodeIndex;
+        if (fileTable.find(filename, inodeIndex)) {
+            return inodeIndex;
         }
-        throw FileMissingException(filename);
+        return ErrorCode::NotFound;
     }
 
     std::vector<std::string> Directory::listFiles() const
     {
         // 1. Create a vector to store the filenames
-        // 2. Iterate over each entry in the fileTable
+        // 2. Walk the name index in sorted order
         //    a. Add the filename to the vector
         // 3. Return the vector of filenames
         std::vector<std::string> files;
-        for (const auto &entry : fileTable)
-        {
-            files.push_back(entry.first);
-        }
+        files.reserve(fileTable.size());
+        nameIndex.forEach([&files](std::string_view name)
+                          { files.emplace_back(name); });
+        return files;
+    }
+
+    std::vector<std::string> Directory::listFiles(const std::string &cursor, size_t limit, const std::string &prefix) const
+    {
+        std::vector<std::string> files;
+        nameIndex.collect(cursor, limit, prefix, files);
         return files;
     }
 
     bool Directory::fileExists(const std::string &filename) const
     {
         // Check if the file exists in the directory
-        return fileTable.find(filename) != fileTable.end();
+        return fileTable.contains(filename);
+    }
+
+    size_t Directory::size() const
+    {
+        return fileTable.size();
+    }
+
+    unsigned int Directory::getParentInode() const
+    {
+        return parentInode;
+    }
+
+    uint64_t Directory::getVersion() const
+    {
+        return fileTable.getVersion();
+    }
+
+    std::string Directory::serialize() const
+    {
+        // 1. Write the parent inode and the entry count
+        // 2. Write each entry as its inode index, name length and name, in sorted order
+        std::string data;
+        auto appendWord = [&data](uint32_t value)
+        { data.append(reinterpret_cast<const char *>(&value), sizeof(value)); };
+
+        appendWord(parentInode);
+        appendWord(static_cast<uint32_t>(fileTable.size()));
+        nameIndex.forEach([&](std::string_view name)
+                          {
+                              uint32_t inodeIndex = 0;
+                              fileTable.find(name, inodeIndex);
+                              appendWord(inodeIndex);
+                              appendWord(static_cast<uint32_t>(name.size()));
+                              data.append(name.data(), name.size()); });
+        return data;
+    }
+
+    Directory Directory::deserialize(const std::string &data)
+    {
+        // 1. Read the parent inode and the entry count
+        // 2. Read each entry back, stopping early if the data is truncated
+        size_t position = 0;
+        auto readWord = [&](uint32_t &value)
+        {
+            if (position + sizeof(value) > data.size())
+            {
+                return false;
+            }
+            std::memcpy(&value, data.data() + position, sizeof(value));
+            position += sizeof(value);
+            return true;
+        };
+
+        uint32_t parent = 0;
+        uint32_t count = 0;
+        readWord(parent);
+        readWord(count);
+        Directory directory(parent);
+        directory.fileTable.reserve(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint32_t inodeIndex;
+            uint32_t length;
+            if (!readWord(inodeIndex) || !readWord(length) || position + length > data.size())
+            {
+                break;
+            }
+            directory.addFile(data.substr(position, length), static_cast<int>(inodeIndex));
+            position += length;
+        }
+        return directory;
     }
 
 } // namespace cse4733
@@ -1,10 +1,14 @@
 #ifndef DIRECTORY_HPP
 #define DIRECTORY_HPP
 
+#include <cstdint>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
+#include "DirectoryIndex.hpp"
+#include "NameTable.hpp"
+#include "Result.hpp"
+
 /**
  * @namespace cse4733
  * @brief Namespace for all classes in the CSE 4733 filesystem project.
@@ -14,7 +18,16 @@ namespace cse4733
 
     /**
      * @class Directory
-     * @brief Manages the filesystem's directory structure, storing file names and their associated inode indices.
+     * @brief Manages the entries of one directory, storing file names and their associated inode indices.
+     *
+     * Subdirectories are ordinary entries whose inode is marked as a directory. Each
+     * directory also remembers the inode of its parent so ".." can be resolved.
+     * Lookups go through a hash table; listings go through a sorted, paged index over
+     * the same names, so they come back in stable order and can be paginated.
+     *
+     * getInodeIndex, tryGetInodeIndex, fileExists, size, getParentInode and getVersion take no lock and
+     * may run while another thread adds or removes entries. Everything else, including
+     * listing and serializing, must be serialized with writers by the caller.
      */
     class Directory
     {
@@ -24,6 +37,21 @@ namespace cse4733
          */
         Directory();
 
+        /**
+         * @brief Constructs an empty directory inside a parent directory.
+         *
+         * @param parentInode The inode index of the parent directory. The root is its own parent.
+         */
+        explicit Directory(unsigned int parentInode);
+
+        /**
+         * @brief Copies a directory, rebuilding the name index over the copied names.
+         */
+        Directory(const Directory &other);
+        Directory &operator=(const Directory &other);
+        Directory(Directory &&other) = default;
+        Directory &operator=(Directory &&other) = default;
+
         /**
          * @brief Adds a new file entry to the directory.
          *
@@ -33,6 +61,15 @@ namespace cse4733
          */
         void addFile(const std::string &filename, int inodeIndex);
 
+        /**
+         * @brief Adds a new file entry to the directory without throwing.
+         *
+         * @param filename The name of the file to add.
+         * @param inodeIndex The inode index associated with this file.
+         * @return ErrorCode::Ok, or ErrorCode::AlreadyExists if the name is taken.
+         */
+        ErrorCode tryAddFile(const std::string &filename, int inodeIndex);
+
         /**
          * @brief Removes a file entry from the directory by its name.
          *
@@ -41,6 +78,14 @@ namespace cse4733
          */
         void removeFile(const std::string &filename);
 
+        /**
+         * @brief Removes a file entry from the directory without throwing.
+         *
+         * @param filename The name of the file to remove.
+         * @return ErrorCode::Ok, or ErrorCode::NotFound if there is no such entry.
+         */
+        ErrorCode tryRemoveFile(const std::string &filename);
+
         /**
          * @brief Gets the inode index of a file.
          *
@@ -50,13 +95,31 @@ namespace cse4733
          */
         unsigned int getInodeIndex(const std::string &filename) const;
 
+        /**
+         * @brief Gets the inode index of a file without throwing; takes no lock, like getInodeIndex.
+         *
+         * @param filename The name of the file.
+         * @return The inode index of the file, or ErrorCode::NotFound.
+         */
+        Result<unsigned int> tryGetInodeIndex(const std::string &filename) const;
+
         /**
          * @brief Lists all files currently in the directory.
          *
-         * @return A vector of strings, each representing a filename in the directory.
+         * @return A vector of strings, each representing a filename in the directory, in sorted order.
          */
         std::vector<std::string> listFiles() const;
 
+        /**
+         * @brief Lists one page of files in sorted order.
+         *
+         * @param cursor Only names after the cursor are returned; pass the last name of the previous page, or empty to start.
+         * @param limit The maximum number of names to return.
+         * @param prefix Only names beginning with this prefix are returned.
+         * @return Up to limit filenames in sorted order.
+         */
+        std::vector<std::string> listFiles(const std::string &cursor, size_t limit, const std::string &prefix = "") const;
+
         /**
          * @brief Checks if a file exists in the directory.
          *
@@ -65,13 +128,59 @@ namespace cse4733
          */
         bool fileExists(const std::string &filename) const;
 
+        /**
+         * @brief Returns the number of entries in the directory.
+         */
+        size_t size() const;
+
+        /**
+         * @brief Returns the inode index of the parent directory.
+         */
+        unsigned int getParentInode() const;
+
+        /**
+         * @brief Returns a counter that every addFile and removeFile increases.
+         */
+        uint64_t getVersion() const;
+
+        /**
+         * @brief Encodes the directory as bytes for storage in its inode's blocks.
+         *
+         * The layout is the parent inode and the entry count, followed by each entry's
+         * inode index, name length and name bytes, all integers as native uint32_t.
+         *
+         * @return The encoded directory.
+         */
+        std::string serialize() const;
+
+        /**
+         * @brief Decodes a directory produced by serialize().
+         *
+         * @param data The encoded directory. Empty data decodes to an empty directory whose parent is inode 0.
+         * @return The decoded directory.
+         */
+        static Directory deserialize(const std::string &data);
+
     private:
+        /**
+         * @brief The inode index of the parent directory.
+         */
+        unsigned int parentInode;
+
         /**
          * @brief A hash table mapping file names to their inode indices.
          *
-         * This allows for efficient lookup, addition, and removal of files within the directory.
+         * This allows for efficient lookup, addition, and removal of files within the directory,
+         * and lookups never wait for additions or removals.
+         */
+        NameTable fileTable;
+
+        /**
+         * @brief Sorted index over the names owned by fileTable.
+         *
+         * The index holds views of fileTable's names, which stay put while their entries exist.
          */
-        std::unordered_map<std::string, int> fileTable;
+        DirectoryIndex nameIndex;
     };
 
 } // namespace cse4733
@@ -0,0 +1,104 @@
+#include "DirectoryIndex.hpp"
+
+#include <algorithm>
+
+namespace cse4733
+{
+
+    size_t DirectoryIndex::findPage(std::string_view name) const
+    {
+        auto it = std::lower_bound(pages.begin(), pages.end(), name,
+                                   [](const std::vector<std::string_view> &page, std::string_view key)
+                                   { return page.back() < key; });
+        return static_cast<size_t>(it - pages.begin());
+    }
+
+    void DirectoryIndex::insert(std::string_view name)
+    {
+        // 1. Pick the page the name belongs in, or the last page if it sorts after everything
+        //    (an empty index gets a first page holding just this name)
+        // 2. Insert the name in sorted position within that page
+        // 3. Split the page in half if it has grown too large
+        if (pages.empty())
+        {
+            pages.push_back({name});
+            return;
+        }
+        size_t pageIndex = std::min(findPage(name), pages.size() - 1);
+        std::vector<std::string_view> &page = pages[pageIndex];
+        page.insert(std::lower_bound(page.begin(), page.end(), name), name);
+
+        if (page.size() > MAX_PAGE_SIZE)
+        {
+            std::vector<std::string_view> upper(page.begin() + page.size() / 2, page.end());
+            page.resize(page.size() / 2);
+            pages.insert(pages.begin() + pageIndex + 1, std::move(upper));
+        }
+    }
+
+    void DirectoryIndex::erase(std::string_view name)
+    {
+        // 1. Find the page and position of the name
+        // 2. Remove it, dropping the page entirely once it is empty
+        size_t pageIndex = findPage(name);
+        if (pageIndex == pages.size())
+        {
+            return;
+        }
+        std::vector<std::string_view> &page = pages[pageIndex];
+        auto it = std::lower_bound(page.begin(), page.end(), name);
+        if (it == page.end() || *it != name)
+        {
+            return;
+        }
+        page.erase(it);
+        if (page.empty())
+        {
+            pages.erase(pages.begin() + pageIndex);
+        }
+    }
+
+    void DirectoryIndex::clear()
+    {
+        pages.clear();
+    }
+
+    void DirectoryIndex::collect(const std::string &cursor, size_t limit, const std::string &prefix, std::vector<std::string> &out) const
+    {
+        // 1. Start at whichever comes later: just past the cursor, or the first name with the prefix
+        // 2. Walk forward through the pages until the limit is reached or a name no longer has the prefix
+        std::string_view start = std::max<std::string_view>(cursor, prefix);
+        bool skipEqual = !cursor.empty() && start == cursor;
+
+        size_t pageIndex = findPage(start);
+        if (pageIndex == pages.size())
+        {
+            return;
+        }
+        const std::vector<std::string_view> *page = &pages[pageIndex];
+        auto it = skipEqual ? std::upper_bound(page->begin(), page->end(), start)
+                            : std::lower_bound(page->begin(), page->end(), start);
+
+        size_t taken = 0;
+        while (taken < limit)
+        {
+            if (it == page->end())
+            {
+                if (++pageIndex == pages.size())
+                {
+                    return;
+                }
+                page = &pages[pageIndex];
+                it = page->begin();
+            }
+            if (it->compare(0, prefix.size(), prefix) != 0)
+            {
+                return;
+            }
+            out.emplace_back(*it);
+            ++it;
+            ++taken;
+        }
+    }
+
+} // namespace cse4733
@@ -0,0 +1,84 @@
+#ifndef DIRECTORYINDEX_HPP
+#define DIRECTORYINDEX_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cse4733
+{
+
+    /**
+     * @class DirectoryIndex
+     * @brief Ordered index of the names in a directory, stored as a list of sorted pages.
+     *
+     * Each page holds at most MAX_PAGE_SIZE names in sorted order, and the pages
+     * themselves are in order, so a name is found with two binary searches and an
+     * insert or erase only shifts entries within one page. The index stores views
+     * of names owned elsewhere; the owner must keep each name alive and unmoved
+     * until it has been erased from the index.
+     */
+    class DirectoryIndex
+    {
+    public:
+        /**
+         * @brief Adds a name to the index. The name must not already be present.
+         */
+        void insert(std::string_view name);
+
+        /**
+         * @brief Removes a name from the index if it is present.
+         */
+        void erase(std::string_view name);
+
+        /**
+         * @brief Removes every name.
+         */
+        void clear();
+
+        /**
+         * @brief Collects names in sorted order, starting after a cursor.
+         *
+         * @param cursor Only names strictly greater than the cursor are returned; empty starts at the beginning.
+         * @param limit The maximum number of names to return.
+         * @param prefix Only names beginning with this prefix are returned.
+         * @param out The vector the names are appended to.
+         */
+        void collect(const std::string &cursor, size_t limit, const std::string &prefix, std::vector<std::string> &out) const;
+
+        /**
+         * @brief Calls visit for every name in sorted order.
+         */
+        template <typename Visitor>
+        void forEach(Visitor visit) const
+        {
+            for (const auto &page : pages)
+            {
+                for (std::string_view name : page)
+                {
+                    visit(name);
+                }
+            }
+        }
+
+    private:
+        /**
+         * @brief Pages are split in half once they grow past this many names.
+         */
+        static constexpr size_t MAX_PAGE_SIZE = 256;
+
+        /**
+         * @brief Returns the index of the page a name belongs in: the first page whose last name is not less than it.
+         */
+        size_t findPage(std::string_view name) const;
+
+        /**
+         * @brief Sorted pages of names, in order.
+         */
+        std::vector<std::vector<std::string_view>> pages;
+    };
+
+} // namespace cse4733
+
+#endif // DIRECTORYINDEX_HPP
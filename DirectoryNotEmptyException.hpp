@@ -0,0 +1,19 @@
+#ifndef DIRECTORY_NOT_EMPTY_EXCEPTION_HPP
+#define DIRECTORY_NOT_EMPTY_EXCEPTION_HPP
+
+#include <stdexcept>
+#include <string>
+
+namespace cse4733
+{
+
+    class DirectoryNotEmptyException : public std::runtime_error
+    {
+    public:
+        explicit DirectoryNotEmptyException(const std::string &path)
+            : std::runtime_error("Directory not empty: " + path) {}
+    };
+
+} // namespace cse4733
+
+#endif // DIRECTORY_NOT_EMPTY_EXCEPTION_HPP
@@ -0,0 +1,379 @@
+#include "DiskImage.hpp"
+#include "DiskImageException.hpp"
+#include "FreeSpaceBitmap.hpp"
+#include "InodeTable.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cse4733
+{
+
+    namespace
+    {
+        constexpr uint64_t PAGE_SIZE = 4096;
+
+        // The most pages one Page record holds
+        constexpr size_t PAGES_PER_RECORD = 64;
+
+        inline uint64_t pageAlign(uint64_t offset)
+        {
+            return (offset + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+        }
+
+#ifndef _WIN32
+        bool writeAll(int fd, const char *data, size_t size, uint64_t offset)
+        {
+            while (size > 0)
+            {
+                ssize_t written = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+                if (written < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (written <= 0)
+                {
+                    return false;
+                }
+                data += written;
+                size -= static_cast<size_t>(written);
+                offset += static_cast<uint64_t>(written);
+            }
+            return true;
+        }
+
+        bool readAll(int fd, char *data, size_t size, uint64_t offset)
+        {
+            while (size > 0)
+            {
+                ssize_t count = ::pread(fd, data, size, static_cast<off_t>(offset));
+                if (count < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (count <= 0)
+                {
+                    return false;
+                }
+                data += count;
+                size -= static_cast<size_t>(count);
+                offset += static_cast<uint64_t>(count);
+            }
+            return true;
+        }
+#endif
+    } // namespace
+
+    Superblock DiskImage::layout(size_t totalBlocks, size_t blockSize, size_t inodeCount, AllocationPolicy policy)
+    {
+        Superblock sb{};
+        sb.magic = Superblock::MAGIC;
+        sb.version = Superblock::VERSION;
+        sb.blockSize = static_cast<uint32_t>(blockSize);
+        sb.totalBlocks = totalBlocks;
+        sb.inodeCount = inodeCount;
+        sb.allocationPolicy = static_cast<uint32_t>(policy);
+        sb.bitmapOffset = PAGE_SIZE;
+        sb.lengthsOffset = pageAlign(sb.bitmapOffset + FreeSpaceBitmap::wordsFor(totalBlocks) * sizeof(uint64_t));
+        sb.sharesOffset = pageAlign(sb.lengthsOffset + totalBlocks * sizeof(uint32_t));
+        sb.checksumsOffset = pageAlign(sb.sharesOffset + totalBlocks * sizeof(uint32_t));
+        sb.inodeOffset = pageAlign(sb.checksumsOffset + totalBlocks * sizeof(uint32_t));
+        sb.dataOffset = pageAlign(sb.inodeOffset + inodeCount * sizeof(Inode));
+        sb.imageSize = pageAlign(sb.dataOffset + static_cast<uint64_t>(totalBlocks) * blockSize);
+        sb.freeBlockCount = totalBlocks;
+        sb.freeInodeCount = inodeCount;
+        sb.freeInodeHead = inodeCount > 0 ? 0 : Inode::NO_BLOCK;
+        sb.rootInode = 0;
+        sb.clean = 1;
+        return sb;
+    }
+
+    bool DiskImage::isValidLayout(const Superblock &sb, size_t fileSize)
+    {
+        // 1. Bound the geometry by the file size first, so computing the layout cannot overflow
+        // 2. Require every region offset and the image size to match the layout for that geometry
+        // 3. Require the counts the allocator and inode table start from to be in range
+        if (sb.blockSize == 0 || sb.totalBlocks > Inode::NO_BLOCK || sb.inodeCount > Inode::NO_BLOCK ||
+            sb.totalBlocks > fileSize / sb.blockSize || sb.inodeCount > fileSize / sizeof(Inode))
+        {
+            return false;
+        }
+        Superblock expected = layout(sb.totalBlocks, sb.blockSize, sb.inodeCount, AllocationPolicy::BestFit);
+        if (sb.bitmapOffset != expected.bitmapOffset || sb.lengthsOffset != expected.lengthsOffset ||
+            sb.sharesOffset != expected.sharesOffset || sb.checksumsOffset != expected.checksumsOffset ||
+            sb.inodeOffset != expected.inodeOffset || sb.dataOffset != expected.dataOffset ||
+            sb.imageSize != expected.imageSize || sb.imageSize > fileSize)
+        {
+            return false;
+        }
+        return sb.freeBlockCount <= sb.totalBlocks && sb.freeInodeCount <= sb.inodeCount &&
+               (sb.freeInodeHead < sb.inodeCount || sb.freeInodeHead == Inode::NO_BLOCK) &&
+               sb.rootInode < sb.inodeCount;
+    }
+
+#ifndef _WIN32
+
+    void DiskImage::create(const std::string &path, size_t totalBlocks, size_t blockSize, size_t inodeCount, AllocationPolicy policy)
+    {
+        // 1. Create the file at its full size; the new file reads as zeros, so block lengths, share counts and checksums start empty
+        // 2. Map it and write the superblock, an all-free bitmap and a freshly linked inode table
+        // 3. Write those pages to the file and unmap
+        Superblock sb = layout(totalBlocks, blockSize, inodeCount, policy);
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            throw DiskImageException(path, std::strerror(errno));
+        }
+        if (::ftruncate(fd, static_cast<off_t>(sb.imageSize)) != 0)
+        {
+            int error = errno;
+            ::close(fd);
+            throw DiskImageException(path, std::strerror(error));
+        }
+        ::close(fd);
+
+        DiskImage image(path, sb);
+        FreeSpaceBitmap::clear(reinterpret_cast<uint64_t *>(image.base + sb.bitmapOffset), totalBlocks);
+        InodeTable::format(image.inodeRecords(), inodeCount);
+        image.writePages(image.modifiedPages());
+    }
+
+    DiskImage::DiskImage(const std::string &path)
+        : DiskImage(path, Superblock{})
+    {
+    }
+
+    DiskImage::DiskImage(const std::string &path, const Superblock &initial)
+        : path(path), fd(-1), base(nullptr), size(0)
+    {
+        // 1. Open the file and map all of it privately, so stores only reach the file through checkpoint
+        // 2. When creating, write the initial superblock; then check that every region it describes lies inside the file
+        fd = ::open(path.c_str(), O_RDWR);
+        if (fd < 0)
+        {
+            throw DiskImageException(path, std::strerror(errno));
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) < PAGE_SIZE)
+        {
+            ::close(fd);
+            throw DiskImageException(path, "file is too small to be an image");
+        }
+        size = static_cast<size_t>(info.st_size);
+        void *mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            int error = errno;
+            ::close(fd);
+            throw DiskImageException(path, std::strerror(error));
+        }
+        base = static_cast<char *>(mapping);
+
+        if (initial.magic == Superblock::MAGIC)
+        {
+            superblock() = initial;
+        }
+        const Superblock &sb = superblock();
+        if (sb.magic != Superblock::MAGIC || sb.version != Superblock::VERSION || !isValidLayout(sb, size))
+        {
+            ::munmap(base, size);
+            ::close(fd);
+            throw DiskImageException(path, "not a valid filesystem image");
+        }
+    }
+
+    DiskImage::~DiskImage()
+    {
+        ::munmap(base, size);
+        ::close(fd);
+    }
+
+    void DiskImage::checkpoint(Journal &journal)
+    {
+        // 1. Find the pages that differ from the file
+        // 2. Log them in runs of adjacent pages, then the Checkpoint record, and commit
+        // 3. Only now overwrite the pages in the file
+        std::vector<uint64_t> pages = modifiedPages();
+        for (size_t i = 0; i < pages.size();)
+        {
+            size_t run = 1;
+            while (i + run < pages.size() && run < PAGES_PER_RECORD && pages[i + run] == pages[i] + run * PAGE_SIZE)
+            {
+                run++;
+            }
+            size_t length = std::min<uint64_t>(run * PAGE_SIZE, size - pages[i]);
+            if (journal.append(Journal::Record{Journal::RecordType::Page, std::string(), pages[i], std::string(base + pages[i], length)}))
+            {
+                journal.commit();
+            }
+            i += run;
+        }
+        journal.append(Journal::Record{Journal::RecordType::Checkpoint, std::string(), 0, std::string()});
+        journal.commit();
+        writePages(pages);
+    }
+
+    bool DiskImage::finishCheckpoint(const std::string &path, const std::vector<Journal::Record> &records)
+    {
+        // 1. Find the last Checkpoint record; without one, no checkpoint has started writing the file
+        // 2. Rewrite the run of Page records just before it, which that checkpoint logged, and sync
+        auto marker = std::find_if(records.rbegin(), records.rend(), [](const Journal::Record &record) {
+            return record.type == Journal::RecordType::Checkpoint;
+        });
+        if (marker == records.rend())
+        {
+            return false;
+        }
+        auto first = marker + 1;
+        while (first != records.rend() && first->type == Journal::RecordType::Page)
+        {
+            ++first;
+        }
+
+        int fd = ::open(path.c_str(), O_RDWR);
+        if (fd < 0)
+        {
+            throw DiskImageException(path, std::strerror(errno));
+        }
+        for (auto it = marker + 1; it != first; ++it)
+        {
+            if (!writeAll(fd, it->data.data(), it->data.size(), it->offset))
+            {
+                int error = errno;
+                ::close(fd);
+                throw DiskImageException(path, std::strerror(error));
+            }
+        }
+        if (::fsync(fd) != 0)
+        {
+            int error = errno;
+            ::close(fd);
+            throw DiskImageException(path, std::strerror(error));
+        }
+        ::close(fd);
+        return true;
+    }
+
+    std::vector<uint64_t> DiskImage::modifiedPages() const
+    {
+        // Compare the mapping with the file a chunk at a time
+        constexpr size_t CHUNK_SIZE = 256 * PAGE_SIZE;
+        std::vector<uint64_t> pages;
+        std::vector<char> buffer(CHUNK_SIZE);
+        for (uint64_t chunk = 0; chunk < size; chunk += CHUNK_SIZE)
+        {
+            size_t length = std::min<uint64_t>(CHUNK_SIZE, size - chunk);
+            if (!readAll(fd, buffer.data(), length, chunk))
+            {
+                throw DiskImageException(path, std::strerror(errno));
+            }
+            for (size_t page = 0; page < length; page += PAGE_SIZE)
+            {
+                size_t pageLength = std::min<size_t>(PAGE_SIZE, length - page);
+                if (std::memcmp(base + chunk + page, buffer.data() + page, pageLength) != 0)
+                {
+                    pages.push_back(chunk + page);
+                }
+            }
+        }
+        return pages;
+    }
+
+    void DiskImage::writePages(const std::vector<uint64_t> &pages)
+    {
+        for (size_t i = 0; i < pages.size();)
+        {
+            size_t run = 1;
+            while (i + run < pages.size() && pages[i + run] == pages[i] + run * PAGE_SIZE)
+            {
+                run++;
+            }
+            size_t length = std::min<uint64_t>(run * PAGE_SIZE, size - pages[i]);
+            if (!writeAll(fd, base + pages[i], length, pages[i]))
+            {
+                throw DiskImageException(path, std::strerror(errno));
+            }
+            i += run;
+        }
+        if (::fsync(fd) != 0)
+        {
+            throw DiskImageException(path, std::strerror(errno));
+        }
+    }
+
+#else
+
+    void DiskImage::create(const std::string &path, size_t, size_t, size_t, AllocationPolicy)
+    {
+        throw DiskImageException(path, "memory-mapped images are not supported on this platform");
+    }
+
+    DiskImage::DiskImage(const std::string &path)
+        : DiskImage(path, Superblock{})
+    {
+    }
+
+    DiskImage::DiskImage(const std::string &path, const Superblock &)
+        : path(path), fd(-1), base(nullptr), size(0)
+    {
+        throw DiskImageException(path, "memory-mapped images are not supported on this platform");
+    }
+
+    DiskImage::~DiskImage()
+    {
+    }
+
+    void DiskImage::checkpoint(Journal &)
+    {
+    }
+
+    bool DiskImage::finishCheckpoint(const std::string &, const std::vector<Journal::Record> &)
+    {
+        return false;
+    }
+
+    std::vector<uint64_t> DiskImage::modifiedPages() const
+    {
+        return {};
+    }
+
+    void DiskImage::writePages(const std::vector<uint64_t> &)
+    {
+    }
+
+#endif
+
+    Superblock &DiskImage::superblock()
+    {
+        return *reinterpret_cast<Superblock *>(base);
+    }
+
+    BlockRegions DiskImage::blockRegions()
+    {
+        const Superblock &sb = superblock();
+        return BlockRegions{base + sb.dataOffset,
+                            reinterpret_cast<uint32_t *>(base + sb.lengthsOffset),
+                            reinterpret_cast<uint32_t *>(base + sb.sharesOffset),
+                            reinterpret_cast<uint32_t *>(base + sb.checksumsOffset),
+                            reinterpret_cast<uint64_t *>(base + sb.bitmapOffset)};
+    }
+
+    Inode *DiskImage::inodeRecords()
+    {
+        return reinterpret_cast<Inode *>(base + superblock().inodeOffset);
+    }
+
+    const std::string &DiskImage::getPath() const
+    {
+        return path;
+    }
+
+} // namespace cse4733
@@ -0,0 +1,213 @@
+#ifndef DISKIMAGE_HPP
+#define DISKIMAGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BlockManager.hpp"
+#include "Inode.hpp"
+#include "Journal.hpp"
+
+namespace cse4733
+{
+
+    /**
+     * @brief On-disk header stored in the first page of a disk image.
+     *
+     * Every region offset is page aligned, so each region can be used in place once
+     * the image is mapped.
+     */
+    struct Superblock
+    {
+        /* Identifies the file as a filesystem image, MAGIC. */
+        uint64_t magic;
+
+        /* Layout version, VERSION. */
+        uint32_t version;
+
+        /* Size of each block in bytes. */
+        uint32_t blockSize;
+
+        /* Number of data blocks. */
+        uint64_t totalBlocks;
+
+        /* Number of inode records. */
+        uint64_t inodeCount;
+
+        /* AllocationPolicy the volume was formatted with. */
+        uint32_t allocationPolicy;
+
+        /* Non-zero if the volume was synced and unmounted cleanly, so the counts below can be trusted. */
+        uint32_t clean;
+
+        /* Byte offsets of the free-space bitmap, block length table, block share counts, block checksums, inode table and block data. */
+        uint64_t bitmapOffset;
+        uint64_t lengthsOffset;
+        uint64_t sharesOffset;
+        uint64_t checksumsOffset;
+        uint64_t inodeOffset;
+        uint64_t dataOffset;
+
+        /* Total size of the image file in bytes. */
+        uint64_t imageSize;
+
+        /* Free block and inode counts, and the head of the free-inode stack, as of the last sync. */
+        uint64_t freeBlockCount;
+        uint64_t freeInodeCount;
+        uint32_t freeInodeHead;
+
+        /* Inode index of the root directory. */
+        uint32_t rootInode;
+
+        static constexpr uint64_t MAGIC = 0x31474D4953465343ull; // "CSFSIMG1"
+        static constexpr uint32_t VERSION = 4;
+    };
+
+    /**
+     * @class DiskImage
+     * @brief A filesystem image file on the local disk, memory-mapped in its entirety.
+     *
+     * The image is laid out as a superblock page followed by the free-space bitmap,
+     * the per-block length, share count and checksum tables, the inode table and the block data, each starting
+     * on a page boundary. Opening an image only maps it; BlockManager and InodeTable
+     * then work directly on the mapped regions.
+     *
+     * The mapping is private, so changes stay in memory until checkpoint() writes them
+     * to the file; the file always holds the last complete checkpoint, and a journal of
+     * the operations since then can be replayed over it. A checkpoint first logs the
+     * pages it is about to overwrite, so one interrupted by a crash is finished by
+     * finishCheckpoint before the image is mapped again.
+     */
+    class DiskImage
+    {
+    public:
+        /**
+         * @brief Creates a new, formatted image file, replacing any existing file at path.
+         *
+         * @param path The path of the image file.
+         * @param totalBlocks The number of data blocks.
+         * @param blockSize The size of each block in bytes.
+         * @param inodeCount The number of inode records.
+         * @param policy The allocation policy recorded in the superblock.
+         * @throw DiskImageException if the file cannot be created or mapped.
+         */
+        static void create(const std::string &path, size_t totalBlocks, size_t blockSize, size_t inodeCount, AllocationPolicy policy);
+
+        /**
+         * @brief Opens and maps an existing image file.
+         *
+         * @param path The path of the image file.
+         * @throw DiskImageException if the file cannot be opened or mapped, or is not a valid image.
+         */
+        explicit DiskImage(const std::string &path);
+
+        /**
+         * @brief Unmaps the image, dropping every change made since the last checkpoint.
+         */
+        ~DiskImage();
+
+        DiskImage(const DiskImage &) = delete;
+        DiskImage &operator=(const DiskImage &) = delete;
+
+        /**
+         * @brief Returns the mapped superblock.
+         */
+        Superblock &superblock();
+
+        /**
+         * @brief Returns the mapped block regions, with the free count taken from the superblock.
+         */
+        BlockRegions blockRegions();
+
+        /**
+         * @brief Returns the first mapped inode record.
+         */
+        Inode *inodeRecords();
+
+        /**
+         * @brief Writes every page that differs from the file back to it, logging the pages first.
+         *
+         * The pages are appended to the journal as Page records followed by a Checkpoint
+         * record and committed, together with any operation records still pending; only
+         * then is the file written and synced. The caller empties the journal afterwards.
+         *
+         * @param journal The journal of the operations since the last checkpoint.
+         * @throw DiskImageException if the file cannot be read or written.
+         * @throw JournalException if the journal cannot be committed; the file is then unchanged.
+         */
+        void checkpoint(Journal &journal);
+
+        /**
+         * @brief Completes a checkpoint that a crash interrupted, before the image is mapped.
+         *
+         * @param path The path of the image file.
+         * @param records The records read from the image's journal.
+         * @return True if the records end in a complete checkpoint, whose pages are now in the file;
+         *         every operation record before it is then contained in the image.
+         * @throw DiskImageException if the file cannot be written.
+         */
+        static bool finishCheckpoint(const std::string &path, const std::vector<Journal::Record> &records);
+
+        /**
+         * @brief Returns the path the image was opened from.
+         */
+        const std::string &getPath() const;
+
+    private:
+        /**
+         * @brief Opens and maps an image file, writing initial as its superblock when it carries MAGIC.
+         */
+        DiskImage(const std::string &path, const Superblock &initial);
+
+        /**
+         * @brief Computes the region offsets and image size for a geometry.
+         */
+        static Superblock layout(size_t totalBlocks, size_t blockSize, size_t inodeCount, AllocationPolicy policy);
+
+        /**
+         * @brief Checks that a superblock read from disk describes a layout that fits in the file.
+         *
+         * The region offsets and image size must be exactly those layout computes for the
+         * recorded geometry, and the image must not extend past the end of the file.
+         *
+         * @param sb The superblock to check.
+         * @param fileSize The size of the image file in bytes.
+         */
+        static bool isValidLayout(const Superblock &sb, size_t fileSize);
+
+        /**
+         * @brief Returns the offsets of the pages whose mapped contents differ from the file.
+         */
+        std::vector<uint64_t> modifiedPages() const;
+
+        /**
+         * @brief Writes pages of the mapping to the file, coalescing adjacent ones, and syncs it.
+         */
+        void writePages(const std::vector<uint64_t> &pages);
+
+        /**
+         * @brief The path the image was opened from.
+         */
+        std::string path;
+
+        /**
+         * @brief File descriptor of the open image file.
+         */
+        int fd;
+
+        /**
+         * @brief Start of the mapping.
+         */
+        char *base;
+
+        /**
+         * @brief Length of the mapping in bytes.
+         */
+        size_t size;
+    };
+
+} // namespace cse4733
+
+#endif // DISKIMAGE_HPP
@@ -0,0 +1,19 @@
+#ifndef DISK_IMAGE_EXCEPTION_HPP
+#define DISK_IMAGE_EXCEPTION_HPP
+
+#include <stdexcept>
+#include <string>
+
+namespace cse4733
+{
+
+    class DiskImageException : public std::runtime_error
+    {
+    public:
+        DiskImageException(const std::string &path, const std::string &reason)
+            : std::runtime_error("Disk image " + path + ": " + reason) {}
+    };
+
+} // namespace cse4733
+
+#endif // DISK_IMAGE_EXCEPTION_HPP
@@ -0,0 +1,150 @@
+#include "EpochReclaimer.hpp"
+
+#include <algorithm>
+
+namespace cse4733
+{
+
+    EpochReclaimer::Guard::Guard()
+    {
+        instance().enter();
+    }
+
+    EpochReclaimer::Guard::~Guard()
+    {
+        instance().leave();
+    }
+
+    EpochReclaimer &EpochReclaimer::instance()
+    {
+        static EpochReclaimer reclaimer;
+        return reclaimer;
+    }
+
+    EpochReclaimer::ThreadState::~ThreadState()
+    {
+        // Hand the record back for the next thread to claim
+        if (participant != nullptr)
+        {
+            participant->epoch.store(0, std::memory_order_release);
+            participant->inUse.store(false, std::memory_order_release);
+        }
+    }
+
+    EpochReclaimer::ThreadState &EpochReclaimer::threadState()
+    {
+        thread_local ThreadState state;
+        return state;
+    }
+
+    EpochReclaimer::~EpochReclaimer()
+    {
+        for (const Retired &entry : retired)
+        {
+            entry.destroy(entry.object);
+        }
+        Participant *participant = participants.load(std::memory_order_acquire);
+        while (participant != nullptr)
+        {
+            Participant *next = participant->next;
+            delete participant;
+            participant = next;
+        }
+    }
+
+    EpochReclaimer::Participant *EpochReclaimer::claimParticipant()
+    {
+        // 1. Reuse a record left behind by an exited thread
+        // 2. Otherwise push a new record onto the list
+        for (Participant *participant = participants.load(std::memory_order_acquire); participant != nullptr;
+             participant = participant->next)
+        {
+            bool expected = false;
+            if (participant->inUse.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+            {
+                return participant;
+            }
+        }
+        Participant *participant = new Participant;
+        participant->inUse.store(true, std::memory_order_relaxed);
+        participant->next = participants.load(std::memory_order_relaxed);
+        while (!participants.compare_exchange_weak(participant->next, participant, std::memory_order_acq_rel))
+        {
+        }
+        return participant;
+    }
+
+    void EpochReclaimer::enter()
+    {
+        // 1. Nested guards share the outermost guard's epoch
+        // 2. Publish the global epoch, then fence so no read of the protected structure
+        //    can be ordered before the publication is visible to writers
+        ThreadState &state = threadState();
+        if (state.depth++ > 0)
+        {
+            return;
+        }
+        if (state.participant == nullptr)
+        {
+            state.participant = claimParticipant();
+        }
+        state.participant->epoch.store(globalEpoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    void EpochReclaimer::leave()
+    {
+        ThreadState &state = threadState();
+        if (--state.depth == 0)
+        {
+            state.participant->epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    void EpochReclaimer::tryAdvance()
+    {
+        // A reader still pinned at an older epoch may hold objects retired in it, so wait for it
+        uint64_t epoch = globalEpoch.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (Participant *participant = participants.load(std::memory_order_acquire); participant != nullptr;
+             participant = participant->next)
+        {
+            uint64_t pinned = participant->epoch.load(std::memory_order_acquire);
+            if (pinned != 0 && pinned != epoch)
+            {
+                return;
+            }
+        }
+        globalEpoch.store(epoch + 1, std::memory_order_release);
+    }
+
+    void EpochReclaimer::retire(void *object, void (*destroy)(void *))
+    {
+        // 1. Queue the object under the current epoch
+        // 2. Try to advance the epoch
+        // 3. Destroy everything retired at least two epochs ago; no reader can still reach it
+        std::vector<Retired> expired;
+        {
+            std::lock_guard<std::mutex> lock(retiredMutex);
+            retired.push_back(Retired{globalEpoch.load(std::memory_order_acquire), object, destroy});
+            tryAdvance();
+            uint64_t epoch = globalEpoch.load(std::memory_order_relaxed);
+            auto end = std::find_if(retired.begin(), retired.end(),
+                                    [epoch](const Retired &entry)
+                                    { return entry.epoch + 2 > epoch; });
+            expired.assign(retired.begin(), end);
+            retired.erase(retired.begin(), end);
+        }
+        for (const Retired &entry : expired)
+        {
+            entry.destroy(entry.object);
+        }
+    }
+
+    size_t EpochReclaimer::getPendingCount() const
+    {
+        std::lock_guard<std::mutex> lock(retiredMutex);
+        return retired.size();
+    }
+
+} // namespace cse4733
@@ -0,0 +1,170 @@
+#ifndef EPOCHRECLAIMER_HPP
+#define EPOCHRECLAIMER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace cse4733
+{
+
+    /**
+     * @class EpochReclaimer
+     * @brief Epoch-based deferred reclamation for structures that are read without locks.
+     *
+     * Readers pin the current epoch for the duration of a read with a Guard, which
+     * only writes to the calling thread's own cache line. A writer that unlinks an
+     * object retires it instead of deleting it; the object is destroyed once the
+     * global epoch has advanced twice past the epoch it was retired in, by which time
+     * every reader that could still have been looking at it has unpinned.
+     *
+     * There is a single process-wide instance. Guards may be nested.
+     */
+    class EpochReclaimer
+    {
+    public:
+        /**
+         * @class Guard
+         * @brief Pins the calling thread's epoch for the guard's lifetime.
+         *
+         * Objects reachable while the guard is held are not destroyed until it is released.
+         */
+        class Guard
+        {
+        public:
+            Guard();
+            ~Guard();
+
+            Guard(const Guard &) = delete;
+            Guard &operator=(const Guard &) = delete;
+        };
+
+        /**
+         * @brief Returns the process-wide instance.
+         */
+        static EpochReclaimer &instance();
+
+        /**
+         * @brief Destroys an unlinked object once no reader can still hold it.
+         *
+         * The object must already be unreachable to new readers. Destruction happens on a
+         * later retire call, possibly from another thread, or when the process exits.
+         *
+         * @param object The object to destroy.
+         * @param destroy Function that destroys the object.
+         */
+        void retire(void *object, void (*destroy)(void *));
+
+        /**
+         * @brief Retires an object allocated with new.
+         */
+        template <typename T>
+        void retire(T *object)
+        {
+            retire(object, [](void *pointer)
+                   { delete static_cast<T *>(pointer); });
+        }
+
+        /**
+         * @brief Returns the number of retired objects that have not been destroyed yet.
+         */
+        size_t getPendingCount() const;
+
+        EpochReclaimer(const EpochReclaimer &) = delete;
+        EpochReclaimer &operator=(const EpochReclaimer &) = delete;
+
+    private:
+        /**
+         * @brief A thread's published epoch, on its own cache line. Records are reused after their thread exits.
+         */
+        struct alignas(64) Participant
+        {
+            /* The epoch the thread pinned, or 0 when it is not reading. */
+            std::atomic<uint64_t> epoch{0};
+
+            /* Whether a live thread owns the record. */
+            std::atomic<bool> inUse{false};
+
+            /* The next record in the list. Records are never unlinked. */
+            Participant *next = nullptr;
+        };
+
+        /**
+         * @brief An object waiting for destruction and the epoch it was retired in.
+         */
+        struct Retired
+        {
+            uint64_t epoch;
+            void *object;
+            void (*destroy)(void *);
+        };
+
+        /**
+         * @brief The calling thread's reader state: its record and guard nesting depth.
+         */
+        struct ThreadState
+        {
+            Participant *participant = nullptr;
+            unsigned int depth = 0;
+
+            ~ThreadState();
+        };
+
+        EpochReclaimer() = default;
+
+        /**
+         * @brief Destroys every object still waiting; the process is exiting, so no reader remains.
+         */
+        ~EpochReclaimer();
+
+        /**
+         * @brief Returns the calling thread's reader state.
+         */
+        static ThreadState &threadState();
+
+        /**
+         * @brief Claims a free participant record, adding one if every record is in use.
+         */
+        Participant *claimParticipant();
+
+        /**
+         * @brief Publishes the current epoch for the calling thread, unless it is already pinned.
+         */
+        void enter();
+
+        /**
+         * @brief Clears the calling thread's published epoch once its outermost guard ends.
+         */
+        void leave();
+
+        /**
+         * @brief Advances the global epoch if every pinned reader has seen the current one. retiredMutex must be held.
+         */
+        void tryAdvance();
+
+        /**
+         * @brief The global epoch. Starts at 1 so that 0 can mean "not pinned".
+         */
+        std::atomic<uint64_t> globalEpoch{1};
+
+        /**
+         * @brief Head of the list of participant records.
+         */
+        std::atomic<Participant *> participants{nullptr};
+
+        /**
+         * @brief Guards retired.
+         */
+        mutable std::mutex retiredMutex;
+
+        /**
+         * @brief Objects waiting for destruction, in the order they were retired, so their epochs never decrease.
+         */
+        std::vector<Retired> retired;
+    };
+
+} // namespace cse4733
+
+#endif // EPOCHRECLAIMER_HPP
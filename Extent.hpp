@@ -0,0 +1,24 @@
+#ifndef EXTENT_HPP
+#define EXTENT_HPP
+
+#include <cstdint>
+
+namespace cse4733
+{
+
+    /**
+     * @struct Extent
+     * @brief A contiguous run of blocks, described by its first block and its length in blocks.
+     */
+    struct Extent
+    {
+        /* Index of the first block in the run. */
+        uint32_t start;
+
+        /* Number of blocks in the run. */
+        uint32_t length;
+    };
+
+} // namespace cse4733
+
+#endif // EXTENT_HPP
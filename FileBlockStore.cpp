@@ -0,0 +1,129 @@
+#include "FileBlockStore.hpp"
+#include "BlockStoreException.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cse4733
+{
+
+#ifndef _WIN32
+
+    FileBlockStore::FileBlockStore(const std::string &path, size_t blockCount, size_t blockSize)
+        : path(path), fd(-1), blockCount(blockCount), blockSize(blockSize)
+    {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            throw BlockStoreException(path, std::strerror(errno));
+        }
+        if (::ftruncate(fd, static_cast<off_t>(blockCount * blockSize)) != 0)
+        {
+            int error = errno;
+            ::close(fd);
+            throw BlockStoreException(path, std::strerror(error));
+        }
+    }
+
+    FileBlockStore::~FileBlockStore()
+    {
+        ::close(fd);
+    }
+
+    void FileBlockStore::read(uint32_t start, uint32_t count, char *out)
+    {
+        // Short reads are retried until the range is complete; reading past the end cannot happen
+        size_t size = static_cast<size_t>(count) * blockSize;
+        off_t offset = static_cast<off_t>(start) * static_cast<off_t>(blockSize);
+        size_t done = 0;
+        while (done < size)
+        {
+            ssize_t result = ::pread(fd, out + done, size - done, offset + static_cast<off_t>(done));
+            if (result < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (result <= 0)
+            {
+                throw BlockStoreException(path, result < 0 ? std::strerror(errno) : "unexpected end of file");
+            }
+            done += static_cast<size_t>(result);
+        }
+    }
+
+    void FileBlockStore::write(uint32_t start, uint32_t count, const char *data)
+    {
+        size_t size = static_cast<size_t>(count) * blockSize;
+        off_t offset = static_cast<off_t>(start) * static_cast<off_t>(blockSize);
+        size_t done = 0;
+        while (done < size)
+        {
+            ssize_t result = ::pwrite(fd, data + done, size - done, offset + static_cast<off_t>(done));
+            if (result < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (result < 0)
+            {
+                throw BlockStoreException(path, std::strerror(errno));
+            }
+            done += static_cast<size_t>(result);
+        }
+    }
+
+    void FileBlockStore::sync()
+    {
+        if (::fsync(fd) != 0)
+        {
+            throw BlockStoreException(path, std::strerror(errno));
+        }
+    }
+
+#else
+
+    FileBlockStore::FileBlockStore(const std::string &path, size_t blockCount, size_t blockSize)
+        : path(path), fd(-1), blockCount(blockCount), blockSize(blockSize)
+    {
+        throw BlockStoreException(path, "file-backed block stores are not supported on this platform");
+    }
+
+    FileBlockStore::~FileBlockStore()
+    {
+    }
+
+    void FileBlockStore::read(uint32_t, uint32_t, char *)
+    {
+    }
+
+    void FileBlockStore::write(uint32_t, uint32_t, const char *)
+    {
+    }
+
+    void FileBlockStore::sync()
+    {
+    }
+
+#endif
+
+    size_t FileBlockStore::getBlockSize() const
+    {
+        return blockSize;
+    }
+
+    size_t FileBlockStore::getBlockCount() const
+    {
+        return blockCount;
+    }
+
+    const std::string &FileBlockStore::getPath() const
+    {
+        return path;
+    }
+
+} // namespace cse4733
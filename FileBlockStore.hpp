@@ -0,0 +1,87 @@
+#ifndef FILEBLOCKSTORE_HPP
+#define FILEBLOCKSTORE_HPP
+
+#include <string>
+
+#include "BlockStore.hpp"
+
+namespace cse4733
+{
+
+    /**
+     * @class FileBlockStore
+     * @brief A BlockStore kept in a file and accessed with pread and pwrite.
+     *
+     * The file is created, or truncated, when the store is opened and sized to hold
+     * every block; it stays sparse until blocks are written. Its contents are scratch
+     * space for one BlockManager and are not meant to be reopened.
+     */
+    class FileBlockStore : public BlockStore
+    {
+    public:
+        /**
+         * @brief Creates the backing file.
+         *
+         * @param path The path of the file; an existing file is overwritten.
+         * @param blockCount The number of blocks.
+         * @param blockSize The size of each block in bytes.
+         * @throw BlockStoreException if the file cannot be created or sized.
+         */
+        FileBlockStore(const std::string &path, size_t blockCount, size_t blockSize);
+
+        /**
+         * @brief Closes the file, leaving it in place.
+         */
+        ~FileBlockStore() override;
+
+        FileBlockStore(const FileBlockStore &) = delete;
+        FileBlockStore &operator=(const FileBlockStore &) = delete;
+
+        /**
+         * @throw BlockStoreException if the file cannot be read.
+         */
+        void read(uint32_t start, uint32_t count, char *out) override;
+
+        /**
+         * @throw BlockStoreException if the file cannot be written.
+         */
+        void write(uint32_t start, uint32_t count, const char *data) override;
+
+        /**
+         * @throw BlockStoreException if the file cannot be flushed.
+         */
+        void sync() override;
+
+        size_t getBlockSize() const override;
+        size_t getBlockCount() const override;
+
+        /**
+         * @brief Returns the path of the backing file.
+         */
+        const std::string &getPath() const;
+
+    private:
+        /**
+         * @brief The path of the backing file.
+         */
+        std::string path;
+
+        /**
+         * @brief The open file descriptor.
+         */
+        int fd;
+
+        /**
+         * @brief The number of blocks.
+         */
+        size_t blockCount;
+
+        /**
+         * @brief The size of each block in bytes.
+         */
+        size_t blockSize;
+    };
+
+} // namespace cse4733
+
+#endif // FILEBLOCKSTORE_HPP
@@ -1,98 +1,289 @@
 #include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
 #include <iostream> // For error messages (optional)
+#include <mutex>
 
 #include "FileSystem.hpp"
+#include "CorruptDataException.hpp"
+#include "DirectoryNotEmptyException.hpp"
 #include "FileAlreadyExistsException.hpp"
 #include "FileMissingException.hpp"
+#include "IsADirectoryException.hpp"
+#include "NotADirectoryException.hpp"
 #include "NoAvailableInodeException.hpp"
 #include "UnformattedFilesystemException.hpp"
 #include "NoFreeBlockAvailableException.hpp"
+#include "SnapshotMissingException.hpp"
+#include "JournalException.hpp"
 
 namespace cse4733
 {
 
-    FileSystem::FileSystem(size_t diskSize, size_t blockSize)
-        : diskSize(diskSize), blockSize(blockSize),
-          blockManager(diskSize / blockSize), inodeTable(diskSize / (blockSize * 10))
+    FileSystem::FileSystem(size_t diskSize, size_t blockSize, AllocationPolicy policy)
+        : diskSize(diskSize), blockSize(blockSize), allocationPolicy(policy),
+          blockManager(diskSize / blockSize, blockSize, policy), inodeTable(diskSize / (blockSize * 10))
     {
         // Initialize the filesystem with a root directory and empty inode table.
+        registerCodec(std::make_shared<LzCodec>());
     }
 
     FileSystem::~FileSystem()
     {
-        // Destructor - no special cleanup needed for this in-memory filesystem
+        // Finish queued async operations, then persist a mounted image; the in-memory filesystem needs no cleanup
+        asyncPool.reset();
+        try
+        {
+            unmount();
+        }
+        catch(const std::exception &e)
+        {
+            std::cerr << "Failed to sync disk image: " << e.what() << "\n";
+        }
+    }
+
+    FileSystem::VolumeGuard::VolumeGuard(const FileSystem &fileSystem, bool exclusive)
+        : fileSystem(fileSystem), mode(Mode::None)
+    {
+        // Only this thread can have stored its own id, so a relaxed load is enough to detect nesting
+        if (fileSystem.volumeOwner.load(std::memory_order_relaxed) == std::this_thread::get_id()) {
+            return;
+        }
+        if (exclusive) {
+            fileSystem.volumeLock.lock();
+            fileSystem.volumeOwner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+            mode = Mode::Exclusive;
+        } else {
+            fileSystem.volumeLock.lock_shared();
+            mode = Mode::Shared;
+        }
+    }
+
+    FileSystem::VolumeGuard::~VolumeGuard()
+    {
+        if (mode == Mode::Exclusive) {
+            fileSystem.volumeOwner.store(std::thread::id(), std::memory_order_relaxed);
+            fileSystem.volumeLock.unlock();
+        } else if (mode == Mode::Shared) {
+            fileSystem.volumeLock.unlock_shared();
+        }
     }
 
     bool FileSystem::createFile(const std::string &filename)
     {
-        if (!isFormatted) {
-            throw UnformattedFilesystemException();
+        ErrorCode error = tryCreateFile(filename);
+        if (error != ErrorCode::Ok && error != ErrorCode::NoInode) {
+            throwError(error, filename);
         }
+        return error == ErrorCode::Ok;
+    }
 
-        try 
-        {
-            int inodeIndex = allocateInode();
-            rootDirectory.addFile(filename, inodeIndex);
-            return true;
+    ErrorCode FileSystem::tryCreateFile(const std::string &filename)
+    {
+        VolumeGuard guard(*this, false);
+        if (!isFormatted) {
+            return ErrorCode::Unformatted;
         }
-        catch(const cse4733::NoAvailableInodeException &e) 
-        {
-            return false;
+
+        unsigned int parentInode;
+        std::unique_lock<std::shared_mutex> parentLock;
+        Result<unsigned int> inodeIndex = tryAddEntry(filename, 0, parentInode, parentLock);
+        if (inodeIndex) {
+            logRecord(Journal::RecordType::CreateFile, filename);
         }
+        return inodeIndex.error();
     }
 
     bool FileSystem::deleteFile(const std::string &filename)
     {
+        ErrorCode error = tryDeleteFile(filename);
+        if (error != ErrorCode::Ok && error != ErrorCode::NotFound) {
+            throwError(error, filename);
+        }
+        return error == ErrorCode::Ok;
+    }
+
+    ErrorCode FileSystem::tryDeleteFile(const std::string &filename)
+    {
+        VolumeGuard guard(*this, false);
         if (!isFormatted) {
-            throw UnformattedFilesystemException();
+            return ErrorCode::Unformatted;
         }
 
-        try 
-        {
-            int inodeIndex = findInode(filename);
-            Inode &inode = inodeTable[inodeIndex];
-            for (auto i: inode.directBlocks) {
-                blockManager.freeBlock(i);
-            }
-            releaseInode(inodeIndex);
-            rootDirectory.removeFile(filename);
-            return true;
+        std::string name;
+        const Directory *parent;
+        Result<unsigned int> parentInode = tryResolveParent(filename, name, parent);
+        if (!parentInode) {
+            return parentInode.error();
         }
-        catch(const cse4733::FileMissingException &e)
-        {
-            return false;
+        return tryUnlinkFile(parentInode.value(), parent, name, filename);
+    }
+
+    ErrorCode FileSystem::tryUnlinkFile(unsigned int parentInode, const Directory *resolved, const std::string &name,
+                                        const std::string &path)
+    {
+        // 1. Lock the parent against creators and other deletes, make sure it is still the directory that
+        //    was resolved, then lock the file against its readers and writers
+        // 2. Remove the entry before freeing the inode, so a thread that locks the inode next finds it unnamed
+        //    and never touches it after it is reused
+        std::unique_lock<std::shared_mutex> parentLock(directoryLocks.forIndex(parentInode));
+        Directory *parent = findDirectory(parentInode);
+        if (parent == nullptr || parent != resolved) {
+            return ErrorCode::NotFound;
         }
+        Result<unsigned int> inodeIndex = parent->tryGetInodeIndex(name);
+        if (!inodeIndex) {
+            return inodeIndex.error();
+        }
+        std::unique_lock<std::shared_mutex> lock(inodeLocks.forIndex(inodeIndex.value()));
+        Inode &inode = inodeTable[inodeIndex.value()];
+        if (inode.isDirectory()) {
+            return ErrorCode::IsADirectory;
+        }
+
+        parent->removeFile(name);
+        dentryCache.invalidate(parentInode, name);
+        markDirty(parentInode);
+        forgetDecompressed(inode);
+        releaseExtents(inode);
+        releaseInode(inodeIndex.value());
+        logRecord(Journal::RecordType::DeleteFile, path);
+        return ErrorCode::Ok;
     }
 
     bool FileSystem::writeFile(const std::string &filename, const std::string &data)
     {
+        ErrorCode error = tryWriteFile(filename, data);
+        if (error != ErrorCode::Ok && error != ErrorCode::NoSpace) {
+            throwError(error, filename);
+        }
+        return error == ErrorCode::Ok;
+    }
 
+    ErrorCode FileSystem::tryWriteFile(const std::string &filename, const std::string &data)
+    {
+        VolumeGuard guard(*this, false);
         if (!isFormatted) {
-            throw UnformattedFilesystemException();
+            return ErrorCode::Unformatted;
+        }
+
+        std::unique_lock<std::shared_mutex> lock;
+        Result<unsigned int> inodeIndex = tryLockPath(filename, lock);
+        if (!inodeIndex) {
+            return inodeIndex.error();
+        }
+        Inode &inode = inodeTable[inodeIndex.value()];
+        if (inode.isDirectory()) {
+            return ErrorCode::IsADirectory;
+        }
+        return writeWhole(inode, filename, data, nullptr) ? ErrorCode::Ok : ErrorCode::NoSpace;
+    }
+
+    bool FileSystem::writeWhole(Inode &inode, const std::string &filename, const std::string &data,
+                                std::vector<Extent> *reservation)
+    {
+        forgetDecompressed(inode);
+        releaseExtents(inode);
+        inode.fileSize = 0;
+        inode.flags &= ~Inode::FLAG_COMPRESSED;
+        inode.modificationTime = std::time(nullptr);
+        if (fitsInline(data.size())) {
+            storeInline(inode, data);
+            logRecord(Journal::RecordType::WriteFile, filename, 0, data);
+            return true;
+        }
+
+        // A failed write leaves the file empty, which is logged as writing no data
+        std::string encoded = encodeData(inode, data);
+        const std::string &bytes = encoded.empty() ? data : encoded;
+        std::vector<Extent> extents = writeDataToBlocks(bytes, reservation);
+        if (extents.empty() && !bytes.empty()) {
+            logRecord(Journal::RecordType::WriteFile, filename);
+            return false;
         }
 
-        int inodeIndex = findInode(filename);
-        Inode &inode = inodeTable[inodeIndex];
-        for (auto i: inode.directBlocks) {
-            blockManager.freeBlock(i);
+        bool stored = false;
+        try
+        {
+            stored = storeExtents(inode, extents);
+        }
+        catch(const cse4733::NoFreeBlockAvailableException &e)
+        {
+            stored = false;
+        }
+        if (!stored) {
+            for (const Extent &extent: extents) {
+                blockManager.freeExtent(extent);
+            }
+            logRecord(Journal::RecordType::WriteFile, filename);
+            return false;
+        }
+        if (!encoded.empty()) {
+            inode.flags |= Inode::FLAG_COMPRESSED;
         }
-        std::vector<int> blockIndexes = writeDataToBlocks(data);
-        inode.allocate(data.size(), blockIndexes);
-        
+        inode.fileSize = data.size();
+        logRecord(Journal::RecordType::WriteFile, filename, 0, data);
+        scheduleWriteBehind();
         return true;
     }
 
     std::string FileSystem::readFile(const std::string &filename)
     {
+        Result<std::string> data = tryReadFile(filename);
+        if (!data && data.error() != ErrorCode::NotFound) {
+            throwError(data.error(), filename);
+        }
+        return std::move(data).value();
+    }
+
+    Result<std::string> FileSystem::tryReadFile(const std::string &filename)
+    {
+        VolumeGuard guard(*this, false);
+        if (!isFormatted) {
+            return ErrorCode::Unformatted;
+        }
+
+        std::shared_lock<std::shared_mutex> lock;
+        Result<unsigned int> inodeIndex = tryLockPath(filename, lock);
+        if (!inodeIndex) {
+            return inodeIndex.error();
+        }
+        const Inode &inode = inodeTable[inodeIndex.value()];
+        if (inode.isDirectory()) {
+            return ErrorCode::IsADirectory;
+        }
+        return readDataFromBlocks(inode);
+    }
+
+    std::string FileSystem::readFile(const std::string &filename, size_t offset, size_t length)
+    {
+        VolumeGuard guard(*this, false);
         if (!isFormatted) {
             throw UnformattedFilesystemException();
         }
 
         try
         {
-            int inodeIndex = findInode(filename);
-            Inode &inode = inodeTable[inodeIndex];
-            std::string data = readDataFromBlocks(inode.directBlocks);
+            std::shared_lock<std::shared_mutex> lock;
+            Inode &inode = lockFile(filename, lock);
+            if (offset >= inode.fileSize) {
+                return {};
+            }
+            length = std::min<size_t>(length, inode.fileSize - offset);
+            std::string data(length, '\0');
+            copyRange(inode, offset, length, data.data());
+
+            // A read continuing the file's previous one prefetches what a streaming reader wants next
+            size_t window = readaheadWindow();
+            if (window > 0 && !(inode.flags & (Inode::FLAG_COMPRESSED | Inode::FLAG_INLINE))) {
+                std::pair<size_t, size_t> ahead = readahead.recordRead(
+                    &inode, offset, length, std::min(MIN_READAHEAD_BLOCKS * blockSize, window), window);
+                ahead.second = std::min<size_t>(ahead.second, inode.fileSize);
+                if (ahead.first < ahead.second) {
+                    schedulePrefetch(loadExtents(inode), 0, 0, ahead.first, ahead.second - ahead.first);
+                }
+            }
             return data;
         }
         catch(const cse4733::FileMissingException &e)
@@ -101,104 +292,2476 @@ namespace cse4733
         }
     }
 
-    std::vector<std::string> FileSystem::listFiles()
+    bool FileSystem::writeFile(const std::string &filename, size_t offset, const std::string &data)
     {
-        if (!isFormatted)
-        {
-            throw UnformattedFilesystemException(); // Return empty if the filesystem has not been formatted
+        VolumeGuard guard(*this, false);
+        if (!isFormatted) {
+            throw UnformattedFilesystemException();
         }
 
-        return rootDirectory.listFiles();
+        std::unique_lock<std::shared_mutex> lock;
+        return writeAt(lockFile(filename, lock), filename, offset, data);
     }
 
-    bool FileSystem::format()
-    {   
-        for (auto inode: inodeTable) {
-            inode.deallocate();
+    bool FileSystem::writeAt(Inode &inode, const std::string &filename, size_t offset, const std::string &data)
+    {
+        // 1. Copy any shared blocks the write touches, including a zero-filled gap
+        // 2. Make sure the file's blocks cover the end of the write
+        // 3. Zero-fill any gap between the old end of file and the offset
+        // 4. Copy the data into the blocks covering the range
+        size_t end = offset + data.size();
+        if (rewritesWhole(inode, std::max<size_t>(end, inode.fileSize))) {
+            // Compressed and inline files are rewritten as a whole
+            std::string contents = readDataFromBlocks(inode);
+            contents.resize(std::max(contents.size(), end), '\0');
+            contents.replace(offset, data.size(), data);
+            if (!replaceFileData(inode, contents)) {
+                return false;
+            }
+            logRecord(Journal::RecordType::WriteAt, filename, offset, data);
+            return true;
         }
 
-        rootDirectory = Directory();
-        blockManager = BlockManager(diskSize / blockSize );
-        isFormatted = true;
+        // Copies readSegments made of a file that cannot be viewed in place go stale now
+        if (!blockManager.isMemoryResident()) {
+            forgetDecompressed(inode);
+        }
+        std::vector<Extent> extents = loadExtents(inode);
+        size_t from = std::min<size_t>(offset, inode.fileSize);
+        if (!unshareRange(inode, extents, from, end - from)) {
+            return false;
+        }
+        if (end > inode.fileSize) {
+            if (!resizeExtents(inode, extents, end)) {
+                return false;
+            }
+            if (offset > inode.fileSize) {
+                std::string zeros(offset - inode.fileSize, '\0');
+                writeRange(extents, inode.fileSize, zeros.data(), zeros.size());
+            }
+            inode.fileSize = end;
+        }
+        writeRange(extents, offset, data.data(), data.size());
+        inode.modificationTime = std::time(nullptr);
+        logRecord(Journal::RecordType::WriteAt, filename, offset, data);
+        scheduleWriteBehind();
         return true;
-        
-    
     }
 
-    int FileSystem::findInode(const std::string &filename)
+    bool FileSystem::appendFile(const std::string &filename, const std::string &data)
     {
-        if (!isFormatted)
-        {
-            throw UnformattedFilesystemException(); // Filesystem has not been formatted
+        VolumeGuard guard(*this, false);
+        if (!isFormatted) {
+            throw UnformattedFilesystemException();
         }
-        return rootDirectory.getInodeIndex(filename);
+
+        // The size is read under the same lock as the write, so concurrent appends never overlap
+        std::unique_lock<std::shared_mutex> lock;
+        Inode &inode = lockFile(filename, lock);
+        return writeAt(inode, filename, inode.fileSize, data);
     }
 
-    unsigned int FileSystem::allocateInode()
-    {   
+    bool FileSystem::truncateFile(const std::string &filename, size_t size)
+    {
+        VolumeGuard guard(*this, false);
         if (!isFormatted) {
             throw UnformattedFilesystemException();
         }
 
-        auto it = std::find_if(inodeTable.begin(), inodeTable.end(), [](const Inode &inode) { return !inode.isAllocated; });
-        if (it != inodeTable.end()) {
-            it->allocate(0, {});
-            return std::distance(inodeTable.begin(), it);
-        } else {
-            throw NoAvailableInodeException();
+        std::unique_lock<std::shared_mutex> lock;
+        Inode &inode = lockFile(filename, lock);
+        if (rewritesWhole(inode, size)) {
+            std::string contents = readDataFromBlocks(inode);
+            contents.resize(size, '\0');
+            if (!replaceFileData(inode, contents)) {
+                return false;
+            }
+            logRecord(Journal::RecordType::Truncate, filename, size);
+            return true;
+        }
+
+        if (!blockManager.isMemoryResident()) {
+            forgetDecompressed(inode);
+        }
+        std::vector<Extent> extents = loadExtents(inode);
+        if (size > inode.fileSize && !unshareRange(inode, extents, inode.fileSize, size - inode.fileSize)) {
+            return false;
+        }
+        if (!resizeExtents(inode, extents, size)) {
+            return false;
         }
+        if (size > inode.fileSize) {
+            std::string zeros(size - inode.fileSize, '\0');
+            writeRange(extents, inode.fileSize, zeros.data(), zeros.size());
+        }
+        inode.fileSize = size;
+        inode.modificationTime = std::time(nullptr);
+        logRecord(Journal::RecordType::Truncate, filename, size);
+        return true;
     }
 
-    void FileSystem::releaseInode(int inodeIndex)
+    std::vector<std::string_view> FileSystem::readSegments(const std::string &filename)
     {
-        if (inodeIndex >= 0 && static_cast<size_t>(inodeIndex) < inodeTable.size())
-        {
-            inodeTable[inodeIndex].deallocate();
+        VolumeGuard guard(*this, false);
+        if (!isFormatted) {
+            throw UnformattedFilesystemException();
+        }
+
+        // Compressed files, and any file whose blocks cannot be viewed in place, are read once
+        // and served from memory until they change; concurrent readers may both read, and the
+        // first to finish fills the cache
+        std::shared_lock<std::shared_mutex> lock;
+        Inode &inode = lockFile(filename, lock);
+        if (!inode.isInline() && ((inode.flags & Inode::FLAG_COMPRESSED) || !blockManager.isMemoryResident())) {
+            std::unique_lock<std::mutex> cacheLock(decompressedMutex);
+            auto it = decompressedFiles.find(&inode);
+            if (it == decompressedFiles.end()) {
+                cacheLock.unlock();
+                std::string contents = readDataFromBlocks(inode);
+                cacheLock.lock();
+                it = decompressedFiles.emplace(&inode, std::move(contents)).first;
+            }
+            if (it->second.empty()) {
+                return {};
+            }
+            return {std::string_view(it->second)};
         }
+        return segmentsFor(inode);
     }
 
-    std::vector<int> FileSystem::writeDataToBlocks(const std::string &data)
+    size_t FileSystem::readInto(const std::string &filename, char *buffer, size_t capacity)
     {
-        std::vector<int> blockIndexes;
-        size_t blocksNeeded = (data.size() + blockSize - 1) / blockSize;
-        for (size_t i = 0; i < blocksNeeded; i++) {
+        VolumeGuard guard(*this, false);
+        if (!isFormatted) {
+            throw UnformattedFilesystemException();
+        }
+
+        std::shared_lock<std::shared_mutex> lock;
+        Inode &inode = lockFile(filename, lock);
+        if (inode.flags & Inode::FLAG_COMPRESSED) {
+            std::string data = readDataFromBlocks(inode);
+            size_t length = std::min(data.size(), capacity);
+            std::memcpy(buffer, data.data(), length);
+            return length;
+        }
+        if (inode.isInline()) {
+            size_t length = std::min<size_t>(capacity, inode.fileSize);
+            std::memcpy(buffer, inode.inlineData(), length);
+            return length;
+        }
+
+        return copyExtents(loadExtents(inode), 0, std::min<size_t>(capacity, inode.fileSize), buffer);
+    }
+
+    namespace
+    {
+        // State shared by the tasks of one split readAsync; the last task to finish fulfils the promise
+        struct SplitRead
+        {
+            std::promise<std::string> result;
+            std::string data;
+            std::atomic<size_t> remaining{0};
+            std::mutex mutex;
+            size_t end = 0;
+            std::exception_ptr error;
+        };
+    } // namespace
+
+    std::future<std::string> FileSystem::readAsync(const std::string &filename)
+    {
+        // 1. A first task looks up the file's size; small and compressed files are read by it in one go
+        // 2. Otherwise it posts one task per ASYNC_CHUNK_BLOCKS blocks, each copying its range into place
+        // 3. The last range to finish trims the result if the file shrank meanwhile and completes the future
+        auto promise = std::make_shared<std::promise<std::string>>();
+        std::future<std::string> result = promise->get_future();
+        TaskExecutor &pool = asyncExecutor();
+        pool.post([this, &pool, promise, filename]() {
             try
             {
-                int blockIndex = blockManager.allocateBlock();
-                size_t offset = i * blockSize;
-                size_t length = std::min(blockSize, data.size() - offset);
-                blockManager.writeBlock(blockIndex, data.substr(offset, length));
-                blockIndexes.push_back(blockIndex);
+                size_t size = 0;
+                bool splittable = false;
+                size_t chunk = ASYNC_CHUNK_BLOCKS * blockSize;
+                if (!sizeForAsyncRead(filename, size, splittable)) {
+                    promise->set_value(std::string());
+                    return;
+                }
+                if (!splittable || size <= chunk) {
+                    promise->set_value(readFile(filename));
+                    return;
+                }
+
+                auto read = std::make_shared<SplitRead>();
+                read->result = std::move(*promise);
+                read->data.resize(size);
+                read->end = size;
+                read->remaining.store((size + chunk - 1) / chunk);
+                for (size_t offset = 0; offset < size; offset += chunk) {
+                    size_t length = std::min(chunk, size - offset);
+                    pool.post([this, read, filename, offset, length]() {
+                        try
+                        {
+                            size_t copied = readChunk(filename, offset, length, &read->data[offset]);
+                            if (copied < length) {
+                                std::lock_guard<std::mutex> lock(read->mutex);
+                                read->end = std::min(read->end, offset + copied);
+                            }
+                        }
+                        catch (...)
+                        {
+                            std::lock_guard<std::mutex> lock(read->mutex);
+                            if (!read->error) {
+                                read->error = std::current_exception();
+                            }
+                        }
+                        if (read->remaining.fetch_sub(1) == 1) {
+                            if (read->error) {
+                                read->result.set_exception(read->error);
+                            } else {
+                                read->data.resize(read->end);
+                                read->result.set_value(std::move(read->data));
+                            }
+                        }
+                    });
+                }
             }
-            catch(const cse4733::NoFreeBlockAvailableException& e)
+            catch (...)
             {
-                for (int index: blockIndexes) {
-                    blockManager.freeBlock(index);
+                promise->set_exception(std::current_exception());
+            }
+        });
+        return result;
+    }
+
+    std::future<bool> FileSystem::writeAsync(const std::string &filename, std::string data)
+    {
+        return asyncExecutor().submit([this, filename, data = std::move(data)]() {
+            return writeFile(filename, data);
+        });
+    }
+
+    std::future<bool> FileSystem::writeAsync(const std::string &filename, size_t offset, std::string data)
+    {
+        return asyncExecutor().submit([this, filename, offset, data = std::move(data)]() {
+            return writeFile(filename, offset, data);
+        });
+    }
+
+    size_t FileSystem::getAsyncThreadCount() const
+    {
+        return asyncPool ? asyncPool->getThreadCount() : 0;
+    }
+
+    TaskExecutor &FileSystem::asyncExecutor()
+    {
+        std::call_once(asyncPoolStarted, [this]() { asyncPool = std::make_unique<TaskExecutor>(); });
+        return *asyncPool;
+    }
+
+    bool FileSystem::sizeForAsyncRead(const std::string &filename, size_t &size, bool &splittable)
+    {
+        VolumeGuard guard(*this, false);
+        if (!isFormatted) {
+            throw UnformattedFilesystemException();
+        }
+
+        try
+        {
+            std::shared_lock<std::shared_mutex> lock;
+            const Inode &inode = lockFile(filename, lock);
+            size = inode.fileSize;
+            splittable = !(inode.flags & Inode::FLAG_COMPRESSED);
+            return true;
+        }
+        catch(const cse4733::FileMissingException &e)
+        {
+            return false;
+        }
+    }
+
+    size_t FileSystem::readChunk(const std::string &filename, size_t offset, size_t length, char *buffer)
+    {
+        VolumeGuard guard(*this, false);
+        if (!isFormatted) {
+            throw UnformattedFilesystemException();
+        }
+
+        std::shared_lock<std::shared_mutex> lock;
+        const Inode &inode = lockFile(filename, lock);
+        if (offset >= inode.fileSize) {
+            return 0;
+        }
+        length = std::min<size_t>(length, inode.fileSize - offset);
+        copyRange(inode, offset, length, buffer);
+        return length;
+    }
+
+    void FileSystem::copyRange(const Inode &inode, size_t offset, size_t length, char *buffer)
+    {
+        if (inode.flags & Inode::FLAG_COMPRESSED) {
+            std::memcpy(buffer, readDataFromBlocks(inode).data() + offset, length);
+            return;
+        }
+        if (inode.isInline()) {
+            std::memcpy(buffer, inode.inlineData() + offset, length);
+            return;
+        }
+        copyExtents(loadExtents(inode), offset, length, buffer);
+    }
+
+    std::vector<BatchResult> FileSystem::runBatch(const std::vector<BatchOperation> &operations)
+    {
+        // 1. Enter the volume once and check its format once
+        // 2. Reserve the blocks of every write with one allocation; if that fails, each write allocates its own
+        // 3. Run the operations in order, resolving each parent directory the first time it is named;
+        //    a parent another thread removes meanwhile is reported as missing by the operations that use it
+        // 4. Free whatever the writes left of the reservation, also if an operation throws
+        VolumeGuard guard(*this, false);
+        if (!isFormatted) {
+            throw UnformattedFilesystemException();
+        }
+
+        std::vector<Extent> reservation;
+        if (!deduplication) {
+            size_t blocksNeeded = 0;
+            for (const BatchOperation &operation: operations) {
+                if (operation.type == BatchOperationType::Write && !fitsInline(operation.data.size())) {
+                    blocksNeeded += (operation.data.size() + blockSize - 1) / blockSize;
                 }
-                return {};
+            }
+            Result<std::vector<Extent>> reserved = blockManager.tryAllocateExtents(blocksNeeded);
+            if (reserved) {
+                reservation = std::move(reserved).value();
+            }
+        }
+
+        std::unordered_map<std::string, std::pair<Result<unsigned int>, const Directory *>> parents;
+        std::vector<BatchResult> results;
+        results.reserve(operations.size());
+        try
+        {
+            for (const BatchOperation &operation: operations) {
+                std::string parentPath, name;
+                if (!splitPath(operation.path, parentPath, name)) {
+                    // No parent entry to act on, e.g. "/" or "a/.."; reads and writes resolve the whole
+                    // path like tryReadFile and tryWriteFile, creates and deletes fail like tryResolveParent
+                    bool access = operation.type == BatchOperationType::Read || operation.type == BatchOperationType::Write;
+                    results.push_back(access ? accessFile(operation, [&](unsigned int &parentInode, std::string &entry) {
+                                                   return tryResolveEntry(operation.path, parentInode, entry);
+                                               }, reservation)
+                                             : BatchResult{BatchStatus::IsADirectory, std::string()});
+                    continue;
+                }
+
+                auto parent = parents.find(parentPath);
+                if (parent == parents.end()) {
+                    const Directory *directory = nullptr;
+                    Result<unsigned int> resolved = tryResolveDirectory(parentPath.empty() ? "." : parentPath, directory);
+                    parent = parents.emplace(parentPath, std::make_pair(resolved, directory)).first;
+                }
+                if (!parent->second.first) {
+                    results.push_back(BatchResult{parent->second.first.error(), std::string()});
+                    continue;
+                }
+                results.push_back(runOperation(operation, parent->second.first.value(), parent->second.second, name,
+                                               reservation));
             }
         }
-        return blockIndexes;
+        catch(...)
+        {
+            for (const Extent &extent: reservation) {
+                blockManager.freeExtent(extent);
+            }
+            throw;
+        }
+
+        for (const Extent &extent: reservation) {
+            blockManager.freeExtent(extent);
+        }
+        return results;
     }
 
-    std::string FileSystem::readDataFromBlocks(const std::vector<int> &blockIndexes)
+    BatchResult FileSystem::runOperation(const BatchOperation &operation, unsigned int parentInode,
+                                         const Directory *parent, const std::string &name,
+                                         std::vector<Extent> &reservation)
     {
-        std::string data;
-        for (int i: blockIndexes) {
-            std::string blockData = blockManager.readBlock(i);
-            data += blockData;
+        // 1. Create under the parent's lock, exactly as createFile does
+        // 2. Delete under the parent's and the file's locks, exactly as deleteFile does
+        // 3. Otherwise find the file through the dentry cache or the parent and write or read it
+        //    under the same lock as the single calls
+        if (operation.type == BatchOperationType::Create) {
+            std::unique_lock<std::shared_mutex> parentLock;
+            Result<unsigned int> inodeIndex = tryLinkEntry(parentInode, parent, name, 0, parentLock);
+            if (inodeIndex) {
+                logRecord(Journal::RecordType::CreateFile, operation.path);
+            }
+            return BatchResult{inodeIndex.error(), std::string()};
         }
-        return data;
+        if (operation.type == BatchOperationType::Delete) {
+            return BatchResult{tryUnlinkFile(parentInode, parent, name, operation.path), std::string()};
+        }
+        return accessFile(operation, [&](unsigned int &entryParent, std::string &entryName) {
+            entryParent = parentInode;
+            entryName = name;
+            return tryLookup(parentInode, name);
+        }, reservation);
     }
 
-    size_t FileSystem::getFreeBlockCount() const
+    BatchResult FileSystem::accessFile(const BatchOperation &operation, const EntryResolver &resolve,
+                                       std::vector<Extent> &reservation)
     {
-        return blockManager.getFreeBlockCount(); // Retrieve the count of free blocks from BlockManager
+        if (operation.type == BatchOperationType::Write) {
+            std::unique_lock<std::shared_mutex> lock;
+            Result<unsigned int> inodeIndex = tryLockEntry(resolve, lock);
+            if (!inodeIndex) {
+                return BatchResult{inodeIndex.error(), std::string()};
+            }
+            Inode &inode = inodeTable[inodeIndex.value()];
+            if (inode.isDirectory()) {
+                return BatchResult{BatchStatus::IsADirectory, std::string()};
+            }
+            bool written = writeWhole(inode, operation.path, operation.data, &reservation);
+            return BatchResult{written ? BatchStatus::Ok : BatchStatus::NoSpace, std::string()};
+        }
+        std::shared_lock<std::shared_mutex> lock;
+        Result<unsigned int> inodeIndex = tryLockEntry(resolve, lock);
+        if (!inodeIndex) {
+            return BatchResult{inodeIndex.error(), std::string()};
+        }
+        const Inode &inode = inodeTable[inodeIndex.value()];
+        if (inode.isDirectory()) {
+            return BatchResult{BatchStatus::IsADirectory, std::string()};
+        }
+        try
+        {
+            return BatchResult{BatchStatus::Ok, readDataFromBlocks(inode)};
+        }
+        catch(const cse4733::CorruptDataException &e)
+        {
+            return BatchResult{BatchStatus::CorruptData, std::string()};
+        }
     }
 
-    size_t FileSystem::getTotalBlockCount() const
+    bool FileSystem::cloneFile(const std::string &source, const std::string &destination)
     {
-        return blockManager.getTotalBlocks(); // Retrieve the total count of blocks from BlockManager
+        VolumeGuard guard(*this, false);
+        if (!isFormatted) {
+            throw UnformattedFilesystemException();
+        }
+
+        // 1. Lock the destination's directory before the source's inode, following the lock order
+        // 2. Take a reference to every extent of the source, holding it still until the clone is journaled
+        // 3. Create the destination with the same extents in its inode, or a copy of the inline data,
+        //    filled in before it is linked so no other thread sees it half set up
+        // 4. Drop the references if the destination cannot be created or its pointer blocks allocated
+        std::string name;
+        const Directory *parent;
+        unsigned int parentInode = resolveParent(destination, name, parent);
+        std::unique_lock<std::shared_mutex> parentLock(directoryLocks.forIndex(parentInode));
+
+        std::shared_lock<std::shared_mutex> sourceLock;
+        const Inode &sourceInode = lockFile(source, sourceLock);
+        std::vector<Extent> extents = loadExtents(sourceInode);
+        uint64_t fileSize = sourceInode.fileSize;
+        uint32_t sourceFlags = sourceInode.flags;
+        for (const Extent &extent: extents) {
+            blockManager.shareExtent(extent);
+        }
+        auto dropReferences = [&]() {
+            for (const Extent &extent: extents) {
+                blockManager.freeExtent(extent);
+            }
+        };
+
+        Result<unsigned int> created = tryLinkEntry(parentInode, parent, name, 0, parentLock, [&](Inode &inode) {
+            bool stored = false;
+            try
+            {
+                stored = storeExtents(inode, extents);
+            }
+            catch(const cse4733::NoFreeBlockAvailableException &e)
+            {
+                stored = false;
+            }
+            if (!stored) {
+                return false;
+            }
+            if (sourceInode.isInline()) {
+                std::memcpy(inode.inlineData(), sourceInode.inlineData(), Inode::MAX_INLINE_SIZE);
+            }
+            inode.flags |= sourceFlags & (Inode::FLAG_COMPRESSED | Inode::FLAG_COMPRESS | Inode::FLAG_NO_COMPRESS | Inode::FLAG_INLINE);
+            inode.fileSize = fileSize;
+            return true;
+        });
+        if (!created) {
+            dropReferences();
+            if (created.error() == ErrorCode::NoInode || created.error() == ErrorCode::NoSpace) {
+                return false;
+            }
+            throwError(created.error(), destination);
+        }
+        logRecord(Journal::RecordType::CloneFile, destination, 0, normalizePath(source));
+        return true;
+    }
+
+    unsigned int FileSystem::snapshot()
+    {
+        VolumeGuard guard(*this, false);
+        if (!isFormatted) {
+            throw UnformattedFilesystemException();
+        }
+
+        // 1. Walk the tree from the root, copying each directory's entries under its lock, so none
+        //    is added or removed while it is copied; a directory removed before the walk reaches it,
+        //    even if its inode was reused, was empty by then and is recorded empty
+        // 2. Record each regular file's size and extents under its inode lock and take a reference
+        //    to its blocks, or copy its data if it is inline
+        // 3. Each directory and each file is recorded as it was at one moment, but other threads may
+        //    change the tree between those moments
+        struct Pending
+        {
+            unsigned int inodeIndex;
+            unsigned int parentInode;
+            const Directory *directory;
+        };
+        Snapshot view(ROOT_INODE);
+        std::vector<Pending> pending{{ROOT_INODE, ROOT_INODE, findDirectory(ROOT_INODE)}};
+        while (!pending.empty()) {
+            unsigned int directoryInode = pending.back().inodeIndex;
+            unsigned int parentInode = pending.back().parentInode;
+            const Directory *expected = pending.back().directory;
+            pending.pop_back();
+            std::shared_lock<std::shared_mutex> directoryLock(directoryLocks.forIndex(directoryInode));
+            const Directory *directory = findDirectory(directoryInode);
+            if (directory == nullptr || directory != expected) {
+                view.addDirectory(directoryInode, Directory(parentInode));
+                continue;
+            }
+            view.addDirectory(directoryInode, *directory);
+            for (const std::string &name: directory->listFiles()) {
+                unsigned int inodeIndex = directory->getInodeIndex(name);
+                std::shared_lock<std::shared_mutex> lock(inodeLocks.forIndex(inodeIndex));
+                const Inode &inode = inodeTable[inodeIndex];
+                if (inode.isDirectory()) {
+                    pending.push_back(Pending{inodeIndex, directoryInode, findDirectory(inodeIndex)});
+                } else {
+                    Snapshot::File file{inode.fileSize, (inode.flags & Inode::FLAG_COMPRESSED) != 0, loadExtents(inode),
+                                        inode.isInline() ? std::string(inode.inlineData(), inode.fileSize) : std::string()};
+                    for (const Extent &extent: file.extents) {
+                        blockManager.shareExtent(extent);
+                    }
+                    view.addFile(inodeIndex, std::move(file));
+                }
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(snapshotsLock);
+        unsigned int snapshotId = nextSnapshotId++;
+        snapshots.emplace(snapshotId, std::move(view));
+        return snapshotId;
+    }
+
+    std::string FileSystem::readSnapshotFile(unsigned int snapshotId, const std::string &filename)
+    {
+        VolumeGuard guard(*this, false);
+        std::shared_lock<std::shared_mutex> lock(snapshotsLock);
+        const Snapshot &view = snapshotFor(snapshotId);
+        std::string path = normalizePath(filename);
+        const Snapshot::File &file = view.file(view.resolve(path), path);
+
+        if (file.compressed) {
+            return decodeData(file.extents, file.size);
+        }
+        if (!file.contents.empty()) {
+            return file.contents;
+        }
+        std::string data(file.size, '\0');
+        data.resize(copyExtents(file.extents, 0, file.size, data.data()));
+        return data;
+    }
+
+    std::vector<std::string> FileSystem::listSnapshotFiles(unsigned int snapshotId, const std::string &path)
+    {
+        VolumeGuard guard(*this, false);
+        std::shared_lock<std::shared_mutex> lock(snapshotsLock);
+        const Snapshot &view = snapshotFor(snapshotId);
+        std::string absolute = normalizePath(path);
+        return view.directory(view.resolve(absolute), absolute).listFiles();
+    }
+
+    bool FileSystem::deleteSnapshot(unsigned int snapshotId)
+    {
+        VolumeGuard guard(*this, false);
+        // Drop the snapshot's reference to every block it recorded; blocks no file still uses are freed
+        std::unique_lock<std::shared_mutex> lock(snapshotsLock);
+        auto it = snapshots.find(snapshotId);
+        if (it == snapshots.end()) {
+            return false;
+        }
+        for (const auto &entry: it->second.getFiles()) {
+            for (const Extent &extent: entry.second.extents) {
+                blockManager.freeExtent(extent);
+            }
+        }
+        snapshots.erase(it);
+        return true;
+    }
+
+    std::vector<unsigned int> FileSystem::listSnapshots() const
+    {
+        VolumeGuard guard(*this, false);
+        std::shared_lock<std::shared_mutex> lock(snapshotsLock);
+        std::vector<unsigned int> ids;
+        ids.reserve(snapshots.size());
+        for (const auto &entry: snapshots) {
+            ids.push_back(entry.first);
+        }
+        return ids;
+    }
+
+    std::vector<std::string> FileSystem::listFiles()
+    {
+        // The path overload checks the format and takes the locks
+        return listFiles(".");
+    }
+
+    std::vector<std::string> FileSystem::listFiles(const std::string &path)
+    {
+        VolumeGuard guard(*this, false);
+        if (!isFormatted)
+        {
+            throw UnformattedFilesystemException();
+        }
+
+        std::shared_lock<std::shared_mutex> lock;
+        unsigned int inodeIndex;
+        return lockDirectory(path, lock, inodeIndex).listFiles();
+    }
+
+    std::vector<std::string> FileSystem::listFiles(const std::string &path, const std::string &cursor, size_t limit, const std::string &prefix)
+    {
+        VolumeGuard guard(*this, false);
+        if (!isFormatted)
+        {
+            throw UnformattedFilesystemException();
+        }
+
+        std::shared_lock<std::shared_mutex> lock;
+        unsigned int inodeIndex;
+        return lockDirectory(path, lock, inodeIndex).listFiles(cursor, limit, prefix);
+    }
+
+    bool FileSystem::makeDirectory(const std::string &path)
+    {
+        VolumeGuard guard(*this, false);
+        if (!isFormatted) {
+            throw UnformattedFilesystemException();
+        }
+
+        try
+        {
+            unsigned int parentInode;
+            std::unique_lock<std::shared_mutex> parentLock;
+            unsigned int inodeIndex = addEntry(path, Inode::FLAG_DIRECTORY, parentInode, parentLock);
+            markDirty(inodeIndex);
+            logRecord(Journal::RecordType::MakeDirectory, path);
+            return true;
+        }
+        catch(const cse4733::NoAvailableInodeException &e)
+        {
+            return false;
+        }
+    }
+
+    bool FileSystem::removeDirectory(const std::string &path)
+    {
+        VolumeGuard guard(*this, false);
+        if (!isFormatted) {
+            throw UnformattedFilesystemException();
+        }
+
+        try
+        {
+            // 1. Lock the parent against other creators and deletes and the directory against creators and cd,
+            //    taking the two stripes in address order so two removals never wait for each other
+            // 2. Check under both locks that the entry still names the directory, which is empty and not current
+            // 3. Unlink the entry and leave a null Directory behind, retiring the old one for threads that still
+            //    hold it, before the inode is freed
+            std::string name;
+            const Directory *resolved;
+            unsigned int parentInode = resolveParent(path, name, resolved);
+            unsigned int inodeIndex = lookup(parentInode, name, path);
+            std::shared_mutex *first = &directoryLocks.forIndex(parentInode);
+            std::shared_mutex *second = &directoryLocks.forIndex(inodeIndex);
+            if (std::less<std::shared_mutex *>()(second, first)) {
+                std::swap(first, second);
+            }
+            std::unique_lock<std::shared_mutex> firstLock(*first);
+            std::unique_lock<std::shared_mutex> secondLock;
+            if (second != first) {
+                secondLock = std::unique_lock<std::shared_mutex>(*second);
+            }
+
+            Directory *parent = findDirectory(parentInode);
+            Result<unsigned int> entry = parent == resolved ? parent->tryGetInodeIndex(name) : Result<unsigned int>(ErrorCode::NotFound);
+            if (!entry || entry.value() != inodeIndex) {
+                return false;
+            }
+            Directory &directory = directoryFor(inodeIndex, path);
+            if (directory.size() != 0) {
+                throw DirectoryNotEmptyException(path);
+            }
+            if (inodeIndex == currentDirectory.load()) {
+                return false;
+            }
+
+            parent->removeFile(name);
+            dentryCache.invalidate(parentInode, name);
+            markDirty(parentInode);
+            {
+                std::unique_lock<std::shared_mutex> lock(directoriesLock);
+                EpochReclaimer::instance().retire(directories.at(inodeIndex).release());
+                dirtyDirectories.erase(inodeIndex);
+            }
+            releaseExtents(inodeTable[inodeIndex]);
+            releaseInode(inodeIndex);
+            logRecord(Journal::RecordType::RemoveDirectory, path);
+            return true;
+        }
+        catch(const cse4733::FileMissingException &e)
+        {
+            return false;
+        }
+    }
+
+    void FileSystem::changeDirectory(const std::string &path)
+    {
+        VolumeGuard guard(*this, false);
+        if (!isFormatted) {
+            throw UnformattedFilesystemException();
+        }
+
+        // Enter the directory under its lock, which removeDirectory holds while it checks the current directory
+        std::shared_lock<std::shared_mutex> lock;
+        unsigned int inodeIndex;
+        lockDirectory(path, lock, inodeIndex);
+        std::string absolute = normalizePath(path);
+        std::lock_guard<std::mutex> pathLock(currentPathMutex);
+        currentDirectory = inodeIndex;
+        currentPath = absolute;
+    }
+
+    std::string FileSystem::getCurrentDirectory() const
+    {
+        VolumeGuard guard(*this, false);
+        std::lock_guard<std::mutex> lock(currentPathMutex);
+        return currentPath;
+    }
+
+    bool FileSystem::isDirectory(const std::string &path)
+    {
+        VolumeGuard guard(*this, false);
+        if (!isFormatted) {
+            throw UnformattedFilesystemException();
+        }
+        std::shared_lock<std::shared_mutex> lock;
+        Result<unsigned int> inodeIndex = tryLockPath(path, lock);
+        if (!inodeIndex) {
+            if (inodeIndex.error() != ErrorCode::NotFound) {
+                throwError(inodeIndex.error(), path);
+            }
+            return false;
+        }
+        return inodeTable[inodeIndex.value()].isDirectory();
+    }
+
+    bool FileSystem::format()
+    {
+        VolumeGuard guard(*this, true);
+        // A fresh image starts with an empty journal; an in-memory journal restarts with the format itself
+        if (image) {
+            std::string path = image->getPath();
+            createImage(path);
+            return true;
+        }
+
+        inodeTable = InodeTable(inodeTable.size());
+        resetBlockManager();
+        createRoot();
+        if (journal && !replaying) {
+            journal->reset();
+        }
+        logRecord(Journal::RecordType::Format, "/");
+        return true;
+    }
+
+    void FileSystem::createImage(const std::string &path)
+    {
+        VolumeGuard guard(*this, true);
+        // 1. Release any mapped image first, since the file may be the one being replaced
+        // 2. Lay out a fresh image with the current geometry, mount it and create the root directory
+        size_t inodeCount = inodeTable.size();
+        if (image) {
+            detachImage();
+        }
+        DiskImage::create(path, diskSize / blockSize, blockSize, inodeCount, allocationPolicy);
+        mount(path);
+        createRoot();
+        sync();
+    }
+
+    void FileSystem::mount(const std::string &path)
+    {
+        VolumeGuard guard(*this, true);
+        // 1. Sync and release the current image, if any
+        // 2. Open the image's journal and finish any checkpoint a crash interrupted, then map the image
+        // 3. Adopt the image's geometry and attach the block manager and inode table to its regions
+        // 4. A clean image starts an empty journal and is marked in use on disk, so a crash is detected on the next mount
+        // 5. Otherwise roll its allocation back to the stored directory tree, replay the journal and sync the result
+        size_t groupSize = journal ? journal->getGroupSize() : Journal::DEFAULT_GROUP_SIZE;
+        if (image) {
+            unmount();
+        }
+        std::unique_ptr<Journal> log = std::make_unique<Journal>(path + ".journal", groupSize);
+        if (DiskImage::finishCheckpoint(path, log->readRecords())) {
+            log->reset();
+        }
+        std::unique_ptr<DiskImage> mounted = std::make_unique<DiskImage>(path);
+        Superblock &sb = mounted->superblock();
+
+        blockSize = sb.blockSize;
+        diskSize = static_cast<size_t>(sb.totalBlocks) * sb.blockSize;
+        allocationPolicy = static_cast<AllocationPolicy>(sb.allocationPolicy);
+
+        blockManager = BlockManager(sb.totalBlocks, blockSize, allocationPolicy, mounted->blockRegions());
+        blockManager.setVerifyOnRead(checksumVerification);
+        inodeTable = InodeTable(mounted->inodeRecords(), sb.inodeCount, sb.freeInodeHead, sb.freeInodeCount);
+        image = std::move(mounted);
+
+        directories.clear();
+        dirtyDirectories.clear();
+        dentryCache.clear();
+        snapshots.clear();
+        decompressedFiles.clear();
+        currentDirectory = ROOT_INODE;
+        currentPath = "/";
+        isFormatted = true;
+
+        journal = std::move(log);
+        if (sb.clean != 0) {
+            journal->reset();
+            sb.clean = 0;
+            checkpointImage();
+        } else {
+            reclaimUnreachable();
+            replayJournal();
+            sync();
+        }
+    }
+
+    bool FileSystem::sync()
+    {
+        VolumeGuard guard(*this, true);
+        // 1. Store every modified directory in its inode's blocks
+        // 2. Record the free counts and free-inode stack head
+        // 3. Checkpoint the image and empty the journal once everything it describes is in the image;
+        //    if a directory could not be stored, keep the last checkpoint and let the journal carry the changes
+        if (!image) {
+            blockManager.flush();
+            if (!journal) {
+                return !blockManager.isMemoryResident();
+            }
+            journal->commit();
+            return true;
+        }
+
+        bool stored = true;
+        for (auto it = dirtyDirectories.begin(); it != dirtyDirectories.end();) {
+            if (storeDirectory(*it)) {
+                it = dirtyDirectories.erase(it);
+            } else {
+                stored = false;
+                ++it;
+            }
+        }
+
+        if (!stored) {
+            journal->commit();
+            return false;
+        }
+        Superblock &sb = image->superblock();
+        sb.freeBlockCount = blockManager.getFreeBlockCount();
+        sb.freeInodeCount = inodeTable.getFreeCount();
+        sb.freeInodeHead = inodeTable.getFreeHead();
+        checkpointImage();
+        return true;
+    }
+
+    void FileSystem::checkpointImage()
+    {
+        image->checkpoint(*journal);
+        journal->reset();
+    }
+
+    bool FileSystem::unmount()
+    {
+        VolumeGuard guard(*this, true);
+        // 1. Release the snapshots first, so the stored share counts only count files
+        // 2. Mark the image clean in the final checkpoint; if the sync fails, the file keeps the last
+        //    checkpoint, still marked in use, and the journal holds the rest
+        if (!image) {
+            return false;
+        }
+
+        while (!snapshots.empty()) {
+            deleteSnapshot(snapshots.begin()->first);
+        }
+
+        image->superblock().clean = 1;
+        sync();
+        detachImage();
+        return true;
+    }
+
+    bool FileSystem::isMounted() const
+    {
+        VolumeGuard guard(*this, false);
+        return image != nullptr;
+    }
+
+    void FileSystem::openJournal(const std::string &path, size_t groupSize)
+    {
+        VolumeGuard guard(*this, true);
+        // Commit and close the current journal before the new one is read
+        journal.reset();
+        journal = std::make_unique<Journal>(path, groupSize);
+        replayJournal();
+    }
+
+    bool FileSystem::isJournaling() const
+    {
+        VolumeGuard guard(*this, false);
+        return journal != nullptr;
+    }
+
+    size_t FileSystem::getJournalRecordCount() const
+    {
+        VolumeGuard guard(*this, false);
+        return journal ? journal->getCommittedCount() : 0;
+    }
+
+    size_t FileSystem::getJournalCommitCount() const
+    {
+        VolumeGuard guard(*this, false);
+        return journal ? journal->getCommitCount() : 0;
+    }
+
+    int FileSystem::findInode(const std::string &filename)
+    {
+        if (!isFormatted)
+        {
+            throw UnformattedFilesystemException(); // Filesystem has not been formatted
+        }
+        return resolvePath(filename);
+    }
+
+    unsigned int FileSystem::resolvePath(const std::string &path)
+    {
+        Result<unsigned int> inodeIndex = tryResolvePath(path);
+        if (!inodeIndex) {
+            throwError(inodeIndex.error(), path);
+        }
+        return inodeIndex.value();
+    }
+
+    Result<unsigned int> FileSystem::tryResolvePath(const std::string &path)
+    {
+        unsigned int parentInode;
+        std::string name;
+        return tryResolveEntry(path, parentInode, name);
+    }
+
+    Result<unsigned int> FileSystem::tryResolveEntry(const std::string &path, unsigned int &parentInode, std::string &name)
+    {
+        // 1. Start at the root for absolute paths, otherwise at the current directory
+        // 2. Look up each non-empty component in turn, skipping ".", and remember the last one
+        unsigned int inodeIndex = (!path.empty() && path[0] == '/') ? ROOT_INODE : currentDirectory.load();
+        parentInode = inodeIndex;
+        name.clear();
+        size_t position = 0;
+        while (position < path.size())
+        {
+            size_t end = path.find('/', position);
+            if (end == std::string::npos) {
+                end = path.size();
+            }
+            if (end > position && !(end - position == 1 && path[position] == '.')) {
+                parentInode = inodeIndex;
+                name.assign(path, position, end - position);
+                Result<unsigned int> entry = tryLookup(inodeIndex, name);
+                if (!entry) {
+                    return entry;
+                }
+                inodeIndex = entry.value();
+            }
+            position = end + 1;
+        }
+        return inodeIndex;
+    }
+
+    unsigned int FileSystem::resolveParent(const std::string &path, std::string &name, const Directory *&parent)
+    {
+        Result<unsigned int> parentInode = tryResolveParent(path, name, parent);
+        if (!parentInode) {
+            throwError(parentInode.error(), path);
+        }
+        return parentInode.value();
+    }
+
+    Result<unsigned int> FileSystem::tryResolveParent(const std::string &path, std::string &name, const Directory *&parent)
+    {
+        // 1. Split the path at its last slash, ignoring trailing slashes,
+        //    and reject names that cannot be created or removed
+        // 2. Resolve the parent path, or the current directory, to a directory
+        std::string parentPath;
+        if (!splitPath(path, parentPath, name)) {
+            return ErrorCode::IsADirectory;
+        }
+        return tryResolveDirectory(parentPath.empty() ? "." : parentPath, parent);
+    }
+
+    Result<unsigned int> FileSystem::tryResolveDirectory(const std::string &path, const Directory *&directory)
+    {
+        // 1. Resolve the path and find the directory's Directory
+        // 2. Make sure the entry that led to it still names it; otherwise the directory may have been removed
+        //    and its inode reused by another one, so drop any cached lookup of the entry and resolve again
+        while (true) {
+            unsigned int parentInode;
+            std::string name;
+            Result<unsigned int> inodeIndex = tryResolveEntry(path, parentInode, name);
+            if (!inodeIndex) {
+                return inodeIndex;
+            }
+            directory = findDirectory(inodeIndex.value());
+            if (directory == nullptr) {
+                return ErrorCode::NotADirectory;
+            }
+            if (name.empty() || name == "..") {
+                return inodeIndex;
+            }
+            const Directory *parent = findDirectory(parentInode);
+            Result<unsigned int> entry = parent != nullptr ? parent->tryGetInodeIndex(name) : Result<unsigned int>(ErrorCode::NotFound);
+            if (entry && entry.value() == inodeIndex.value()) {
+                return inodeIndex;
+            }
+            dentryCache.invalidate(parentInode, name);
+        }
+    }
+
+    const Directory &FileSystem::lockDirectory(const std::string &path, std::shared_lock<std::shared_mutex> &lock,
+                                               unsigned int &inodeIndex)
+    {
+        // Lock the directory that was resolved; if it was removed before the lock was taken, resolve again
+        while (true) {
+            const Directory *directory;
+            Result<unsigned int> resolved = tryResolveDirectory(path, directory);
+            if (!resolved) {
+                throwError(resolved.error(), path);
+            }
+            lock = std::shared_lock<std::shared_mutex>(directoryLocks.forIndex(resolved.value()));
+            if (findDirectory(resolved.value()) == directory) {
+                inodeIndex = resolved.value();
+                return *directory;
+            }
+            lock = std::shared_lock<std::shared_mutex>();
+        }
+    }
+
+    bool FileSystem::splitPath(const std::string &path, std::string &parentPath, std::string &name)
+    {
+        size_t end = path.find_last_not_of('/');
+        if (end == std::string::npos) {
+            return false;
+        }
+        size_t slash = path.rfind('/', end);
+        size_t start = slash == std::string::npos ? 0 : slash + 1;
+        name = path.substr(start, end - start + 1);
+        if (name == "." || name == "..") {
+            return false;
+        }
+        parentPath = slash == std::string::npos ? std::string() : slash == 0 ? std::string("/") : path.substr(0, slash);
+        return true;
+    }
+
+    unsigned int FileSystem::lookup(unsigned int directoryInode, const std::string &name, const std::string &path)
+    {
+        Result<unsigned int> inodeIndex = tryLookup(directoryInode, name);
+        if (!inodeIndex) {
+            throwError(inodeIndex.error(), inodeIndex.error() == ErrorCode::NotFound ? name : path);
+        }
+        return inodeIndex.value();
+    }
+
+    Result<unsigned int> FileSystem::tryLookup(unsigned int directoryInode, const std::string &name)
+    {
+        // 1. Serve the lookup from the dentry cache when possible
+        // 2. Otherwise search the directory itself without locking it and cache a hit,
+        //    unless an entry was added or removed meanwhile; removals invalidate the cache
+        //    after bumping the version, so a result that went stale is never cached again
+        unsigned int inodeIndex;
+        if (dentryCache.lookup(directoryInode, name, inodeIndex)) {
+            return inodeIndex;
+        }
+
+        const Directory *directory = findDirectory(directoryInode);
+        if (directory == nullptr) {
+            return ErrorCode::NotADirectory;
+        }
+        if (name == "..") {
+            return directory->getParentInode();
+        }
+        uint64_t version = directory->getVersion();
+        Result<unsigned int> entry = directory->tryGetInodeIndex(name);
+        if (entry) {
+            dentryCache.insert(directoryInode, name, entry.value(),
+                               [directory, version]() { return directory->getVersion() == version; });
+        }
+        return entry;
+    }
+
+    Directory &FileSystem::directoryFor(unsigned int inodeIndex, const std::string &path)
+    {
+        Directory *directory = findDirectory(inodeIndex);
+        if (directory == nullptr) {
+            throw NotADirectoryException(path);
+        }
+        return *directory;
+    }
+
+    Directory *FileSystem::findDirectory(unsigned int inodeIndex)
+    {
+        // 1. Return the loaded directory, or null if it was removed; removed and replaced directories are
+        //    retired, so the pointer stays valid until the caller's VolumeGuard ends
+        // 2. Directories of a mounted image are decoded from their blocks the first time they are used;
+        //    if two threads race to load one, the first to insert it wins
+        {
+            std::shared_lock<std::shared_mutex> lock(directoriesLock);
+            auto it = directories.find(inodeIndex);
+            if (it != directories.end()) {
+                return it->second.get();
+            }
+        }
+        if (!image || inodeIndex >= inodeTable.size() || !inodeTable[inodeIndex].isDirectory()) {
+            return nullptr;
+        }
+        auto loaded = std::make_unique<Directory>(Directory::deserialize(readDataFromBlocks(inodeTable[inodeIndex])));
+        std::unique_lock<std::shared_mutex> lock(directoriesLock);
+        return directories.emplace(inodeIndex, std::move(loaded)).first->second.get();
+    }
+
+    unsigned int FileSystem::addEntry(const std::string &path, uint32_t flags, unsigned int &parentInode,
+                                      std::unique_lock<std::shared_mutex> &parentLock)
+    {
+        Result<unsigned int> inodeIndex = tryAddEntry(path, flags, parentInode, parentLock);
+        if (!inodeIndex) {
+            throwError(inodeIndex.error(), path);
+        }
+        return inodeIndex.value();
+    }
+
+    Result<unsigned int> FileSystem::tryAddEntry(const std::string &path, uint32_t flags, unsigned int &parentInode,
+                                                 std::unique_lock<std::shared_mutex> &parentLock)
+    {
+        std::string name;
+        const Directory *directory;
+        Result<unsigned int> parent = tryResolveParent(path, name, directory);
+        if (!parent) {
+            return parent;
+        }
+        parentInode = parent.value();
+        return tryLinkEntry(parentInode, directory, name, flags, parentLock);
+    }
+
+    Result<unsigned int> FileSystem::tryLinkEntry(unsigned int parentInode, const Directory *resolved,
+                                                  const std::string &name, uint32_t flags,
+                                                  std::unique_lock<std::shared_mutex> &parentLock,
+                                                  const std::function<bool(Inode &)> &prepare)
+    {
+        // 1. Lock the parent, make sure it is still the directory that was resolved and that the name is free
+        // 2. Allocate and tag the inode and let the caller fill it in, or store an empty Directory
+        //    for a new directory
+        // 3. Link it into the parent directory
+        if (!parentLock.owns_lock()) {
+            parentLock = std::unique_lock<std::shared_mutex>(directoryLocks.forIndex(parentInode));
+        }
+        Directory *parent = findDirectory(parentInode);
+        if (parent == nullptr || parent != resolved) {
+            return ErrorCode::NotFound;
+        }
+        if (parent->fileExists(name)) {
+            return ErrorCode::AlreadyExists;
+        }
+
+        Result<unsigned int> inodeIndex = tryAllocateInode();
+        if (!inodeIndex) {
+            return inodeIndex;
+        }
+        inodeTable[inodeIndex.value()].flags |= flags;
+        if (prepare && !prepare(inodeTable[inodeIndex.value()])) {
+            releaseInode(inodeIndex.value());
+            return ErrorCode::NoSpace;
+        }
+        if (flags & Inode::FLAG_DIRECTORY) {
+            std::unique_lock<std::shared_mutex> lock(directoriesLock);
+            std::unique_ptr<Directory> &slot = directories[inodeIndex.value()];
+            if (slot) {
+                EpochReclaimer::instance().retire(slot.release());
+            }
+            slot = std::make_unique<Directory>(parentInode);
+        }
+        parent->addFile(name, inodeIndex.value());
+        markDirty(parentInode);
+        return inodeIndex;
+    }
+
+    void FileSystem::throwError(ErrorCode error, const std::string &path)
+    {
+        switch (error) {
+        case ErrorCode::NotFound:
+            throw FileMissingException(path);
+        case ErrorCode::AlreadyExists:
+            throw FileAlreadyExistsException(path);
+        case ErrorCode::IsADirectory:
+            throw IsADirectoryException(path);
+        case ErrorCode::NotADirectory:
+            throw NotADirectoryException(path);
+        case ErrorCode::NoSpace:
+            throw NoFreeBlockAvailableException();
+        case ErrorCode::NoInode:
+            throw NoAvailableInodeException();
+        case ErrorCode::CorruptData:
+            throw CorruptDataException(path);
+        case ErrorCode::Unformatted:
+            throw UnformattedFilesystemException();
+        case ErrorCode::Ok:
+            break;
+        }
+        throw std::logic_error("throwError called without an error");
+    }
+
+    std::string FileSystem::normalizePath(const std::string &path) const
+    {
+        std::vector<std::string> components;
+        std::string joined = path;
+        if (path.empty() || path[0] != '/') {
+            std::lock_guard<std::mutex> lock(currentPathMutex);
+            joined = currentPath + "/" + path;
+        }
+        size_t position = 0;
+        while (position < joined.size())
+        {
+            size_t end = joined.find('/', position);
+            if (end == std::string::npos) {
+                end = joined.size();
+            }
+            std::string component = joined.substr(position, end - position);
+            if (component == "..") {
+                if (!components.empty()) {
+                    components.pop_back();
+                }
+            } else if (!component.empty() && component != ".") {
+                components.push_back(component);
+            }
+            position = end + 1;
+        }
+
+        std::string normalized;
+        for (const std::string &component: components) {
+            normalized += "/" + component;
+        }
+        return normalized.empty() ? "/" : normalized;
+    }
+
+    unsigned int FileSystem::allocateInode()
+    {   
+        Result<unsigned int> inodeIndex = tryAllocateInode();
+        if (!inodeIndex) {
+            throwError(inodeIndex.error(), std::string());
+        }
+        return inodeIndex.value();
+    }
+
+    Result<unsigned int> FileSystem::tryAllocateInode()
+    {
+        if (!isFormatted) {
+            return ErrorCode::Unformatted;
+        }
+
+        std::lock_guard<std::mutex> lock(inodeTableMutex);
+        return inodeTable.tryAllocate();
+    }
+
+    void FileSystem::releaseInode(int inodeIndex)
+    {
+        if (inodeIndex >= 0)
+        {
+            std::lock_guard<std::mutex> lock(inodeTableMutex);
+            inodeTable.release(static_cast<unsigned int>(inodeIndex));
+        }
+    }
+
+    void FileSystem::createRoot()
+    {
+        // The root directory is the first inode and is its own parent
+        directories.clear();
+        dirtyDirectories.clear();
+        dentryCache.clear();
+        snapshots.clear();
+        decompressedFiles.clear();
+
+        unsigned int rootInode = inodeTable.allocate();
+        inodeTable[rootInode].flags |= Inode::FLAG_DIRECTORY;
+        directories.emplace(rootInode, std::make_unique<Directory>(rootInode));
+        markDirty(rootInode);
+        currentDirectory = rootInode;
+        currentPath = "/";
+
+        isFormatted = true;
+    }
+
+    void FileSystem::markDirty(unsigned int directoryInode)
+    {
+        if (image) {
+            std::unique_lock<std::shared_mutex> lock(directoriesLock);
+            dirtyDirectories.insert(directoryInode);
+        }
+    }
+
+    bool FileSystem::storeDirectory(unsigned int directoryInode)
+    {
+        // Resize the directory inode to the encoded entries and copy them in
+        std::string data = directories.at(directoryInode)->serialize();
+        Inode &inode = inodeTable[directoryInode];
+        std::vector<Extent> extents = loadExtents(inode);
+        if (!resizeExtents(inode, extents, data.size())) {
+            return false;
+        }
+        writeRange(extents, 0, data.data(), data.size());
+        inode.fileSize = data.size();
+        inode.modificationTime = std::time(nullptr);
+        return true;
+    }
+
+    void FileSystem::reclaimUnreachable()
+    {
+        // 1. Walk the directory tree from the root, collecting reachable inodes and the blocks they use
+        // 2. Free every allocated inode that was not reached and relink the free-inode stack
+        // 3. Rewrite the bitmap and share counts so each collected block has one reference per owner,
+        //    and reattach the block manager
+        std::vector<bool> reachable(inodeTable.size(), false);
+        std::vector<Extent> used;
+        std::vector<unsigned int> pending{ROOT_INODE};
+        reachable[ROOT_INODE] = true;
+        while (!pending.empty()) {
+            unsigned int inodeIndex = pending.back();
+            pending.pop_back();
+            const Inode &inode = inodeTable[inodeIndex];
+
+            std::vector<Extent> extents = loadExtents(inode);
+            used.insert(used.end(), extents.begin(), extents.end());
+            // An inline file's pointer fields hold its data
+            bool pointers = !inode.isInline();
+            if (pointers && inode.indirectBlock != Inode::NO_BLOCK) {
+                used.push_back(Extent{inode.indirectBlock, 1});
+            }
+            if (pointers && inode.doubleIndirectBlock != Inode::NO_BLOCK) {
+                used.push_back(Extent{inode.doubleIndirectBlock, 1});
+                size_t spilled = inode.extentCount - Inode::MAX_DIRECT_EXTENTS - extentsPerBlock();
+                size_t blocks = (spilled + extentsPerBlock() - 1) / extentsPerBlock();
+                std::string raw = blockManager.readBlock(inode.doubleIndirectBlock);
+                for (size_t i = 0; i < blocks; i++) {
+                    uint32_t block;
+                    std::memcpy(&block, raw.data() + i * sizeof(uint32_t), sizeof(uint32_t));
+                    used.push_back(Extent{block, 1});
+                }
+            }
+
+            if (inode.isDirectory()) {
+                const Directory &directory = directoryFor(inodeIndex, "/");
+                for (const std::string &name: directory.listFiles()) {
+                    unsigned int child = directory.getInodeIndex(name);
+                    if (child < reachable.size() && !reachable[child]) {
+                        reachable[child] = true;
+                        pending.push_back(child);
+                    }
+                }
+            }
+        }
+
+        for (size_t i = 0; i < inodeTable.size(); i++) {
+            if (!reachable[i] && inodeTable[i].isAllocated()) {
+                inodeTable[i].deallocate();
+            }
+        }
+        inodeTable.rebuildFreeList();
+
+        BlockRegions regions = image->blockRegions();
+        size_t totalBlocks = blockManager.getTotalBlocks();
+        FreeSpaceBitmap::clear(regions.bitmapWords, totalBlocks);
+        std::fill(regions.shareCounts, regions.shareCounts + totalBlocks, 0);
+        FreeSpaceBitmap bitmap(regions.bitmapWords, totalBlocks, totalBlocks);
+        for (const Extent &extent: used) {
+            for (uint32_t block = extent.start; block < extent.start + extent.length; block++) {
+                if (bitmap.isFree(block)) {
+                    bitmap.markUsed(block);
+                } else {
+                    ++regions.shareCounts[block];
+                }
+            }
+        }
+        blockManager = BlockManager(totalBlocks, blockSize, allocationPolicy, regions);
+        blockManager.setVerifyOnRead(checksumVerification);
+    }
+
+    void FileSystem::logRecord(Journal::RecordType type, const std::string &path, uint64_t offset, const std::string &data)
+    {
+        if (journal && !replaying && journal->append(Journal::Record{type, normalizePath(path), offset, data})) {
+            scheduleJournalCommit();
+        }
+    }
+
+    void FileSystem::scheduleJournalCommit()
+    {
+        // The full group is written and synced on the thread pool, so the writer that filled it
+        // does not wait for the fsync under its inode lock, and other writers keep appending meanwhile
+        if (journalCommitQueued.exchange(true)) {
+            return;
+        }
+        asyncExecutor().post([this]() {
+            VolumeGuard guard(*this, false);
+            journalCommitQueued.store(false);
+            try
+            {
+                if (journal) {
+                    journal->commit();
+                }
+            }
+            catch(const cse4733::JournalException &)
+            {
+                // The records stay pending, and the next sync reports the failure
+            }
+        });
+    }
+
+    size_t FileSystem::replayJournal()
+    {
+        // 1. Apply the records in order through the public operations
+        // 2. Skip records that no longer apply, e.g. creating a file the state already holds
+        // 3. Restore the caller's current directory, which the absolute paths never depend on
+        std::vector<Journal::Record> records = journal->readRecords();
+        std::string workingPath = currentPath;
+        replaying = true;
+        for (const Journal::Record &record: records) {
+            try
+            {
+                switch (record.type) {
+                case Journal::RecordType::Format:
+                    format();
+                    break;
+                case Journal::RecordType::CreateFile:
+                    createFile(record.path);
+                    break;
+                case Journal::RecordType::MakeDirectory:
+                    makeDirectory(record.path);
+                    break;
+                case Journal::RecordType::DeleteFile:
+                    deleteFile(record.path);
+                    break;
+                case Journal::RecordType::RemoveDirectory:
+                    removeDirectory(record.path);
+                    break;
+                case Journal::RecordType::WriteFile:
+                    writeFile(record.path, record.data);
+                    break;
+                case Journal::RecordType::WriteAt:
+                    writeFile(record.path, static_cast<size_t>(record.offset), record.data);
+                    break;
+                case Journal::RecordType::Truncate:
+                    truncateFile(record.path, static_cast<size_t>(record.offset));
+                    break;
+                case Journal::RecordType::CloneFile:
+                    cloneFile(record.data, record.path);
+                    break;
+                case Journal::RecordType::SetCompression:
+                    setFileCompression(record.path, static_cast<CompressionPreference>(record.offset));
+                    break;
+                case Journal::RecordType::Page:
+                case Journal::RecordType::Checkpoint:
+                    // Pages of a checkpoint that never completed; the image still holds the previous one
+                    break;
+                }
+            }
+            catch(const std::runtime_error &e)
+            {
+                // The record's effect is already present or can no longer be applied
+            }
+        }
+        replaying = false;
+
+        try
+        {
+            if (isFormatted) {
+                changeDirectory(workingPath);
+            }
+        }
+        catch(const std::runtime_error &e)
+        {
+            currentDirectory = ROOT_INODE;
+            currentPath = "/";
+        }
+        return records.size();
+    }
+
+    void FileSystem::detachImage()
+    {
+        // Drop everything that points into the mapping before unmapping it
+        resetBlockManager();
+        inodeTable = InodeTable(inodeTable.size());
+        directories.clear();
+        dirtyDirectories.clear();
+        dentryCache.clear();
+        snapshots.clear();
+        decompressedFiles.clear();
+        currentDirectory = ROOT_INODE;
+        currentPath = "/";
+        isFormatted = false;
+        journal.reset();
+        image.reset();
+    }
+
+    void FileSystem::resetBlockManager()
+    {
+        size_t totalBlocks = diskSize / blockSize;
+        if (blockStoreFactory) {
+            blockManager = BlockManager(totalBlocks, blockSize, allocationPolicy,
+                                        blockStoreFactory(totalBlocks, blockSize), blockCacheBytes);
+        } else {
+            blockManager = BlockManager(totalBlocks, blockSize, allocationPolicy);
+        }
+        blockManager.setVerifyOnRead(checksumVerification);
+        readahead.clear();
+    }
+
+    std::vector<Extent> FileSystem::writeDataToBlocks(const std::string &data, std::vector<Extent> *reservation)
+    {
+        size_t blocksNeeded = (data.size() + blockSize - 1) / blockSize;
+        std::vector<Extent> extents;
+        if (deduplication) {
+            // Store block by block, merging blocks that happen to be adjacent into one extent
+            for (size_t offset = 0; offset < data.size(); offset += blockSize) {
+                Result<unsigned int> block = blockManager.tryStoreBlock(data.data() + offset,
+                                                                        std::min(blockSize, data.size() - offset));
+                if (!block) {
+                    for (const Extent &extent: extents) {
+                        blockManager.freeExtent(extent);
+                    }
+                    return {};
+                }
+                if (!extents.empty() && extents.back().start + extents.back().length == block.value()) {
+                    extents.back().length++;
+                } else {
+                    extents.push_back(Extent{block.value(), 1});
+                }
+            }
+            return extents;
+        }
+
+        if (reservation != nullptr && blocksNeeded > 0) {
+            // Carve the blocks off the front of the reservation if it still holds enough
+            size_t reserved = 0;
+            for (const Extent &extent: *reservation) {
+                reserved += extent.length;
+            }
+            if (reserved >= blocksNeeded) {
+                size_t remaining = blocksNeeded;
+                auto it = reservation->begin();
+                while (remaining > 0) {
+                    uint32_t length = static_cast<uint32_t>(std::min<size_t>(remaining, it->length));
+                    extents.push_back(Extent{it->start, length});
+                    remaining -= length;
+                    if (length == it->length) {
+                        ++it;
+                    } else {
+                        it->start += length;
+                        it->length -= length;
+                    }
+                }
+                reservation->erase(reservation->begin(), it);
+            }
+        }
+
+        if (extents.empty()) {
+            Result<std::vector<Extent>> allocated = blockManager.tryAllocateExtents(blocksNeeded);
+            if (!allocated) {
+                return {};
+            }
+            extents = std::move(allocated).value();
+        }
+
+        size_t offset = 0;
+        for (const Extent &extent: extents) {
+            size_t length = std::min(static_cast<size_t>(extent.length) * blockSize, data.size() - offset);
+            blockManager.writeExtent(extent, data.data() + offset, length);
+            offset += length;
+        }
+        return extents;
+    }
+
+    std::string FileSystem::readDataFromBlocks(const Inode &inode)
+    {
+        // Size the result once and copy each extent straight out of block storage
+        if (inode.flags & Inode::FLAG_COMPRESSED) {
+            return decodeData(loadExtents(inode), inode.fileSize);
+        }
+        if (inode.isInline()) {
+            return std::string(inode.inlineData(), inode.fileSize);
+        }
+        std::string data(inode.fileSize, '\0');
+        copyExtents(loadExtents(inode), 0, inode.fileSize, data.data());
+        return data;
+    }
+
+    std::vector<std::string_view> FileSystem::segmentsFor(const Inode &inode)
+    {
+        if (inode.isInline()) {
+            return {std::string_view(inode.inlineData(), inode.fileSize)};
+        }
+        return segmentsFor(loadExtents(inode), inode.fileSize);
+    }
+
+    std::vector<std::string_view> FileSystem::segmentsFor(const std::vector<Extent> &extents, size_t size)
+    {
+        // 1. Walk the extents in file order, stopping once size bytes are covered
+        // 2. Extend the previous segment when an extent starts right where it ended
+        std::vector<std::string_view> segments;
+        size_t remaining = size;
+        for (const Extent &extent: extents) {
+            if (remaining == 0) {
+                break;
+            }
+            std::string_view view = blockManager.viewExtent(extent, remaining);
+            if (!segments.empty() && segments.back().data() + segments.back().size() == view.data()) {
+                segments.back() = std::string_view(segments.back().data(), segments.back().size() + view.size());
+            } else {
+                segments.push_back(view);
+            }
+            remaining -= view.size();
+        }
+        return segments;
+    }
+
+    size_t FileSystem::copyExtents(const std::vector<Extent> &extents, size_t offset, size_t length, char *buffer)
+    {
+        // 1. Walk the extents, copying the part of each that overlaps [offset, offset + length);
+        //    every extent but the last is full, so each covers extent.length blocks of the data
+        // 2. With readahead on, copy a window at a time and queue a prefetch of the following
+        //    window before each copy, so loading the next blocks overlaps copying these
+        size_t window = readaheadWindow();
+        size_t end = offset + length;
+        size_t prefetched = offset;
+        size_t copied = 0;
+        size_t position = 0;
+        for (size_t i = 0; i < extents.size() && copied < length; ++i) {
+            const Extent &extent = extents[i];
+            size_t extentBytes = static_cast<size_t>(extent.length) * blockSize;
+            if (position + extentBytes > offset) {
+                size_t from = std::max(offset, position) - position;
+                size_t count = std::min(extentBytes - from, length - copied);
+                while (count > 0) {
+                    size_t piece = window > 0 ? std::min(count, window) : count;
+                    size_t pieceEnd = offset + copied + piece;
+                    if (window > 0 && pieceEnd < end && prefetched < pieceEnd + window) {
+                        size_t ahead = std::max(prefetched, pieceEnd);
+                        prefetched = std::min(pieceEnd + window, end);
+                        schedulePrefetch(extents, i, position, ahead, prefetched - ahead);
+                    }
+                    blockManager.readExtentAt(extent, from, buffer + copied, piece);
+                    from += piece;
+                    copied += piece;
+                    count -= piece;
+                }
+            }
+            position += extentBytes;
+        }
+        return copied;
+    }
+
+    size_t FileSystem::readaheadWindow() const
+    {
+        // Half of what one prefetch may load, so the window being read and the one prefetched
+        // after it both fit in the frames the shards give up to prefetching
+        size_t blocks = std::min(readaheadBlocks, blockManager.getPrefetchLimit() / 2);
+        return blocks * blockSize;
+    }
+
+    namespace
+    {
+        // A byte range of one extent to prefetch
+        struct PrefetchRange
+        {
+            Extent extent;
+            size_t offset;
+            size_t length;
+        };
+    } // namespace
+
+    void FileSystem::schedulePrefetch(const std::vector<Extent> &extents, size_t firstExtent, size_t position,
+                                      size_t offset, size_t length)
+    {
+        // The ranges are worked out now, while the caller holds the file's lock; the task only
+        // loads blocks, so if the file changes meanwhile the worst outcome is a wasted load
+        std::vector<PrefetchRange> ranges;
+        size_t end = offset + length;
+        for (size_t i = firstExtent; i < extents.size() && position < end; ++i) {
+            size_t extentBytes = static_cast<size_t>(extents[i].length) * blockSize;
+            if (position + extentBytes > offset) {
+                size_t from = std::max(offset, position) - position;
+                ranges.push_back({extents[i], from, std::min(extentBytes, end - position) - from});
+            }
+            position += extentBytes;
+        }
+        if (ranges.empty()) {
+            return;
+        }
+        asyncExecutor().post([this, ranges = std::move(ranges)]() {
+            VolumeGuard guard(*this, false);
+            for (const PrefetchRange &range: ranges) {
+                blockManager.prefetch(range.extent, range.offset, range.length);
+            }
+        });
+    }
+
+    void FileSystem::scheduleWriteBehind()
+    {
+        // The flag is cleared before writing back, so a failed write-back never blocks later ones
+        if (!blockManager.needsWriteBack() || writeBehindQueued.exchange(true)) {
+            return;
+        }
+        asyncExecutor().post([this]() {
+            VolumeGuard guard(*this, false);
+            writeBehindQueued.store(false);
+            blockManager.writeBack();
+        });
+    }
+
+    std::string FileSystem::encodeData(const Inode &inode, const std::string &data) const
+    {
+        // 1. Follow the file's own preference, falling back to the volume setting
+        // 2. Keep the compressed form only if it needs fewer blocks than the data itself
+        bool wanted = (inode.flags & Inode::FLAG_COMPRESS) ||
+                      (compression && !(inode.flags & Inode::FLAG_NO_COMPRESS));
+        if (!wanted || data.empty()) {
+            return {};
+        }
+
+        const Codec &codec = *codecs.at(compressionCodec);
+        std::string payload = codec.compress(data);
+        size_t encodedSize = COMPRESSION_HEADER_SIZE + payload.size();
+        if ((encodedSize + blockSize - 1) / blockSize >= (data.size() + blockSize - 1) / blockSize) {
+            return {};
+        }
+
+        std::string encoded(COMPRESSION_HEADER_SIZE, '\0');
+        encoded[0] = static_cast<char>(codec.getId());
+        uint32_t payloadSize = static_cast<uint32_t>(payload.size());
+        std::memcpy(&encoded[4], &payloadSize, sizeof(payloadSize));
+        encoded += payload;
+        return encoded;
+    }
+
+    std::string FileSystem::decodeData(const std::vector<Extent> &extents, size_t rawSize)
+    {
+        // 1. Read the header to learn the codec and the compressed length
+        // 2. Gather the compressed bytes and hand them to the codec
+        auto gather = [&](size_t size) {
+            std::string bytes(size, '\0');
+            bytes.resize(copyExtents(extents, 0, size, bytes.data()));
+            return bytes;
+        };
+
+        std::string header = gather(COMPRESSION_HEADER_SIZE);
+        if (header.size() < COMPRESSION_HEADER_SIZE) {
+            throw CorruptDataException("compression header is missing");
+        }
+        uint32_t payloadSize;
+        std::memcpy(&payloadSize, &header[4], sizeof(payloadSize));
+        auto codec = codecs.find(static_cast<uint8_t>(header[0]));
+        if (codec == codecs.end()) {
+            throw CorruptDataException("unknown codec " + std::to_string(static_cast<unsigned char>(header[0])));
+        }
+
+        std::string stored = gather(COMPRESSION_HEADER_SIZE + payloadSize);
+        std::string data;
+        if (stored.size() != COMPRESSION_HEADER_SIZE + payloadSize ||
+            !codec->second->decompress(std::string_view(stored).substr(COMPRESSION_HEADER_SIZE), rawSize, data)) {
+            throw CorruptDataException("compressed data does not decompress");
+        }
+        return data;
+    }
+
+    bool FileSystem::replaceFileData(Inode &inode, const std::string &data)
+    {
+        // 1. Encode the new contents and write them to fresh blocks, unless they fit inline
+        // 2. Record the new extents or data in a copy of the inode, so the old blocks stay intact until this succeeds
+        // 3. Free the old blocks and install the copy
+        Inode replacement = inode;
+        replacement.flags &= ~Inode::FLAG_INLINE;
+        replacement.extentCount = 0;
+        replacement.indirectBlock = Inode::NO_BLOCK;
+        replacement.doubleIndirectBlock = Inode::NO_BLOCK;
+        std::string encoded;
+        if (fitsInline(data.size())) {
+            storeInline(replacement, data);
+        } else {
+            encoded = encodeData(inode, data);
+            const std::string &bytes = encoded.empty() ? data : encoded;
+            std::vector<Extent> extents = writeDataToBlocks(bytes);
+            if (extents.empty() && !bytes.empty()) {
+                return false;
+            }
+
+            bool recorded = false;
+            try
+            {
+                recorded = storeExtents(replacement, extents);
+            }
+            catch(const cse4733::NoFreeBlockAvailableException &e)
+            {
+                recorded = false;
+            }
+            if (!recorded) {
+                for (const Extent &extent: extents) {
+                    blockManager.freeExtent(extent);
+                }
+                return false;
+            }
+        }
+
+        forgetDecompressed(inode);
+        releaseExtents(inode);
+        inode = replacement;
+        if (encoded.empty()) {
+            inode.flags &= ~Inode::FLAG_COMPRESSED;
+        } else {
+            inode.flags |= Inode::FLAG_COMPRESSED;
+        }
+        inode.fileSize = data.size();
+        inode.modificationTime = std::time(nullptr);
+        return true;
+    }
+
+    bool FileSystem::fitsInline(size_t size)
+    {
+        return size > 0 && size <= Inode::MAX_INLINE_SIZE;
+    }
+
+    void FileSystem::storeInline(Inode &inode, const std::string &data)
+    {
+        // Zero the unused tail so the record's bytes depend only on the data
+        std::memset(inode.inlineData(), 0, Inode::MAX_INLINE_SIZE);
+        std::memcpy(inode.inlineData(), data.data(), data.size());
+        inode.flags |= Inode::FLAG_INLINE;
+        inode.fileSize = data.size();
+    }
+
+    bool FileSystem::rewritesWhole(const Inode &inode, size_t newSize)
+    {
+        return (inode.flags & (Inode::FLAG_COMPRESSED | Inode::FLAG_INLINE)) ||
+               (inode.extentCount == 0 && fitsInline(newSize));
+    }
+
+    const Snapshot &FileSystem::snapshotFor(unsigned int snapshotId) const
+    {
+        auto it = snapshots.find(snapshotId);
+        if (it == snapshots.end()) {
+            throw SnapshotMissingException(snapshotId);
+        }
+        return it->second;
+    }
+
+    Inode &FileSystem::lockFile(const std::string &filename, std::shared_lock<std::shared_mutex> &lock)
+    {
+        Result<unsigned int> inodeIndex = tryLockPath(filename, lock);
+        if (!inodeIndex) {
+            throwError(inodeIndex.error(), filename);
+        }
+        Inode &inode = inodeTable[inodeIndex.value()];
+        if (inode.isDirectory()) {
+            throw IsADirectoryException(filename);
+        }
+        return inode;
+    }
+
+    Inode &FileSystem::lockFile(const std::string &filename, std::unique_lock<std::shared_mutex> &lock)
+    {
+        Result<unsigned int> inodeIndex = tryLockPath(filename, lock);
+        if (!inodeIndex) {
+            throwError(inodeIndex.error(), filename);
+        }
+        Inode &inode = inodeTable[inodeIndex.value()];
+        if (inode.isDirectory()) {
+            throw IsADirectoryException(filename);
+        }
+        return inode;
+    }
+
+    template <typename Lock>
+    Result<unsigned int> FileSystem::tryLockEntry(const EntryResolver &resolve, Lock &lock)
+    {
+        // 1. Find the inode without locks and lock it
+        // 2. Keep it if no entry was looked up to reach it, or the entry still names it; the root and
+        //    directories reached through ".." are only ever named by entries that cannot be removed yet
+        // 3. Otherwise it was deleted, and possibly reused, since it was found, so drop any cached
+        //    lookup of the entry and find it again
+        while (true) {
+            unsigned int parentInode;
+            std::string name;
+            Result<unsigned int> inodeIndex = resolve(parentInode, name);
+            if (!inodeIndex) {
+                return inodeIndex;
+            }
+            lock = Lock(inodeLocks.forIndex(inodeIndex.value()));
+            if (name.empty() || name == "..") {
+                return inodeIndex;
+            }
+            const Directory *parent = findDirectory(parentInode);
+            Result<unsigned int> entry = parent != nullptr ? parent->tryGetInodeIndex(name) : Result<unsigned int>(ErrorCode::NotFound);
+            if (entry && entry.value() == inodeIndex.value()) {
+                return inodeIndex;
+            }
+            lock = Lock();
+            dentryCache.invalidate(parentInode, name);
+        }
+    }
+
+    template <typename Lock>
+    Result<unsigned int> FileSystem::tryLockPath(const std::string &path, Lock &lock)
+    {
+        return tryLockEntry([&](unsigned int &parentInode, std::string &name) {
+            return tryResolveEntry(path, parentInode, name);
+        }, lock);
+    }
+
+    void FileSystem::forgetDecompressed(const Inode &inode)
+    {
+        std::lock_guard<std::mutex> lock(decompressedMutex);
+        decompressedFiles.erase(&inode);
+    }
+
+    std::vector<Extent> FileSystem::loadExtents(const Inode &inode)
+    {
+        // 1. Take the extents stored directly in the inode
+        // 2. Append the extents held by the indirect block
+        // 3. Append the extents held by each block listed in the double-indirect block
+        std::vector<Extent> extents;
+        extents.reserve(inode.extentCount);
+
+        size_t remaining = inode.extentCount;
+        size_t direct = std::min(remaining, Inode::MAX_DIRECT_EXTENTS);
+        extents.insert(extents.end(), inode.directExtents, inode.directExtents + direct);
+        remaining -= direct;
+
+        auto appendFromBlock = [&](uint32_t block) {
+            std::string raw = blockManager.readBlock(block);
+            size_t count = std::min(remaining, extentsPerBlock());
+            size_t first = extents.size();
+            extents.resize(first + count);
+            std::memcpy(&extents[first], raw.data(), count * sizeof(Extent));
+            remaining -= count;
+        };
+
+        if (remaining > 0) {
+            appendFromBlock(inode.indirectBlock);
+        }
+        if (remaining > 0) {
+            std::string raw = blockManager.readBlock(inode.doubleIndirectBlock);
+            for (size_t i = 0; remaining > 0; i++) {
+                uint32_t block;
+                std::memcpy(&block, raw.data() + i * sizeof(uint32_t), sizeof(uint32_t));
+                appendFromBlock(block);
+            }
+        }
+        return extents;
+    }
+
+    bool FileSystem::storeExtents(Inode &inode, const std::vector<Extent> &extents)
+    {
+        // 1. Reject files with more extents than the direct, indirect and double-indirect slots can address
+        // 2. Copy the first extents into the inode
+        // 3. Spill the next ones into the indirect block
+        // 4. Spill the rest into extent blocks listed by the double-indirect block
+        // 5. If a pointer block cannot be allocated, free the ones already taken and rethrow
+        size_t perBlock = extentsPerBlock();
+        size_t capacity = Inode::MAX_DIRECT_EXTENTS + perBlock + pointersPerBlock() * perBlock;
+        if (extents.size() > capacity) {
+            return false;
+        }
+
+        size_t direct = std::min(extents.size(), Inode::MAX_DIRECT_EXTENTS);
+        std::copy(extents.begin(), extents.begin() + direct, inode.directExtents);
+
+        std::vector<unsigned int> pointerBlocks;
+        auto writeExtentBlock = [&](size_t first) {
+            unsigned int block = blockManager.allocateBlock();
+            pointerBlocks.push_back(block);
+            size_t count = std::min(perBlock, extents.size() - first);
+            blockManager.writeBlock(block, std::string(reinterpret_cast<const char *>(&extents[first]), count * sizeof(Extent)));
+            return block;
+        };
+
+        try
+        {
+            size_t next = direct;
+            if (next < extents.size()) {
+                inode.indirectBlock = writeExtentBlock(next);
+                next += perBlock;
+            }
+            if (next < extents.size()) {
+                unsigned int doubleIndirect = blockManager.allocateBlock();
+                pointerBlocks.push_back(doubleIndirect);
+                std::string pointers;
+                for (; next < extents.size(); next += perBlock) {
+                    uint32_t block = writeExtentBlock(next);
+                    pointers.append(reinterpret_cast<const char *>(&block), sizeof(block));
+                }
+                blockManager.writeBlock(doubleIndirect, pointers);
+                inode.doubleIndirectBlock = doubleIndirect;
+            }
+        }
+        catch(const cse4733::NoFreeBlockAvailableException &e)
+        {
+            for (unsigned int block: pointerBlocks) {
+                blockManager.freeBlock(block);
+            }
+            inode.indirectBlock = Inode::NO_BLOCK;
+            inode.doubleIndirectBlock = Inode::NO_BLOCK;
+            throw;
+        }
+
+        inode.extentCount = static_cast<uint32_t>(extents.size());
+        return true;
+    }
+
+    void FileSystem::releaseExtents(Inode &inode)
+    {
+        // Free every data extent, then the pointer blocks that listed them
+        for (const Extent &extent: loadExtents(inode)) {
+            blockManager.freeExtent(extent);
+        }
+        releasePointerBlocks(inode);
+    }
+
+    void FileSystem::releasePointerBlocks(Inode &inode)
+    {
+        // 1. Free the extent blocks named by the double-indirect block, then the pointer blocks themselves;
+        //    an inline file has none, its pointer fields hold data
+        // 2. Clear the inode's extent fields and inline data
+        if (inode.isInline()) {
+            inode.flags &= ~Inode::FLAG_INLINE;
+        } else {
+            if (inode.doubleIndirectBlock != Inode::NO_BLOCK) {
+                size_t spilled = inode.extentCount - Inode::MAX_DIRECT_EXTENTS - extentsPerBlock();
+                size_t blocks = (spilled + extentsPerBlock() - 1) / extentsPerBlock();
+                std::string raw = blockManager.readBlock(inode.doubleIndirectBlock);
+                for (size_t i = 0; i < blocks; i++) {
+                    uint32_t block;
+                    std::memcpy(&block, raw.data() + i * sizeof(uint32_t), sizeof(uint32_t));
+                    blockManager.freeBlock(block);
+                }
+                blockManager.freeBlock(inode.doubleIndirectBlock);
+            }
+            if (inode.indirectBlock != Inode::NO_BLOCK) {
+                blockManager.freeBlock(inode.indirectBlock);
+            }
+        }
+        inode.extentCount = 0;
+        inode.indirectBlock = Inode::NO_BLOCK;
+        inode.doubleIndirectBlock = Inode::NO_BLOCK;
+    }
+
+    bool FileSystem::replaceExtents(Inode &inode, const std::vector<Extent> &extents)
+    {
+        // 1. Record the new extents in a copy of the inode, so the old pointer blocks stay intact until this succeeds
+        // 2. Free the old pointer blocks and install the copy's extent fields
+        Inode updated = inode;
+        updated.extentCount = 0;
+        updated.indirectBlock = Inode::NO_BLOCK;
+        updated.doubleIndirectBlock = Inode::NO_BLOCK;
+        bool stored = false;
+        try
+        {
+            stored = storeExtents(updated, extents);
+        }
+        catch(const cse4733::NoFreeBlockAvailableException &e)
+        {
+            stored = false;
+        }
+        if (!stored) {
+            return false;
+        }
+
+        releasePointerBlocks(inode);
+        inode.extentCount = updated.extentCount;
+        std::copy(updated.directExtents, updated.directExtents + Inode::MAX_DIRECT_EXTENTS, inode.directExtents);
+        inode.indirectBlock = updated.indirectBlock;
+        inode.doubleIndirectBlock = updated.doubleIndirectBlock;
+        return true;
+    }
+
+    bool FileSystem::resizeExtents(Inode &inode, std::vector<Extent> &extents, size_t newSize)
+    {
+        // 1. Compare the blocks the file owns with the blocks newSize needs
+        // 2. To grow, extend the last extent in place, then allocate new extents for the rest
+        // 3. To shrink, keep the leading blocks and set aside everything after them
+        // 4. Rewrite the inode's extent records, rolling back the growth if that fails
+        // 5. Free the blocks set aside, now that the inode no longer lists them
+        size_t owned = 0;
+        for (const Extent &extent: extents) {
+            owned += extent.length;
+        }
+        size_t needed = (newSize + blockSize - 1) / blockSize;
+        if (needed == owned) {
+            return true;
+        }
+
+        std::vector<Extent> previous = extents;
+        std::vector<Extent> added;
+        std::vector<Extent> removed;
+        if (needed > owned) {
+            size_t missing = needed - owned;
+            if (!extents.empty()) {
+                Extent &last = extents.back();
+                uint32_t oldEnd = last.start + last.length;
+                size_t taken = blockManager.extendExtent(last, missing);
+                if (taken > 0) {
+                    added.push_back(Extent{oldEnd, static_cast<uint32_t>(taken)});
+                    missing -= taken;
+                }
+            }
+            if (missing > 0) {
+                try
+                {
+                    for (const Extent &extent: blockManager.allocateExtents(missing)) {
+                        added.push_back(extent);
+                        if (!extents.empty() && extents.back().start + extents.back().length == extent.start) {
+                            extents.back().length += extent.length;
+                        } else {
+                            extents.push_back(extent);
+                        }
+                    }
+                }
+                catch(const cse4733::NoFreeBlockAvailableException &e)
+                {
+                    for (const Extent &extent: added) {
+                        blockManager.freeExtent(extent);
+                    }
+                    extents = previous;
+                    return false;
+                }
+            }
+        } else {
+            size_t keep = needed;
+            std::vector<Extent> kept;
+            for (const Extent &extent: extents) {
+                if (keep >= extent.length) {
+                    kept.push_back(extent);
+                    keep -= extent.length;
+                } else {
+                    if (keep > 0) {
+                        kept.push_back(Extent{extent.start, static_cast<uint32_t>(keep)});
+                    }
+                    removed.push_back(Extent{extent.start + static_cast<uint32_t>(keep), extent.length - static_cast<uint32_t>(keep)});
+                    keep = 0;
+                }
+            }
+            extents = kept;
+        }
+
+        if (!replaceExtents(inode, extents)) {
+            for (const Extent &extent: added) {
+                blockManager.freeExtent(extent);
+            }
+            extents = previous;
+            return false;
+        }
+        for (const Extent &extent: removed) {
+            blockManager.freeExtent(extent);
+        }
+        return true;
+    }
+
+    bool FileSystem::unshareRange(Inode &inode, std::vector<Extent> &extents, size_t offset, size_t size)
+    {
+        // 1. Split the extents into runs of blocks that are, or are not, shared and inside the range
+        // 2. Allocate a private copy of each shared run and copy its blocks over
+        // 3. Rewrite the inode's extent records, rolling back the copies if that fails
+        // 4. Drop this file's reference to the runs that were copied
+        if (size == 0) {
+            return true;
+        }
+        size_t firstBlock = offset / blockSize;
+        size_t lastBlock = (offset + size - 1) / blockSize;
+
+        std::vector<Extent> updated;
+        std::vector<Extent> copied;
+        std::vector<Extent> copies;
+        auto append = [&updated](const Extent &extent) {
+            if (!updated.empty() && updated.back().start + updated.back().length == extent.start) {
+                updated.back().length += extent.length;
+            } else {
+                updated.push_back(extent);
+            }
+        };
+        auto mustCopy = [&](size_t fileBlock, uint32_t block) {
+            return fileBlock >= firstBlock && fileBlock <= lastBlock && blockManager.getReferenceCount(block) > 1;
+        };
+
+        size_t fileBlock = 0;
+        try
+        {
+            for (const Extent &extent: extents) {
+                if (fileBlock + extent.length <= firstBlock || fileBlock > lastBlock) {
+                    append(extent);
+                    fileBlock += extent.length;
+                    continue;
+                }
+                // Deduplication must not share these blocks between the check below and the write
+                blockManager.unindexExtent(extent);
+                uint32_t i = 0;
+                while (i < extent.length) {
+                    bool copy = mustCopy(fileBlock + i, extent.start + i);
+                    uint32_t run = 1;
+                    while (i + run < extent.length && mustCopy(fileBlock + i + run, extent.start + i + run) == copy) {
+                        run++;
+                    }
+                    Extent part{extent.start + i, run};
+                    if (copy) {
+                        copied.push_back(part);
+                        uint32_t from = part.start;
+                        for (const Extent &fresh: blockManager.allocateExtents(run)) {
+                            copies.push_back(fresh);
+                            blockManager.copyExtent(Extent{from, fresh.length}, fresh.start);
+                            from += fresh.length;
+                            append(fresh);
+                        }
+                    } else {
+                        append(part);
+                    }
+                    i += run;
+                }
+                fileBlock += extent.length;
+            }
+        }
+        catch(const cse4733::NoFreeBlockAvailableException &e)
+        {
+            for (const Extent &extent: copies) {
+                blockManager.freeExtent(extent);
+            }
+            return false;
+        }
+        if (copied.empty()) {
+            return true;
+        }
+
+        if (!replaceExtents(inode, updated)) {
+            for (const Extent &extent: copies) {
+                blockManager.freeExtent(extent);
+            }
+            return false;
+        }
+        for (const Extent &extent: copied) {
+            blockManager.freeExtent(extent);
+        }
+        extents = updated;
+        return true;
+    }
+
+    void FileSystem::writeRange(const std::vector<Extent> &extents, size_t offset, const char *data, size_t size)
+    {
+        // Copy the overlapping part of the range into each extent it touches
+        size_t end = offset + size;
+        size_t position = 0;
+        for (const Extent &extent: extents) {
+            if (position >= end) {
+                break;
+            }
+            size_t extentBytes = static_cast<size_t>(extent.length) * blockSize;
+            if (offset < position + extentBytes) {
+                size_t from = std::max(offset, position);
+                size_t to = std::min(end, position + extentBytes);
+                blockManager.writeExtentAt(extent, from - position, data + (from - offset), to - from);
+            }
+            position += extentBytes;
+        }
+    }
+
+    size_t FileSystem::extentsPerBlock() const
+    {
+        return blockSize / sizeof(Extent);
+    }
+
+    size_t FileSystem::pointersPerBlock() const
+    {
+        return blockSize / sizeof(uint32_t);
+    }
+
+    void FileSystem::registerCodec(std::shared_ptr<const Codec> codec)
+    {
+        VolumeGuard guard(*this, true);
+        codecs[codec->getId()] = std::move(codec);
+    }
+
+    bool FileSystem::setCompression(bool enabled, uint8_t codecId)
+    {
+        VolumeGuard guard(*this, true);
+        if (codecs.find(codecId) == codecs.end()) {
+            return false;
+        }
+        compression = enabled;
+        compressionCodec = codecId;
+        return true;
+    }
+
+    bool FileSystem::isCompressing() const
+    {
+        VolumeGuard guard(*this, false);
+        return compression;
+    }
+
+    bool FileSystem::setFileCompression(const std::string &filename, CompressionPreference preference)
+    {
+        VolumeGuard guard(*this, false);
+        if (!isFormatted) {
+            throw UnformattedFilesystemException();
+        }
+
+        // Rewrite the file under the new preference, restoring the old one if that fails
+        std::unique_lock<std::shared_mutex> lock;
+        Inode &inode = lockFile(filename, lock);
+        uint32_t previous = inode.flags;
+        inode.flags &= ~(Inode::FLAG_COMPRESS | Inode::FLAG_NO_COMPRESS);
+        if (preference == CompressionPreference::Always) {
+            inode.flags |= Inode::FLAG_COMPRESS;
+        } else if (preference == CompressionPreference::Never) {
+            inode.flags |= Inode::FLAG_NO_COMPRESS;
+        }
+        if (!replaceFileData(inode, readDataFromBlocks(inode))) {
+            inode.flags = previous;
+            return false;
+        }
+        logRecord(Journal::RecordType::SetCompression, filename, static_cast<uint64_t>(preference));
+        return true;
+    }
+
+    bool FileSystem::isCompressed(const std::string &filename)
+    {
+        VolumeGuard guard(*this, false);
+        if (!isFormatted) {
+            throw UnformattedFilesystemException();
+        }
+
+        std::shared_lock<std::shared_mutex> lock;
+        return (lockFile(filename, lock).flags & Inode::FLAG_COMPRESSED) != 0;
+    }
+
+    void FileSystem::setDeduplication(bool enabled)
+    {
+        VolumeGuard guard(*this, true);
+        deduplication = enabled;
+    }
+
+    bool FileSystem::isDeduplicating() const
+    {
+        VolumeGuard guard(*this, false);
+        return deduplication;
+    }
+
+    DedupStats FileSystem::getDedupStats() const
+    {
+        VolumeGuard guard(*this, false);
+        return blockManager.getDedupStats();
+    }
+
+    void FileSystem::setBlockStore(BlockStoreFactory factory, size_t cacheBytes)
+    {
+        VolumeGuard guard(*this, true);
+        blockStoreFactory = std::move(factory);
+        blockCacheBytes = cacheBytes;
+    }
+
+    CacheStats FileSystem::getCacheStats() const
+    {
+        VolumeGuard guard(*this, false);
+        return blockManager.getCacheStats();
+    }
+
+    void FileSystem::setReadahead(size_t blocks)
+    {
+        VolumeGuard guard(*this, true);
+        readaheadBlocks = blocks;
+    }
+
+    size_t FileSystem::getReadahead() const
+    {
+        VolumeGuard guard(*this, false);
+        return readaheadBlocks;
+    }
+
+    void FileSystem::setChecksumVerification(bool enabled)
+    {
+        VolumeGuard guard(*this, true);
+        checksumVerification = enabled;
+        blockManager.setVerifyOnRead(enabled);
+    }
+
+    bool FileSystem::isVerifyingChecksums() const
+    {
+        VolumeGuard guard(*this, false);
+        return checksumVerification;
+    }
+
+    ScrubResult FileSystem::scrub(size_t maxBlocks)
+    {
+        // Blocks are verified while no file can be mid-write
+        VolumeGuard guard(*this, true);
+        if (!isFormatted) {
+            throw UnformattedFilesystemException();
+        }
+        return blockManager.scrub(maxBlocks);
+    }
+
+    size_t FileSystem::getFreeBlockCount() const
+    {
+        VolumeGuard guard(*this, false);
+        return blockManager.getFreeBlockCount(); // Retrieve the count of free blocks from BlockManager
+    }
+
+    size_t FileSystem::getTotalBlockCount() const
+    {
+        VolumeGuard guard(*this, false);
+        return blockManager.getTotalBlocks(); // Retrieve the total count of blocks from BlockManager
+    }
+
+    size_t FileSystem::getFreeInodeCount() const
+    {
+        VolumeGuard guard(*this, false);
+        std::lock_guard<std::mutex> lock(inodeTableMutex);
+        return inodeTable.getFreeCount();
+    }
+
+    size_t FileSystem::getTotalInodeCount() const
+    {
+        VolumeGuard guard(*this, false);
+        return inodeTable.size();
     }
 
 } // namespace cse4733
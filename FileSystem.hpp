@@ -1,12 +1,36 @@
 #ifndef FILESYSTEM_HPP
 #define FILESYSTEM_HPP
 
+#include <atomic>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <thread>
+#include <unordered_set>
 #include <vector>
 
+#include "BatchOperation.hpp"
+#include "DentryCache.hpp"
+#include "DiskImage.hpp"
+#include "EpochReclaimer.hpp"
+#include "Journal.hpp"
+#include "Result.hpp"
 #include "Inode.hpp"
+#include "InodeTable.hpp"
 #include "BlockManager.hpp"
+#include "Codec.hpp"
 #include "Directory.hpp"
+#include "LockStripes.hpp"
+#include "LzCodec.hpp"
+#include "ReadaheadTracker.hpp"
+#include "Snapshot.hpp"
+#include "TaskExecutor.hpp"
 
 /**
  * @namespace cse4733
@@ -15,9 +39,64 @@
 namespace cse4733
 {
 
+    /**
+     * @brief Whether one file is compressed, overriding the volume setting.
+     */
+    enum class CompressionPreference
+    {
+        /* Follow FileSystem::setCompression. */
+        Volume,
+
+        /* Compress whenever that saves blocks. */
+        Always,
+
+        /* Store the file uncompressed. */
+        Never
+    };
+
     /**
      * @class FileSystem
      * @brief Manages files, directories, and block allocations within the filesystem.
+     *
+     * Every operation takes a path. Paths starting with '/' are resolved from the
+     * root directory, all others from the current directory; "." and ".." are
+     * supported in any position.
+     *
+     * The filesystem lives in memory until an image is created or mounted; from then
+     * on blocks and inodes live in the memory-mapped image file and directories are
+     * stored in their inodes' blocks, so the volume survives a restart.
+     *
+     * Files can be cloned and the whole namespace snapshotted without copying data:
+     * clones and snapshots share data blocks through per-block reference counts, and
+     * a shared block is copied the first time one of its owners writes to it.
+     *
+     * File data can be compressed with a pluggable Codec, for the whole volume or per
+     * file. A file is compressed as a whole and only when that saves at least one
+     * block; writing part of a compressed file decompresses and rewrites all of it.
+     *
+     * Files of at most Inode::MAX_INLINE_SIZE bytes are stored inline in their inode
+     * and own no blocks. Like compressed files they are rewritten as a whole, which
+     * moves a file to blocks once it grows past that size.
+     *
+     * Every completed change can also be logged to a journal, whose records are
+     * committed in groups. A mounted image always journals to "<image>.journal"; the
+     * journal is emptied each time the image is synced and replayed when an image
+     * that was not unmounted cleanly is mounted again. Changes only reach the image
+     * file at a sync, whose checkpoint is logged to the journal before the file is
+     * overwritten, so a crash never leaves a torn image. A full group is committed on
+     * the thread pool, so writers never wait for its fsync under a lock.
+     *
+     * Every public method may be called from several threads at once. File reads
+     * share their inode's lock, so reads of the same or different files run in
+     * parallel; writes to one file hold its inode lock exclusively. Path lookups take
+     * no directory lock at all. Creating or removing an entry locks only its parent
+     * directory, and removing a file also its inode, so deletes, rmdir, cd, clones and
+     * snapshots run alongside everything else. Locks are taken in one order: parent
+     * directories before their children, directories before inodes. Only operations
+     * that replace the volume or change how all of it is stored (format, mount,
+     * unmount, sync and the settings) wait for every other operation and run alone.
+     * Views returned by readSegments are only stable while no other thread writes or
+     * deletes the file.
      */
     class FileSystem
     {
@@ -27,11 +106,12 @@ namespace cse4733
          *
          * @param diskSize The total size of the simulated disk.
          * @param blockSize The size of each block.
+         * @param policy The block allocation policy, kept across format().
          */
-        FileSystem(size_t diskSize, size_t blockSize);
+        FileSystem(size_t diskSize, size_t blockSize, AllocationPolicy policy = AllocationPolicy::BestFit);
 
         /**
-         * @brief Destructor to clean up resources.
+         * @brief Destructor to clean up resources. A mounted image is unmounted first.
          */
         ~FileSystem();
 
@@ -47,12 +127,460 @@ namespace cse4733
         /// Reads and returns the content of the specified file.
         std::string readFile(const std::string &filename);
 
-        /// Lists all files in the root directory.
+        /**
+         * @brief Creates a file like createFile, reporting every expected failure instead of throwing.
+         *
+         * @return ErrorCode::Ok, or why the file was not created.
+         */
+        ErrorCode tryCreateFile(const std::string &filename);
+
+        /**
+         * @brief Deletes a file like deleteFile, reporting every expected failure instead of throwing.
+         *
+         * @return ErrorCode::Ok, or why the file was not deleted.
+         */
+        ErrorCode tryDeleteFile(const std::string &filename);
+
+        /**
+         * @brief Replaces a file's content like writeFile, reporting every expected failure instead of throwing.
+         *
+         * @return ErrorCode::Ok, or why the file was not written; after ErrorCode::NoSpace the file is empty.
+         */
+        ErrorCode tryWriteFile(const std::string &filename, const std::string &data);
+
+        /**
+         * @brief Reads a whole file like readFile, reporting every expected failure instead of throwing.
+         *
+         * A missing file is ErrorCode::NotFound rather than empty content, so probes can
+         * tell the two apart without an exception on the miss path.
+         *
+         * @return The file's content, or why it could not be read.
+         * @throw CorruptDataException if the data fails its checksum or does not decompress.
+         */
+        Result<std::string> tryReadFile(const std::string &filename);
+
+        /**
+         * @brief Reads part of a file.
+         *
+         * @param filename The path of the file to read.
+         * @param offset The byte offset to start reading at.
+         * @param length The maximum number of bytes to read.
+         * @return The bytes read, which stop early at the end of the file; empty if the file does not exist.
+         */
+        std::string readFile(const std::string &filename, size_t offset, size_t length);
+
+        /**
+         * @brief Writes data at a byte offset, touching only the blocks in that range.
+         *
+         * The file's existing blocks are reused; blocks are only allocated when the write
+         * extends the file, first by growing the last extent in place. Writing past the end
+         * of the file fills the gap with zero bytes.
+         *
+         * @param filename The path of the file to write.
+         * @param offset The byte offset to start writing at.
+         * @param data The data to write.
+         * @return True on success, false if not enough blocks are free; the file is unchanged on failure.
+         */
+        bool writeFile(const std::string &filename, size_t offset, const std::string &data);
+
+        /**
+         * @brief Appends data to the end of a file.
+         *
+         * @param filename The path of the file to append to.
+         * @param data The data to append.
+         * @return True on success, false if not enough blocks are free.
+         */
+        bool appendFile(const std::string &filename, const std::string &data);
+
+        /**
+         * @brief Shrinks or extends a file to an exact size.
+         *
+         * Blocks past the new end are freed; extending fills the new bytes with zeros.
+         *
+         * @param filename The path of the file to resize.
+         * @param size The new size in bytes.
+         * @return True on success, false if not enough blocks are free to extend the file.
+         */
+        bool truncateFile(const std::string &filename, size_t size);
+
+        /**
+         * @brief Returns the content of a file as views directly into block storage, without copying.
+         *
+         * Physically adjacent extents are merged into one segment. Compressed files, and
+         * every file while blocks live in a block store, are returned as one segment of a
+         * copy made on first read. The views stay valid until the file is next written or
+         * deleted, or the filesystem is formatted.
+         *
+         * @param filename The path of the file to read.
+         * @return The file's content as a sequence of segments, in file order.
+         * @throw FileMissingException if the file does not exist.
+         * @throw IsADirectoryException if the path names a directory.
+         */
+        std::vector<std::string_view> readSegments(const std::string &filename);
+
+        /**
+         * @brief Copies the content of a file into a caller-supplied buffer with a single copy per segment.
+         *
+         * @param filename The path of the file to read.
+         * @param buffer The buffer to copy into.
+         * @param capacity The size of the buffer in bytes.
+         * @return The number of bytes copied: the smaller of the file size and capacity.
+         * @throw FileMissingException if the file does not exist.
+         * @throw IsADirectoryException if the path names a directory.
+         */
+        size_t readInto(const std::string &filename, char *buffer, size_t capacity);
+
+        /**
+         * @brief Reads a whole file on the internal thread pool.
+         *
+         * Files longer than ASYNC_CHUNK_BLOCKS blocks are split into block ranges that
+         * separate tasks copy straight into the result in parallel; compressed files are
+         * read by a single task. The ranges are read independently, so a write that runs
+         * at the same time may be seen by some of them and not others.
+         *
+         * @param filename The path of the file to read.
+         * @return A future for the content, which is empty if the file does not exist, as with
+         *         readFile. It holds the exception instead if the read fails.
+         */
+        std::future<std::string> readAsync(const std::string &filename);
+
+        /**
+         * @brief Replaces the content of a file on the internal thread pool.
+         *
+         * Writers hold the file's lock exclusively, so each write runs as one task;
+         * writes to different files run in parallel.
+         *
+         * @return A future for writeFile's result, or the exception it threw.
+         */
+        std::future<bool> writeAsync(const std::string &filename, std::string data);
+
+        /**
+         * @brief Writes data at a byte offset on the internal thread pool.
+         *
+         * @return A future for writeFile's result, or the exception it threw.
+         */
+        std::future<bool> writeAsync(const std::string &filename, size_t offset, std::string data);
+
+        /**
+         * @brief Returns the number of threads in the async pool, which is started by the first async call.
+         */
+        size_t getAsyncThreadCount() const;
+
+        /**
+         * @brief Runs a list of create, write, read and delete operations in one pass.
+         *
+         * The operations run in order, each with the same effect and journal record as the
+         * matching single call, but the volume is entered and its format checked once, each
+         * parent directory is resolved once, and the blocks for every write are reserved
+         * with one allocation up front; a write the reservation cannot cover allocates its
+         * own blocks. Expected failures are reported per operation instead of thrown, with
+         * the status the matching try* call returns. Each operation takes the same locks as
+         * its single call, so other threads can run between and alongside them.
+         *
+         * @param operations The operations to run.
+         * @return One result per operation, in the same order.
+         * @throw UnformattedFilesystemException if the filesystem has not been formatted.
+         */
+        std::vector<BatchResult> runBatch(const std::vector<BatchOperation> &operations);
+
+        /**
+         * @brief Creates a file that shares every data block of an existing file instead of copying it.
+         *
+         * The two files diverge block by block as either is written.
+         *
+         * @param source The path of the file to clone.
+         * @param destination The path of the new file.
+         * @return True on success, false if no inode or pointer block is available.
+         * @throw FileMissingException if the source does not exist.
+         * @throw IsADirectoryException if the source is a directory.
+         * @throw FileAlreadyExistsException if the destination already exists.
+         */
+        bool cloneFile(const std::string &source, const std::string &destination);
+
+        /**
+         * @brief Takes a read-only view of every directory and file.
+         *
+         * Only directory entries and extent lists are copied; file data is shared with
+         * the live filesystem until either side changes it. Each directory and each file
+         * is copied as it was at one moment, under its own lock, so changes other threads
+         * make during the snapshot may or may not be in it; a snapshot taken while no
+         * other thread changes the tree is point-in-time. Snapshots are kept in memory
+         * and are discarded when the filesystem is formatted, mounted or unmounted.
+         *
+         * @return The id of the new snapshot.
+         */
+        unsigned int snapshot();
+
+        /**
+         * @brief Reads a file as it was when a snapshot was taken.
+         *
+         * @param snapshotId The id returned by snapshot().
+         * @param filename The path of the file, resolved against the current directory's path.
+         * @return The file's content.
+         * @throw SnapshotMissingException if there is no such snapshot.
+         * @throw FileMissingException if the file did not exist.
+         * @throw IsADirectoryException if the path named a directory.
+         */
+        std::string readSnapshotFile(unsigned int snapshotId, const std::string &filename);
+
+        /**
+         * @brief Lists a directory as it was when a snapshot was taken, in sorted order.
+         *
+         * @throw SnapshotMissingException if there is no such snapshot.
+         * @throw FileMissingException if the directory did not exist.
+         * @throw NotADirectoryException if the path named a regular file.
+         */
+        std::vector<std::string> listSnapshotFiles(unsigned int snapshotId, const std::string &path);
+
+        /**
+         * @brief Discards a snapshot and releases its references to shared blocks.
+         *
+         * @return True if the snapshot existed.
+         */
+        bool deleteSnapshot(unsigned int snapshotId);
+
+        /// Returns the ids of every snapshot, oldest first.
+        std::vector<unsigned int> listSnapshots() const;
+
+        /// Lists all entries in the current directory.
         std::vector<std::string> listFiles();
 
-        /// Initializes or reformats the filesystem.
+        /// Lists all entries in the directory at the specified path.
+        std::vector<std::string> listFiles(const std::string &path);
+
+        /**
+         * @brief Lists one page of a directory's entries in sorted order.
+         *
+         * @param path The path of the directory to list.
+         * @param cursor The last name of the previous page, or empty for the first page.
+         * @param limit The maximum number of names to return.
+         * @param prefix Only names beginning with this prefix are returned.
+         * @return Up to limit names; fewer than limit means the listing is complete.
+         */
+        std::vector<std::string> listFiles(const std::string &path, const std::string &cursor, size_t limit, const std::string &prefix = "");
+
+        /**
+         * @brief Creates a new, empty directory.
+         *
+         * @param path The path of the directory to create.
+         * @return True if the directory was created, false if no inode is available.
+         * @throw FileAlreadyExistsException if an entry with that name already exists.
+         * @throw NotADirectoryException if a component of the parent path is not a directory.
+         */
+        bool makeDirectory(const std::string &path);
+
+        /**
+         * @brief Removes an empty directory.
+         *
+         * @param path The path of the directory to remove.
+         * @return True if the directory was removed, false if it does not exist or is the current directory.
+         * @throw NotADirectoryException if the path names a regular file.
+         * @throw DirectoryNotEmptyException if the directory still has entries.
+         */
+        bool removeDirectory(const std::string &path);
+
+        /**
+         * @brief Changes the current directory.
+         *
+         * @param path The path of the new current directory.
+         * @throw FileMissingException if the path does not exist.
+         * @throw NotADirectoryException if the path names a regular file.
+         */
+        void changeDirectory(const std::string &path);
+
+        /// Returns the absolute path of the current directory.
+        std::string getCurrentDirectory() const;
+
+        /// Checks whether the specified path exists and is a directory.
+        bool isDirectory(const std::string &path);
+
+        /// Initializes or reformats the filesystem. A mounted image is reformatted in place.
         bool format();
 
+        /**
+         * @brief Creates a formatted image file with this filesystem's geometry and mounts it.
+         *
+         * Any image already mounted is unmounted first.
+         *
+         * @param path The path of the image file. An existing file is overwritten.
+         * @throw DiskImageException if the image cannot be created.
+         */
+        void createImage(const std::string &path);
+
+        /**
+         * @brief Mounts an existing image file, adopting its block size, block count and allocation policy.
+         *
+         * Mounting only maps the file. Directories are read from the image the first time
+         * they are used, and the allocator's free-run index is rebuilt on the first
+         * allocation. If the image was not unmounted cleanly, inodes and blocks that the
+         * directories stored at the last sync do not reach are freed, the image's journal
+         * is replayed on top and the result is synced. A checkpoint that a crash interrupted
+         * is finished from the journal before the image is mapped.
+         *
+         * @param path The path of the image file.
+         * @throw DiskImageException if the file cannot be mapped or is not a filesystem image.
+         */
+        void mount(const std::string &path);
+
+        /**
+         * @brief Makes every change so far durable.
+         *
+         * With an image mounted, modified directories and the superblock counters are
+         * written to the image, which is checkpointed to its file and the journal is
+         * emptied. If a directory cannot be stored, the pending journal records are
+         * committed instead and the file keeps its last checkpoint.
+         * Otherwise dirty cached blocks are written to the block store and pending
+         * journal records are committed.
+         *
+         * @return True on success; false if there is no image, journal or block store, or a directory could not be stored for lack of free blocks.
+         */
+        bool sync();
+
+        /**
+         * @brief Syncs the image, marks it cleanly unmounted and unmaps it, leaving an unformatted
+         * in-memory filesystem of the same geometry.
+         *
+         * @return True if an image was mounted.
+         */
+        bool unmount();
+
+        /// Checks whether a disk image is mounted.
+        bool isMounted() const;
+
+        /**
+         * @brief Opens a journal file, replays the operations it holds and logs every later change to it.
+         *
+         * This makes the in-memory filesystem durable: starting a new filesystem and
+         * opening the same journal rebuilds the same state. Formatting empties the journal.
+         * A mounted image replaces this journal with its own.
+         *
+         * @param path The path of the journal file. It is created if it does not exist.
+         * @param groupSize The number of operations committed together with one fsync.
+         * @throw JournalException if the journal cannot be opened or read.
+         */
+        void openJournal(const std::string &path, size_t groupSize = Journal::DEFAULT_GROUP_SIZE);
+
+        /// Checks whether changes are being journaled.
+        bool isJournaling() const;
+
+        /// Returns the number of journal records committed since the journal was opened.
+        size_t getJournalRecordCount() const;
+
+        /// Returns the number of journal commits, one fsync each, since the journal was opened.
+        size_t getJournalCommitCount() const;
+
+        /**
+         * @brief Turns content-addressed deduplication of whole-file writes on or off.
+         *
+         * While it is on, writeFile stores each block through BlockManager::storeBlock, so
+         * a block identical to one already written this way is shared instead of stored
+         * again. The setting is kept across format() and mount(); the fingerprint index
+         * is kept in memory and starts empty whenever the block manager is recreated.
+         */
+        void setDeduplication(bool enabled);
+
+        /**
+         * @brief Makes a codec available for compression and for reading data it compressed.
+         *
+         * The built-in LzCodec is always registered. A codec with the same id replaces the previous one.
+         */
+        void registerCodec(std::shared_ptr<const Codec> codec);
+
+        /**
+         * @brief Turns compression of the whole volume on or off.
+         *
+         * Files are compressed when they are next written as a whole, or when their
+         * preference is set with setFileCompression. The setting is kept across format() and mount().
+         *
+         * @param enabled Whether files that follow the volume setting are compressed.
+         * @param codecId The codec new compressed data is written with, also for files set to CompressionPreference::Always.
+         * @return False if no codec with that id is registered; nothing changes then.
+         */
+        bool setCompression(bool enabled, uint8_t codecId = LzCodec::ID);
+
+        /// Checks whether files that follow the volume setting are compressed.
+        bool isCompressing() const;
+
+        /**
+         * @brief Sets whether one file is compressed and rewrites it accordingly.
+         *
+         * @param filename The path of the file.
+         * @param preference Whether the file follows the volume setting, is always compressed or never is.
+         * @return True on success, false if not enough blocks are free to rewrite the file; the file is unchanged then.
+         * @throw FileMissingException if the file does not exist.
+         * @throw IsADirectoryException if the path names a directory.
+         */
+        bool setFileCompression(const std::string &filename, CompressionPreference preference);
+
+        /// Checks whether a file's data is currently stored compressed.
+        bool isCompressed(const std::string &filename);
+
+        /// Checks whether whole-file writes are deduplicated.
+        bool isDeduplicating() const;
+
+        /// Returns the deduplication counters of the current block manager.
+        DedupStats getDedupStats() const;
+
+        /**
+         * @brief Creates the store an in-memory volume keeps its block contents in, given its block count and size.
+         */
+        using BlockStoreFactory = std::function<std::unique_ptr<BlockStore>(size_t blockCount, size_t blockSize)>;
+
+        /**
+         * @brief Keeps the block contents of in-memory volumes in a block store behind a bounded cache, or in memory.
+         *
+         * With a store, only cacheBytes of block contents stay in memory, so the volume may be
+         * larger than RAM; metadata and directories stay in memory either way. Takes effect at
+         * the next format(); a mounted image always maps its blocks directly. The setting is
+         * kept across format() and mount().
+         *
+         * @param factory Creates the store of each new volume, or null to keep blocks in memory.
+         * @param cacheBytes The memory budget of the block cache.
+         */
+        void setBlockStore(BlockStoreFactory factory, size_t cacheBytes);
+
+        /// Returns the block cache counters of the current block manager, all zero while blocks are in memory.
+        CacheStats getCacheStats() const;
+
+        /**
+         * @brief Sets how far ahead sequential reads are prefetched while blocks live in a block store.
+         *
+         * A read by offset that continues where the previous read of the same file ended
+         * prefetches the blocks after it on the async thread pool, starting with a few
+         * blocks and doubling up to this many; whole-file reads prefetch one window ahead
+         * of the copy. The window is also capped at half of what one cache prefetch may
+         * load, about a quarter of the block cache.
+         *
+         * @param blocks The largest readahead window in blocks; 0 turns readahead off.
+         */
+        void setReadahead(size_t blocks);
+
+        /// Returns the largest readahead window in blocks.
+        size_t getReadahead() const;
+
+        /**
+         * @brief Turns verification of block checksums on every read on or off. It starts on.
+         *
+         * A block that fails verification makes the read throw CorruptDataException.
+         * Checksums are kept up to date regardless, and the setting is kept across format() and mount().
+         */
+        void setChecksumVerification(bool enabled);
+
+        /// Checks whether reads verify block checksums.
+        bool isVerifyingChecksums() const;
+
+        /**
+         * @brief Verifies the checksums of up to maxBlocks allocated blocks, continuing from the previous call.
+         *
+         * Meant to be called with a small budget whenever the filesystem is idle, so that
+         * every allocated block is eventually checked without stalling other operations.
+         *
+         * @param maxBlocks The maximum number of blocks to verify.
+         * @return The blocks checked, the corrupt blocks found and whether the pass finished.
+         * @throw UnformattedFilesystemException if the filesystem is not formatted.
+         */
+        ScrubResult scrub(size_t maxBlocks);
+
         /**
          * @brief Returns the number of free blocks.
          *
@@ -67,16 +595,214 @@ namespace cse4733
          */
         size_t getTotalBlockCount() const;
 
+        /**
+         * @brief Returns the number of inodes not in use.
+         */
+        size_t getFreeInodeCount() const;
+
+        /**
+         * @brief Returns the total number of inodes.
+         */
+        size_t getTotalInodeCount() const;
+
     private:
 
+        /// Inode index of the root directory, allocated first by format().
+        static constexpr unsigned int ROOT_INODE = 0;
+
         /**
-         * @brief Finds the inode index for a given filename.
+         * @brief Finds the inode index for a given path.
          * 
-         * @param filename The name of the file to look up.
-         * @return The inode index if the file exists, or -1 if it does not exist.
+         * @param filename The path of the file to look up.
+         * @return The inode index of the file.
+         * @throw FileMissingException if the file does not exist.
          */
         int findInode(const std::string &filename);
 
+        /**
+         * @brief Resolves a path to an inode index, one component at a time.
+         *
+         * @param path An absolute path, or a path relative to the current directory.
+         * @return The inode index the path refers to.
+         * @throw FileMissingException if a component does not exist.
+         * @throw NotADirectoryException if a non-final component is not a directory.
+         */
+        unsigned int resolvePath(const std::string &path);
+
+        /**
+         * @brief Resolves a path like resolvePath, without throwing.
+         *
+         * @return The inode index the path refers to, ErrorCode::NotFound or ErrorCode::NotADirectory.
+         */
+        Result<unsigned int> tryResolvePath(const std::string &path);
+
+        /**
+         * @brief Resolves a path like tryResolvePath and reports the last entry it looked up.
+         *
+         * @param parentInode Set to the directory holding the last entry looked up.
+         * @param name Set to that entry's name, or to an empty string if the path looked up none.
+         */
+        Result<unsigned int> tryResolveEntry(const std::string &path, unsigned int &parentInode, std::string &name);
+
+        /**
+         * @brief Resolves the directory that contains the final component of a path.
+         *
+         * @param path The path to split.
+         * @param name Set to the final component of the path.
+         * @param parent Set to the containing directory, as tryResolveDirectory returns it.
+         * @return The inode index of the containing directory.
+         * @throw IsADirectoryException if the final component is empty, "." or "..".
+         */
+        unsigned int resolveParent(const std::string &path, std::string &name, const Directory *&parent);
+
+        /**
+         * @brief Resolves the containing directory like resolveParent, without throwing.
+         *
+         * @return The inode index of the containing directory, ErrorCode::IsADirectory,
+         *         ErrorCode::NotFound or ErrorCode::NotADirectory.
+         */
+        Result<unsigned int> tryResolveParent(const std::string &path, std::string &name, const Directory *&parent);
+
+        /**
+         * @brief Resolves a path to a directory, making sure the entry that led to it still names it.
+         *
+         * A caller that later locks the directory compares findDirectory with the returned Directory
+         * under the lock: if they differ, the directory was removed since it was resolved, even if its
+         * inode now holds another directory.
+         *
+         * @param directory Set to the directory's Directory on success.
+         * @return The directory's inode index, ErrorCode::NotFound or ErrorCode::NotADirectory.
+         */
+        Result<unsigned int> tryResolveDirectory(const std::string &path, const Directory *&directory);
+
+        /**
+         * @brief Resolves a path to a directory like tryResolveDirectory and locks the directory for reading.
+         *
+         * @param lock Set to a shared hold on the directory's lock stripe.
+         * @param inodeIndex Set to the directory's inode index.
+         * @return The directory, whose entries stay unchanged until the lock is released.
+         * @throw FileMissingException if a component does not exist.
+         * @throw NotADirectoryException if the path does not name a directory.
+         */
+        const Directory &lockDirectory(const std::string &path, std::shared_lock<std::shared_mutex> &lock,
+                                       unsigned int &inodeIndex);
+
+        /**
+         * @brief Splits a path into the path of its parent directory and its final component.
+         *
+         * @param path The path to split; trailing slashes are ignored.
+         * @param parentPath Set to the parent's path, or to an empty string for the current directory.
+         * @param name Set to the final component of the path.
+         * @return False if the final component is empty, "." or "..".
+         */
+        static bool splitPath(const std::string &path, std::string &parentPath, std::string &name);
+
+        /**
+         * @brief Looks up one name inside a directory, consulting the dentry cache first.
+         *
+         * The directory is searched without locking it, so lookups never wait for entries being added.
+         *
+         * @param directoryInode The inode index of the directory to search.
+         * @param name The entry name; ".." yields the parent directory.
+         * @param path The full path being resolved, used in error messages.
+         * @return The inode index of the entry.
+         */
+        unsigned int lookup(unsigned int directoryInode, const std::string &name, const std::string &path);
+
+        /**
+         * @brief Looks up one name like lookup, without throwing. Misses are not cached.
+         *
+         * @return The inode index of the entry, ErrorCode::NotFound or ErrorCode::NotADirectory.
+         */
+        Result<unsigned int> tryLookup(unsigned int directoryInode, const std::string &name);
+
+        /**
+         * @brief Returns the Directory stored for a directory inode, loading it from the inode's blocks on first use.
+         *
+         * @throw NotADirectoryException if the inode is not a directory.
+         */
+        Directory &directoryFor(unsigned int inodeIndex, const std::string &path);
+
+        /**
+         * @brief Returns the Directory stored for a directory inode like directoryFor, or null if the inode is not a directory.
+         *
+         * The pointer stays valid until the caller's VolumeGuard ends, even if the directory is removed meanwhile.
+         */
+        Directory *findDirectory(unsigned int inodeIndex);
+
+        /**
+         * @brief Allocates an inode and links it into its parent directory.
+         *
+         * The parent stays locked on return, so the caller can finish setting up the new
+         * entry and journal it before any other thread can find it.
+         *
+         * @param path The path of the new entry.
+         * @param flags Extra inode flags, e.g. Inode::FLAG_DIRECTORY.
+         * @param parentInode Set to the inode index of the containing directory.
+         * @param parentLock Set to an exclusive hold on the parent directory's lock stripe.
+         * @return The inode index of the new entry.
+         * @throw NoAvailableInodeException if no inodes are available.
+         * @throw FileAlreadyExistsException if the entry already exists.
+         */
+        unsigned int addEntry(const std::string &path, uint32_t flags, unsigned int &parentInode,
+                              std::unique_lock<std::shared_mutex> &parentLock);
+
+        /**
+         * @brief Allocates an inode and links it into its parent directory like addEntry, without throwing.
+         *
+         * @return The inode index of the new entry, or why none was created.
+         */
+        Result<unsigned int> tryAddEntry(const std::string &path, uint32_t flags, unsigned int &parentInode,
+                                         std::unique_lock<std::shared_mutex> &parentLock);
+
+        /**
+         * @brief Allocates an inode and links it under a name into an already resolved directory.
+         *
+         * A new directory's Directory is stored before it is linked, so every thread that finds it also finds its entries.
+         *
+         * @param parentInode The inode index of the directory, which must be a directory.
+         * @param resolved The directory's Directory as tryResolveDirectory returned it.
+         * @param name The name of the new entry.
+         * @param flags Extra inode flags, e.g. Inode::FLAG_DIRECTORY.
+         * @param parentLock Set to an exclusive hold on the directory's lock stripe, unless the caller already holds one.
+         * @param prepare If given, fills in the new inode before it is linked; if it returns false, the inode
+         *        is released and nothing is linked.
+         * @return The inode index of the new entry, ErrorCode::AlreadyExists, ErrorCode::NoInode,
+         *         ErrorCode::NoSpace if prepare failed, or ErrorCode::NotFound if the directory was removed
+         *         since it was resolved.
+         */
+        Result<unsigned int> tryLinkEntry(unsigned int parentInode, const Directory *resolved, const std::string &name,
+                                          uint32_t flags, std::unique_lock<std::shared_mutex> &parentLock,
+                                          const std::function<bool(Inode &)> &prepare = nullptr);
+
+        /**
+         * @brief Removes a file's entry, frees its blocks and inode and journals the deletion.
+         *
+         * Locks the directory exclusively, then the file's inode, and removes the entry
+         * before the inode is freed.
+         *
+         * @param parentInode The inode index of the directory holding the file.
+         * @param resolved The directory's Directory as tryResolveDirectory returned it.
+         * @param name The file's name in that directory.
+         * @param path The path as given by the caller, for the journal.
+         * @return ErrorCode::Ok, ErrorCode::NotFound or ErrorCode::IsADirectory.
+         */
+        ErrorCode tryUnlinkFile(unsigned int parentInode, const Directory *resolved, const std::string &name,
+                                const std::string &path);
+
+        /**
+         * @brief Throws the exception the throwing API uses for an error code.
+         *
+         * @param error The error to raise; must not be ErrorCode::Ok.
+         * @param path The path or name to put in the exception's message.
+         */
+        [[noreturn]] static void throwError(ErrorCode error, const std::string &path);
+
+        /**
+         * @brief Joins a path onto the current directory and removes ".", ".." and empty components.
+         */
+        std::string normalizePath(const std::string &path) const;
+
         /**
          * @brief Allocates a new inode for a file.
          * 
@@ -86,6 +812,13 @@ namespace cse4733
          */
         unsigned int allocateInode();
 
+        /**
+         * @brief Allocates a new inode like allocateInode, without throwing.
+         *
+         * @return The index of the allocated inode, ErrorCode::NoInode or ErrorCode::Unformatted.
+         */
+        Result<unsigned int> tryAllocateInode();
+
         /**
          * @brief Releases an inode and its associated blocks.
          * 
@@ -94,20 +827,227 @@ namespace cse4733
          */
         void releaseInode(int inodeIndex);
 
+        /**
+         * @brief Allocates the root directory in a freshly formatted inode table and makes it current.
+         */
+        void createRoot();
+
+        /**
+         * @brief Records that a directory changed and must be written to the image on the next sync.
+         *
+         * Has no effect when no image is mounted.
+         */
+        void markDirty(unsigned int directoryInode);
+
+        /**
+         * @brief Writes one directory's entries into its inode's blocks.
+         *
+         * @return True on success, false if not enough blocks are free.
+         */
+        bool storeDirectory(unsigned int directoryInode);
+
+        /**
+         * @brief Rebuilds the inode and block allocation of a crashed image from its stored directory tree.
+         *
+         * Every inode reachable from the root, and every data and pointer block those
+         * inodes use, stays allocated with one reference per owning inode; everything
+         * else is freed. This returns the
+         * allocation to the last sync, so replaying the journal cannot hand out an inode
+         * that a stored directory still names.
+         */
+        void reclaimUnreachable();
+
+        /**
+         * @brief Logs a completed operation if a journal is open.
+         *
+         * @param type The operation.
+         * @param path The path as given by the caller; it is logged in absolute form.
+         * @param offset The write offset or new size, if the operation has one.
+         * @param data The bytes written, if any.
+         */
+        void logRecord(Journal::RecordType type, const std::string &path, uint64_t offset = 0, const std::string &data = std::string());
+
+        /**
+         * @brief Applies every record in the journal, without logging them again.
+         *
+         * @return The number of records read.
+         */
+        size_t replayJournal();
+
+        /**
+         * @brief Replaces the image-backed block manager and inode table with in-memory ones and unmaps the image.
+         */
+        void detachImage();
+
+        /**
+         * @brief Replaces the block manager with an empty one for an in-memory volume, in a block store if one is set.
+         */
+        void resetBlockManager();
+
+        /**
+         * @class VolumeGuard
+         * @brief Holds the volume lock for the duration of one public operation.
+         *
+         * Operations that only touch individual files and directories hold it shared;
+         * operations that replace the volume or change how all of it is stored hold it
+         * exclusively. A thread that already holds it exclusively passes straight through,
+         * so such operations can call other public operations, e.g. mount replaying the
+         * journal. Every guard also pins the reclamation epoch, so directories removed
+         * during the operation are not destroyed before it ends.
+         */
+        class VolumeGuard
+        {
+        public:
+            VolumeGuard(const FileSystem &fileSystem, bool exclusive);
+            ~VolumeGuard();
+
+            VolumeGuard(const VolumeGuard &) = delete;
+            VolumeGuard &operator=(const VolumeGuard &) = delete;
+
+        private:
+            /// The filesystem whose volume lock is held.
+            const FileSystem &fileSystem;
+
+            /// Keeps objects retired during the operation alive until it ends.
+            EpochReclaimer::Guard epoch;
+
+            /// How this guard holds the lock.
+            enum class Mode
+            {
+                None,
+                Shared,
+                Exclusive
+            } mode;
+        };
+
+        /// Volume-wide reader/writer lock, see VolumeGuard.
+        mutable std::shared_mutex volumeLock;
+
+        /// The thread holding volumeLock exclusively, or no thread.
+        mutable std::atomic<std::thread::id> volumeOwner{};
+
+        /// Reader/writer locks for file inodes: shared to read a file's data and size, exclusive to change them.
+        mutable LockStripes inodeLocks;
+
+        /// Reader/writer locks for directory entries, by directory inode: shared to list or enter, exclusive to add or
+        /// remove. Lookups need neither.
+        mutable LockStripes directoryLocks;
+
+        /// Guards the directories map and dirtyDirectories.
+        mutable std::shared_mutex directoriesLock;
+
+        /// Guards allocation and release of inodes.
+        mutable std::mutex inodeTableMutex;
+
+        /// Guards decompressedFiles.
+        mutable std::mutex decompressedMutex;
+
+        /// Guards snapshots and nextSnapshotId: shared to read a snapshot, exclusive to add or delete one.
+        mutable std::shared_mutex snapshotsLock;
+
+        /// Guards currentPath while the volume is held shared.
+        mutable std::mutex currentPathMutex;
+
         /// Total size of the simulated disk.
         size_t diskSize;
 
         /// Size of each block.
         size_t blockSize;
 
+        /// Block allocation policy used whenever the block manager is (re)created.
+        AllocationPolicy allocationPolicy;
+
+        /// Whether whole-file writes go through the block manager's fingerprint index.
+        bool deduplication = false;
+
+        /// Whether the block manager verifies checksums on reads.
+        bool checksumVerification = true;
+
+        /// Whether files that follow the volume setting are compressed.
+        bool compression = false;
+
+        /// Creates the block store of in-memory volumes, or null to keep their blocks in memory.
+        BlockStoreFactory blockStoreFactory;
+
+        /// Memory budget of the block cache in front of the block store.
+        size_t blockCacheBytes = 0;
+
+        /// Id of the codec new compressed data is written with.
+        uint8_t compressionCodec = LzCodec::ID;
+
+        /// Registered codecs by id.
+        std::unordered_map<uint8_t, std::shared_ptr<const Codec>> codecs;
+
+        /// Copies handed out by readSegments, by inode; dropped when the file changes.
+        std::unordered_map<const Inode *, std::string> decompressedFiles;
+
+        /// Size of the header in front of compressed data: codec id, three reserved bytes and the compressed length.
+        static constexpr size_t COMPRESSION_HEADER_SIZE = 8;
+
+        /// The mounted disk image, or null while the filesystem lives in memory. Declared before the
+        /// block manager and inode table so it outlives the storage they map.
+        std::unique_ptr<DiskImage> image;
+
         /// Manages block allocation and deallocation.        
         BlockManager blockManager;
 
-        /// Table of inodes.
-        std::vector<Inode> inodeTable;
+        /// Table of packed inode records with an O(1) free-inode stack.
+        InodeTable inodeTable;
+
+        /// Contents of every directory, keyed by the directory's inode index. A removed directory leaves a null
+        /// entry until its inode is reused, so it is never loaded again from blocks that were freed.
+        std::unordered_map<unsigned int, std::unique_ptr<Directory>> directories;
+
+        /// Cache of (parent inode, name) lookups used during path resolution.
+        DentryCache dentryCache;
+
+        /// Directories changed since the last sync, by inode index.
+        std::unordered_set<unsigned int> dirtyDirectories;
+
+        /// Snapshots by id. Each holds one reference to every block of every file it recorded.
+        std::map<unsigned int, Snapshot> snapshots;
+
+        /// Id given to the next snapshot.
+        unsigned int nextSnapshotId = 1;
+
+        /// Log of completed operations, or null when changes are not journaled.
+        std::unique_ptr<Journal> journal;
+
+        /// True while journal records are being applied, so they are not logged again.
+        bool replaying = false;
+
+        /// Blocks read by each task when readAsync splits a file.
+        static constexpr size_t ASYNC_CHUNK_BLOCKS = 256;
+
+        /// Default largest readahead window, in blocks.
+        static constexpr size_t DEFAULT_READAHEAD_BLOCKS = 64;
 
-        /// Root directory of the filesystem.
-        Directory rootDirectory;
+        /// Readahead window of the first sequential read, in blocks.
+        static constexpr size_t MIN_READAHEAD_BLOCKS = 4;
+
+        /// Largest readahead window in blocks; 0 turns readahead off.
+        size_t readaheadBlocks = DEFAULT_READAHEAD_BLOCKS;
+
+        /// Sequential streams of files read by offset.
+        ReadaheadTracker readahead;
+
+        /// Set while a write-behind task is queued, so at most one waits at a time.
+        std::atomic<bool> writeBehindQueued{false};
+
+        /// Set while a journal commit task is queued, so at most one waits at a time.
+        std::atomic<bool> journalCommitQueued{false};
+
+        /// Starts asyncPool exactly once.
+        std::once_flag asyncPoolStarted;
+
+        /// Thread pool running async operations, or null before the first one. Stopped first on destruction.
+        std::unique_ptr<TaskExecutor> asyncPool;
+
+        /// Inode index of the current directory.
+        std::atomic<unsigned int> currentDirectory{ROOT_INODE};
+
+        /// Absolute path of the current directory.
+        std::string currentPath = "/";
 
         /**
          * @brief Indicates if the filesystem has been formatted.
@@ -117,20 +1057,348 @@ namespace cse4733
         bool isFormatted = false;
 
         /**
-         * @brief Writes data to a series of blocks.
+         * @brief Writes data to as few contiguous block runs as possible.
+         *
+         * With deduplication on, each block is stored through the fingerprint index
+         * instead, and extents are formed from whichever blocks that yields.
          * 
          * @param data The data to write.
-         * @return A vector of block indices where the data was written.
+         * @param reservation Blocks set aside by the caller. Without deduplication the data is written
+         *        to the front of the reservation when it holds enough blocks, which are then removed from it.
+         * @return The extents where the data was written, or an empty vector if not enough blocks are free.
          */
-        std::vector<int> writeDataToBlocks(const std::string &data);
+        std::vector<Extent> writeDataToBlocks(const std::string &data, std::vector<Extent> *reservation = nullptr);
 
         /**
-         * @brief Reads data from a series of blocks.
+         * @brief Reads a file's data from its inode if it is inline, otherwise by walking its direct, indirect
+         * and double-indirect extents.
          * 
-         * @param blockIndexes The indices of the blocks to read.
+         * @param inode The inode of the file to read.
          * @return The data read from the blocks.
          */
-        std::string readDataFromBlocks(const std::vector<int> &blockIndexes);
+        std::string readDataFromBlocks(const Inode &inode);
+
+        /**
+         * @brief Copies part of a file's data into a buffer. The caller holds the file's lock.
+         *
+         * @param inode The inode of the file.
+         * @param offset The byte offset to start at. Must be less than the file size.
+         * @param length The number of bytes to copy. offset + length must not pass the end of the file.
+         * @param buffer The buffer to copy into, at least length bytes.
+         */
+        void copyRange(const Inode &inode, size_t offset, size_t length, char *buffer);
+
+        /**
+         * @brief Copies up to length bytes of a file starting at offset into a buffer, for one readAsync task.
+         *
+         * @return The number of bytes copied, which stops early at the end of the file.
+         * @throw FileMissingException if the file does not exist.
+         */
+        size_t readChunk(const std::string &filename, size_t offset, size_t length, char *buffer);
+
+        /**
+         * @brief Returns the size of a file and whether readAsync may split it into ranges.
+         *
+         * @return False if the file does not exist.
+         */
+        bool sizeForAsyncRead(const std::string &filename, size_t &size, bool &splittable);
+
+        /**
+         * @brief Returns the async thread pool, starting it on first use.
+         */
+        TaskExecutor &asyncExecutor();
+
+        /**
+         * @brief Builds views of a file's data in block storage, merging physically adjacent extents.
+         *
+         * Blocks must be memory-resident. An inline file is a single view of its inode.
+         *
+         * @param inode The inode of the file.
+         * @return Segments covering exactly fileSize bytes, in file order.
+         */
+        std::vector<std::string_view> segmentsFor(const Inode &inode);
+
+        /**
+         * @brief Returns the stored form of a file's new contents: a compression header and the compressed
+         * data if the file should be compressed and that saves blocks, otherwise an empty string.
+         */
+        std::string encodeData(const Inode &inode, const std::string &data) const;
+
+        /**
+         * @brief Reads and decompresses data stored with a compression header.
+         *
+         * @param extents The extents holding the header and compressed data.
+         * @param rawSize The size of the decompressed data.
+         * @throw CorruptDataException if the codec is unknown or the data does not decompress.
+         */
+        std::string decodeData(const std::vector<Extent> &extents, size_t rawSize);
+
+        /**
+         * @brief Replaces a file's entire contents, writing the new blocks before the old ones are freed.
+         *
+         * The data is compressed if the file should be.
+         *
+         * @return True on success, false if not enough blocks are free; the file is unchanged on failure.
+         */
+        bool replaceFileData(Inode &inode, const std::string &data);
+
+        /**
+         * @brief Returns true if a regular file of size bytes is stored inline in its inode instead of in blocks.
+         */
+        static bool fitsInline(size_t size);
+
+        /**
+         * @brief Copies a file's data into its inode and sets FLAG_INLINE. The inode must not reference any blocks.
+         */
+        static void storeInline(Inode &inode, const std::string &data);
+
+        /**
+         * @brief Returns true if a change leaving a file newSize bytes long must go through replaceFileData.
+         *
+         * That holds for compressed and inline files, and for a file without blocks that can stay inline,
+         * so inline files move to blocks as they grow past Inode::MAX_INLINE_SIZE.
+         */
+        static bool rewritesWhole(const Inode &inode, size_t newSize);
+
+        /**
+         * @brief Builds views of the first size bytes stored in a list of extents.
+         */
+        std::vector<std::string_view> segmentsFor(const std::vector<Extent> &extents, size_t size);
+
+        /**
+         * @brief Copies the data stored in a list of extents, starting at a byte offset, into a buffer.
+         *
+         * Unlike segmentsFor, works whether or not blocks are memory-resident. While blocks
+         * live in a block store, a range longer than the readahead window is copied a window
+         * at a time, with the next window prefetched in the background.
+         *
+         * @return The number of bytes copied, fewer than length only if the extents end first.
+         */
+        size_t copyExtents(const std::vector<Extent> &extents, size_t offset, size_t length, char *buffer);
+
+        /**
+         * @brief Returns the readahead window in bytes, or 0 if blocks are memory-resident or readahead is off.
+         */
+        size_t readaheadWindow() const;
+
+        /**
+         * @brief Prefetches a byte range of the data stored in a list of extents on the async thread pool.
+         *
+         * @param extents The extents holding the data.
+         * @param firstExtent The index of an extent at or before the range, to start the search from.
+         * @param position The byte offset of the data at which firstExtent starts.
+         * @param offset The byte offset of the range.
+         * @param length The number of bytes to prefetch.
+         */
+        void schedulePrefetch(const std::vector<Extent> &extents, size_t firstExtent, size_t position,
+                              size_t offset, size_t length);
+
+        /**
+         * @brief Writes dirty cached blocks back on the async thread pool once enough of the cache is dirty.
+         */
+        void scheduleWriteBehind();
+
+        /**
+         * @brief Commits the journal's pending group on the async thread pool once it is full.
+         */
+        void scheduleJournalCommit();
+
+        /**
+         * @brief Writes the image's modified pages through the journal to its file, then empties the journal.
+         */
+        void checkpointImage();
+
+        /**
+         * @brief Returns the snapshot with the given id. The caller holds snapshotsLock.
+         *
+         * @throw SnapshotMissingException if there is no such snapshot.
+         */
+        const Snapshot &snapshotFor(unsigned int snapshotId) const;
+
+        /**
+         * @brief Resolves a path to the inode of a regular file and locks the inode for reading.
+         *
+         * @param filename The path of the file.
+         * @param lock Set to a shared hold on the inode's lock stripe.
+         * @throw FileMissingException if the file does not exist.
+         * @throw IsADirectoryException if the path names a directory.
+         */
+        Inode &lockFile(const std::string &filename, std::shared_lock<std::shared_mutex> &lock);
+
+        /**
+         * @brief Resolves a path to the inode of a regular file and locks the inode for writing.
+         *
+         * @param filename The path of the file.
+         * @param lock Set to an exclusive hold on the inode's lock stripe.
+         * @throw FileMissingException if the file does not exist.
+         * @throw IsADirectoryException if the path names a directory.
+         */
+        Inode &lockFile(const std::string &filename, std::unique_lock<std::shared_mutex> &lock);
+
+        /// Finds an inode and the entry naming it: sets the directory holding the entry and the entry's
+        /// name, which is empty if the inode was reached without one, e.g. "/".
+        using EntryResolver = std::function<Result<unsigned int>(unsigned int &parentInode, std::string &name)>;
+
+        /**
+         * @brief Finds an inode and locks it, making sure it is still the one its entry names.
+         *
+         * A delete removes a file's entry while holding the file's inode lock, so an entry
+         * that still names the inode once the lock is held keeps naming it until the lock
+         * is released. If the entry changed meanwhile, the inode is resolved again.
+         *
+         * @param resolve Finds the inode and its entry.
+         * @param lock Set to a hold on the inode's lock stripe, shared or exclusive by its type.
+         * @return The locked inode's index, or the error resolve reported.
+         */
+        template <typename Lock>
+        Result<unsigned int> tryLockEntry(const EntryResolver &resolve, Lock &lock);
+
+        /**
+         * @brief Resolves a path like tryResolvePath and locks the inode like tryLockEntry.
+         */
+        template <typename Lock>
+        Result<unsigned int> tryLockPath(const std::string &path, Lock &lock);
+
+        /**
+         * @brief Writes data into a locked file at an offset, extending the file if needed.
+         *
+         * @param inode The file's inode, locked exclusively by the caller.
+         * @param filename The path of the file, for the journal.
+         * @param offset The byte offset to write at.
+         * @param data The bytes to write.
+         * @return True on success, false if not enough blocks are free.
+         */
+        bool writeAt(Inode &inode, const std::string &filename, size_t offset, const std::string &data);
+
+        /**
+         * @brief Runs one batch operation whose parent directory is already resolved.
+         *
+         * @param operation The operation to run.
+         * @param parentInode The inode index of the directory holding the file.
+         * @param parent The directory's Directory as tryResolveDirectory returned it.
+         * @param name The final component of the operation's path.
+         * @param reservation The batch's reserved blocks, which writes take from.
+         * @return The operation's result; expected failures are reported, not thrown.
+         */
+        BatchResult runOperation(const BatchOperation &operation, unsigned int parentInode, const Directory *parent,
+                                 const std::string &name, std::vector<Extent> &reservation);
+
+        /**
+         * @brief Runs a batch read or write on a file, locking it like tryLockEntry.
+         *
+         * @param operation The operation to run, a Read or a Write.
+         * @param resolve Finds the file's inode and its entry.
+         * @param reservation The batch's reserved blocks, which writes take from.
+         * @return The operation's result; IsADirectory if the inode is a directory.
+         */
+        BatchResult accessFile(const BatchOperation &operation, const EntryResolver &resolve,
+                               std::vector<Extent> &reservation);
+
+        /**
+         * @brief Replaces a file's content. The caller holds the file's lock exclusively.
+         *
+         * The old blocks are freed first, so a failed write leaves the file empty.
+         *
+         * @param inode The file's inode.
+         * @param filename The path of the file, for the journal.
+         * @param data The new content.
+         * @param reservation Blocks set aside for the write, or null; see writeDataToBlocks.
+         * @return True on success, false if not enough blocks are free.
+         */
+        bool writeWhole(Inode &inode, const std::string &filename, const std::string &data,
+                        std::vector<Extent> *reservation);
+
+        /**
+         * @brief Drops a file's cached decompressed contents, if any.
+         */
+        void forgetDecompressed(const Inode &inode);
+
+        /**
+         * @brief Collects every extent of a file, following its pointer blocks.
+         *
+         * @param inode The inode to read extents from.
+         * @return The file's extents, in file order.
+         */
+        std::vector<Extent> loadExtents(const Inode &inode);
+
+        /**
+         * @brief Records a file's extents in the inode, allocating pointer blocks for any that do not fit directly.
+         *
+         * @param inode The inode to update. It must not currently reference any extents.
+         * @param extents The file's extents, in file order.
+         * @return False if the file has more extents than an inode can address.
+         * @throw NoFreeBlockAvailableException if a pointer block cannot be allocated; no pointer blocks are kept.
+         */
+        bool storeExtents(Inode &inode, const std::vector<Extent> &extents);
+
+        /**
+         * @brief Frees a file's data blocks and pointer blocks and clears its extent fields.
+         *
+         * @param inode The inode whose blocks are released.
+         */
+        void releaseExtents(Inode &inode);
+
+        /**
+         * @brief Frees only a file's indirect and double-indirect pointer blocks and clears its extent fields.
+         *
+         * @param inode The inode whose pointer blocks are released.
+         */
+        void releasePointerBlocks(Inode &inode);
+
+        /**
+         * @brief Rewrites a file's extent records, allocating the new pointer blocks before the old ones are freed.
+         *
+         * Nothing is allocated once the old pointer blocks are gone, so a failure leaves the
+         * inode exactly as it was.
+         *
+         * @param inode The inode of the file. It must not be inline.
+         * @param extents The file's new extents, in file order.
+         * @return True on success, false if the extents cannot be recorded; the inode is unchanged on failure.
+         */
+        bool replaceExtents(Inode &inode, const std::vector<Extent> &extents);
+
+        /**
+         * @brief Grows or shrinks a file's block allocation to exactly hold newSize bytes.
+         *
+         * Growth extends the last extent in place before allocating new extents; shrinking
+         * frees whole blocks past the new end, once the inode no longer lists them. The
+         * inode's extent records are rewritten with replaceExtents.
+         *
+         * @param inode The inode of the file.
+         * @param extents The file's current extents; updated to the new extent list.
+         * @param newSize The number of bytes the file must be able to hold.
+         * @return True on success, false if not enough blocks are free; nothing changes on failure.
+         */
+        bool resizeExtents(Inode &inode, std::vector<Extent> &extents, size_t newSize);
+
+        /**
+         * @brief Gives a file private copies of the shared blocks that a write to a byte range would touch.
+         *
+         * Only blocks the file already owns are considered. Copies are allocated before
+         * anything changes, and the file drops its reference to each block it copied.
+         *
+         * @param inode The inode of the file.
+         * @param extents The file's current extents; updated to the new extent list.
+         * @param offset The first byte of the range.
+         * @param size The number of bytes in the range.
+         * @return True on success, false if not enough blocks are free; nothing changes on failure.
+         */
+        bool unshareRange(Inode &inode, std::vector<Extent> &extents, size_t offset, size_t size);
+
+        /**
+         * @brief Copies data into a file's extents at a byte offset. The extents must already cover the range.
+         */
+        void writeRange(const std::vector<Extent> &extents, size_t offset, const char *data, size_t size);
+
+        /**
+         * @brief Returns the number of extents a pointer block holds.
+         */
+        size_t extentsPerBlock() const;
+
+        /**
+         * @brief Returns the number of block indices a double-indirect block holds.
+         */
+        size_t pointersPerBlock() const;
     };
 
 } // namespace cse4733
@@ -0,0 +1,185 @@
+#include "FreeSpaceBitmap.hpp"
+
+#include <algorithm>
+
+namespace cse4733
+{
+
+    namespace
+    {
+        constexpr size_t BITS_PER_WORD = 64;
+
+        inline uint64_t bitMask(size_t index)
+        {
+            return uint64_t(1) << (index % BITS_PER_WORD);
+        }
+    } // namespace
+
+    FreeSpaceBitmap::FreeSpaceBitmap(size_t bitCount)
+        : ownedWords(wordsFor(bitCount)),
+          wordCount(wordsFor(bitCount)),
+          bitCount(bitCount),
+          freeCount(bitCount)
+    {
+        words = ownedWords.data();
+        clear(words, bitCount);
+    }
+
+    FreeSpaceBitmap::FreeSpaceBitmap(uint64_t *words, size_t bitCount, size_t freeCount)
+        : words(words),
+          wordCount(wordsFor(bitCount)),
+          bitCount(bitCount),
+          freeCount(freeCount)
+    {
+    }
+
+    size_t FreeSpaceBitmap::wordsFor(size_t bitCount)
+    {
+        return (bitCount + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    }
+
+    void FreeSpaceBitmap::clear(uint64_t *words, size_t bitCount)
+    {
+        // Set every bit, then clear the unused tail bits of the last word so they are never reported as free
+        size_t count = wordsFor(bitCount);
+        std::fill(words, words + count, ~uint64_t(0));
+        size_t tailBits = bitCount % BITS_PER_WORD;
+        if (tailBits != 0)
+        {
+            words[count - 1] = (uint64_t(1) << tailBits) - 1;
+        }
+    }
+
+    size_t FreeSpaceBitmap::countFree(const uint64_t *words, size_t bitCount)
+    {
+        size_t count = 0;
+        for (size_t w = 0; w < wordsFor(bitCount); ++w)
+        {
+            count += static_cast<size_t>(__builtin_popcountll(words[w]));
+        }
+        return count;
+    }
+
+    bool FreeSpaceBitmap::isFree(size_t index) const
+    {
+        return (words[index / BITS_PER_WORD] & bitMask(index)) != 0;
+    }
+
+    void FreeSpaceBitmap::markUsed(size_t index)
+    {
+        uint64_t &word = words[index / BITS_PER_WORD];
+        if (word & bitMask(index))
+        {
+            word &= ~bitMask(index);
+            --freeCount;
+        }
+    }
+
+    void FreeSpaceBitmap::markFree(size_t index)
+    {
+        uint64_t &word = words[index / BITS_PER_WORD];
+        if (!(word & bitMask(index)))
+        {
+            word |= bitMask(index);
+            ++freeCount;
+        }
+    }
+
+    void FreeSpaceBitmap::markRangeUsed(size_t start, size_t count)
+    {
+        // Walk the range word by word, clearing only the bits inside it and
+        // subtracting the number of bits that actually changed from the free count
+        size_t end = start + count;
+        while (start < end)
+        {
+            size_t bit = start % BITS_PER_WORD;
+            size_t span = std::min(BITS_PER_WORD - bit, end - start);
+            uint64_t mask = (span == BITS_PER_WORD) ? ~uint64_t(0) : ((uint64_t(1) << span) - 1) << bit;
+            uint64_t &word = words[start / BITS_PER_WORD];
+            freeCount -= static_cast<size_t>(__builtin_popcountll(word & mask));
+            word &= ~mask;
+            start += span;
+        }
+    }
+
+    void FreeSpaceBitmap::markRangeFree(size_t start, size_t count)
+    {
+        // Mirror of markRangeUsed: set the bits and add the ones that were previously clear
+        size_t end = start + count;
+        while (start < end)
+        {
+            size_t bit = start % BITS_PER_WORD;
+            size_t span = std::min(BITS_PER_WORD - bit, end - start);
+            uint64_t mask = (span == BITS_PER_WORD) ? ~uint64_t(0) : ((uint64_t(1) << span) - 1) << bit;
+            uint64_t &word = words[start / BITS_PER_WORD];
+            freeCount += static_cast<size_t>(__builtin_popcountll(~word & mask));
+            word |= mask;
+            start += span;
+        }
+    }
+
+    size_t FreeSpaceBitmap::findFree(size_t start) const
+    {
+        // 1. Bail out early when nothing is free
+        // 2. Scan from the word holding start to the end, ignoring bits below start
+        // 3. Wrap around and scan from the beginning up to and including the start word
+        if (freeCount == 0)
+        {
+            return npos;
+        }
+        if (start >= bitCount)
+        {
+            start = 0;
+        }
+
+        size_t startWord = start / BITS_PER_WORD;
+        size_t found = scanWords(startWord, ~uint64_t(0) << (start % BITS_PER_WORD), wordCount);
+        if (found == npos)
+        {
+            found = scanWords(0, ~uint64_t(0), startWord + 1);
+        }
+        return found;
+    }
+
+    size_t FreeSpaceBitmap::findUsed(size_t start) const
+    {
+        // Scan the inverted words for the first set bit, i.e. the first used slot
+        uint64_t mask = ~uint64_t(0) << (start % BITS_PER_WORD);
+        for (size_t w = start / BITS_PER_WORD; w < wordCount && start < bitCount; ++w)
+        {
+            uint64_t used = ~words[w] & mask;
+            if (used != 0)
+            {
+                return std::min(bitCount, w * BITS_PER_WORD + static_cast<size_t>(__builtin_ctzll(used)));
+            }
+            mask = ~uint64_t(0);
+        }
+        return bitCount;
+    }
+
+    size_t FreeSpaceBitmap::scanWords(size_t firstWord, uint64_t firstMask, size_t lastWord) const
+    {
+        uint64_t mask = firstMask;
+        for (size_t w = firstWord; w < lastWord; ++w)
+        {
+            uint64_t bits = words[w] & mask;
+            if (bits != 0)
+            {
+                return w * BITS_PER_WORD + static_cast<size_t>(__builtin_ctzll(bits));
+            }
+            mask = ~uint64_t(0);
+        }
+        return npos;
+    }
+
+    size_t FreeSpaceBitmap::getFreeCount() const
+    {
+        return freeCount;
+    }
+
+    size_t FreeSpaceBitmap::size() const
+    {
+        return bitCount;
+    }
+
+} // namespace cse4733
@@ -0,0 +1,167 @@
+#ifndef FREESPACEBITMAP_HPP
+#define FREESPACEBITMAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cse4733
+{
+
+    /**
+     * @class FreeSpaceBitmap
+     * @brief Tracks free/used state for a fixed number of slots, one bit per slot packed into 64-bit words.
+     *
+     * A set bit means the slot is free. Searches skip whole words at a time and use
+     * count-trailing-zeros to locate the first free bit inside a word, and the number
+     * of free slots is maintained incrementally so it can be read in O(1).
+     * The words either belong to the bitmap or live in external memory, such as a
+     * memory-mapped disk image.
+     */
+    class FreeSpaceBitmap
+    {
+    public:
+        /**
+         * @brief Value returned by findFree when no free slot exists.
+         */
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        /**
+         * @brief Constructs a bitmap with every slot marked free.
+         *
+         * @param bitCount The number of slots tracked by the bitmap.
+         */
+        explicit FreeSpaceBitmap(size_t bitCount = 0);
+
+        /**
+         * @brief Attaches to words in external memory that already hold bitmap state.
+         *
+         * @param words The external words, wordsFor(bitCount) of them. They must outlive the bitmap.
+         * @param bitCount The number of slots tracked by the bitmap.
+         * @param freeCount The number of free slots recorded in the words.
+         */
+        FreeSpaceBitmap(uint64_t *words, size_t bitCount, size_t freeCount);
+
+        FreeSpaceBitmap(const FreeSpaceBitmap &) = delete;
+        FreeSpaceBitmap &operator=(const FreeSpaceBitmap &) = delete;
+        FreeSpaceBitmap(FreeSpaceBitmap &&) = default;
+        FreeSpaceBitmap &operator=(FreeSpaceBitmap &&) = default;
+
+        /**
+         * @brief Returns the number of 64-bit words needed to track bitCount slots.
+         */
+        static size_t wordsFor(size_t bitCount);
+
+        /**
+         * @brief Marks every slot in external words free, clearing the unused tail bits.
+         */
+        static void clear(uint64_t *words, size_t bitCount);
+
+        /**
+         * @brief Counts the free slots recorded in external words.
+         */
+        static size_t countFree(const uint64_t *words, size_t bitCount);
+
+        /**
+         * @brief Checks whether a slot is free.
+         *
+         * @param index The slot to check. Must be less than size().
+         * @return True if the slot is free, false otherwise.
+         */
+        bool isFree(size_t index) const;
+
+        /**
+         * @brief Marks a slot as used. Marking an already used slot has no effect.
+         *
+         * @param index The slot to mark. Must be less than size().
+         */
+        void markUsed(size_t index);
+
+        /**
+         * @brief Marks a slot as free. Marking an already free slot has no effect.
+         *
+         * @param index The slot to mark. Must be less than size().
+         */
+        void markFree(size_t index);
+
+        /**
+         * @brief Marks a contiguous range of slots as used, a word at a time.
+         *
+         * @param start The first slot in the range.
+         * @param count The number of slots in the range. start + count must not exceed size().
+         */
+        void markRangeUsed(size_t start, size_t count);
+
+        /**
+         * @brief Marks a contiguous range of slots as free, a word at a time.
+         *
+         * @param start The first slot in the range.
+         * @param count The number of slots in the range. start + count must not exceed size().
+         */
+        void markRangeFree(size_t start, size_t count);
+
+        /**
+         * @brief Finds the first free slot at or after start, wrapping around to the beginning.
+         *
+         * @param start The slot to begin searching from.
+         * @return The index of a free slot, or npos if every slot is used.
+         */
+        size_t findFree(size_t start) const;
+
+        /**
+         * @brief Finds the first used slot at or after start, without wrapping.
+         *
+         * @param start The slot to begin searching from.
+         * @return The index of a used slot, or size() if every slot from start onwards is free.
+         */
+        size_t findUsed(size_t start) const;
+
+        /**
+         * @brief Returns the number of free slots.
+         */
+        size_t getFreeCount() const;
+
+        /**
+         * @brief Returns the number of slots tracked by the bitmap.
+         */
+        size_t size() const;
+
+    private:
+        /**
+         * @brief Scans words [firstWord, lastWord) for a set bit, masking the first word with firstMask.
+         *
+         * @return The index of the first free slot found, or npos.
+         */
+        size_t scanWords(size_t firstWord, uint64_t firstMask, size_t lastWord) const;
+
+        /**
+         * @brief Bit storage, 64 slots per word. Bits past bitCount are always zero.
+         *
+         * Points either into ownedWords or into external memory.
+         */
+        uint64_t *words;
+
+        /**
+         * @brief Storage for the words when the bitmap owns them; empty when attached to external memory.
+         */
+        std::vector<uint64_t> ownedWords;
+
+        /**
+         * @brief The number of 64-bit words in use.
+         */
+        size_t wordCount;
+
+        /**
+         * @brief The number of slots tracked by the bitmap.
+         */
+        size_t bitCount;
+
+        /**
+         * @brief The number of slots currently marked free.
+         */
+        size_t freeCount;
+    };
+
+} // namespace cse4733
+
+#endif // FREESPACEBITMAP_HPP
@@ -1,48 +1,69 @@
 #include "Inode.hpp"
 
+#include <ctime>
+
 namespace cse4733
 {
 
-    Inode::Inode() : isAllocated(false), fileSize(0), creationTime(0), modificationTime(0)
+    Inode::Inode()
+        : flags(0), extentCount(0), fileSize(0), creationTime(0), modificationTime(0)
     {
-        // Reserve space for the maximum number of direct blocks to avoid reallocations
-        directBlocks.reserve(MAX_DIRECT_BLOCKS);
+        // The extent and pointer fields share a union with the inline data, so they are set here
+        for (Extent &extent: directExtents)
+        {
+            extent = Extent{0, 0};
+        }
+        indirectBlock = NO_BLOCK;
+        doubleIndirectBlock = NO_BLOCK;
     }
 
-    void Inode::allocate(size_t size, const std::vector<int> &blocks)
+    void Inode::allocate()
     {
         // Mark the inode as allocated
-        isAllocated = true;
+        flags = FLAG_ALLOCATED;
 
-        // Set the file size
-        fileSize = size;
+        // A new file is empty
+        fileSize = 0;
+        extentCount = 0;
+        indirectBlock = NO_BLOCK;
+        doubleIndirectBlock = NO_BLOCK;
 
         // Set the creation time to the current time
         creationTime = std::time(nullptr);
 
         // Set the modification time to the creation time initially
         modificationTime = creationTime;
-
-        // Assign the provided blocks to the inode
-        directBlocks = blocks;
     }
 
     void Inode::deallocate()
     {
-        // Mark the inode as not allocated
-        isAllocated = false;
+        // Reset every field to the unallocated state
+        *this = Inode();
+    }
 
-        // Reset the file size
-        fileSize = 0;
+    bool Inode::isAllocated() const
+    {
+        return (flags & FLAG_ALLOCATED) != 0;
+    }
 
-        // Reset the creation time
-        creationTime = 0;
+    bool Inode::isDirectory() const
+    {
+        return (flags & FLAG_DIRECTORY) != 0;
+    }
 
-        // Reset the modification time
-        modificationTime = 0;
+    bool Inode::isInline() const
+    {
+        return (flags & FLAG_INLINE) != 0;
+    }
 
-        // Clear all block indices
-        directBlocks.clear();
+    char *Inode::inlineData()
+    {
+        return inlineBytes;
+    }
+
+    const char *Inode::inlineData() const
+    {
+        return inlineBytes;
     }
 
 } // namespace cse4733
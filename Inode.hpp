@@ -1,52 +1,143 @@
 #ifndef INODE_HPP
 #define INODE_HPP
 
-#include <vector>
-#include <ctime>
+#include <cstddef>
+#include <cstdint>
+
+#include "Extent.hpp"
 
 namespace cse4733
 {
 
-    class Inode
+    /**
+     * @class Inode
+     * @brief Fixed-size, cache-line sized record describing one file.
+     *
+     * The first MAX_DIRECT_EXTENTS extents of a file are stored in the inode itself.
+     * Further extents live in pointer blocks on the volume: the indirect block holds
+     * an array of extents, and the double-indirect block holds an array of block
+     * indices, each naming another block full of extents. Flags, size, timestamps and
+     * block pointers are packed into exactly 64 bytes, so the inode table is a flat
+     * array with one record per cache line.
+     *
+     * A regular file of at most MAX_INLINE_SIZE bytes is stored inline instead: its
+     * data occupies the extent and pointer fields, and it owns no blocks at all.
+     */
+    class alignas(64) Inode
     {
     public:
+        /* Marker for an unused block pointer or an empty free-inode list. */
+        static constexpr uint32_t NO_BLOCK = static_cast<uint32_t>(-1);
+
+        /* Number of extents stored directly in the inode. */
+        static constexpr size_t MAX_DIRECT_EXTENTS = 3;
+
+        /* Flag bit set while the inode is in use. */
+        static constexpr uint32_t FLAG_ALLOCATED = 1u << 0;
+
+        /* Flag bit set when the inode describes a directory rather than a regular file. */
+        static constexpr uint32_t FLAG_DIRECTORY = 1u << 1;
+
+        /* Flag bit set while the file's blocks hold a compression header and compressed data. */
+        static constexpr uint32_t FLAG_COMPRESSED = 1u << 2;
+
+        /* Flag bits overriding the volume's compression setting for this file. */
+        static constexpr uint32_t FLAG_COMPRESS = 1u << 3;
+        static constexpr uint32_t FLAG_NO_COMPRESS = 1u << 4;
+
+        /* Flag bit set while the file's data is held in the inode itself, see inlineData. */
+        static constexpr uint32_t FLAG_INLINE = 1u << 5;
+
+        /* Largest file stored inline: the bytes of the direct extents and both block pointers. */
+        static constexpr size_t MAX_INLINE_SIZE = 32;
+
         /**
          * @brief Constructs an unallocated inode.
          */
         Inode();
 
         /**
-         * @brief Initializes inode for a new file.
-         *
-         * @param size The size of the file in bytes.
-         * @param blocks The list of data block indices assigned to this file.
+         * @brief Initializes inode for a new, empty file.
          */
-        void allocate(size_t size, const std::vector<int> &blocks);
+        void allocate();
 
         /**
          * @brief Clears inode data when a file is deleted.
+         *
+         * The caller is responsible for freeing the file's data and pointer blocks first.
          */
         void deallocate();
 
-        /* Indicates if the inode is currently in use. */
-        bool isAllocated;
+        /**
+         * @brief Indicates if the inode is currently in use.
+         */
+        bool isAllocated() const;
+
+        /**
+         * @brief Indicates if the inode describes a directory.
+         */
+        bool isDirectory() const;
+
+        /**
+         * @brief Indicates if the file's data is stored inline.
+         */
+        bool isInline() const;
+
+        /**
+         * @brief Returns the MAX_INLINE_SIZE bytes that hold an inline file's data.
+         *
+         * They share a union with directExtents, indirectBlock and doubleIndirectBlock,
+         * which mean nothing while FLAG_INLINE is set.
+         */
+        char *inlineData();
+        const char *inlineData() const;
+
+        /* Bit set of FLAG_* values. */
+        uint32_t flags;
+
+        /* Total number of extents in the file, including those in pointer blocks. */
+        uint32_t extentCount;
 
         /* Size of the file in bytes. */
-        size_t fileSize;
+        uint64_t fileSize;
 
         /* Timestamp for when the file was created. */
-        std::time_t creationTime;
+        int64_t creationTime;
 
         /* Timestamp for when the file was last modified. */
-        std::time_t modificationTime;
+        int64_t modificationTime;
+
+        union
+        {
+            struct
+            {
+                /* The first extents of the file, in file order. */
+                Extent directExtents[MAX_DIRECT_EXTENTS];
 
-        /* List of direct block indices for this file. */
-        std::vector<int> directBlocks;
+                union
+                {
+                    /* Block holding the next extents after the direct ones, or NO_BLOCK. */
+                    uint32_t indirectBlock;
 
-    private:
-        static const int MAX_DIRECT_BLOCKS = 10; /* Maximum number of direct blocks per inode. */
+                    /* While the inode is free: index of the next free inode, or NO_BLOCK. */
+                    uint32_t nextFreeInode;
+                };
+
+                /* Block holding indices of further extent blocks, or NO_BLOCK. */
+                uint32_t doubleIndirectBlock;
+            };
+
+            /* While FLAG_INLINE is set: the file's data, zero-padded. */
+            char inlineBytes[MAX_INLINE_SIZE];
+        };
     };
 
+    static_assert(sizeof(Inode) == 64, "Inode records must fill exactly one cache line");
+    static_assert(offsetof(Inode, doubleIndirectBlock) + sizeof(uint32_t) - offsetof(Inode, directExtents) == Inode::MAX_INLINE_SIZE,
+                  "Inline data must exactly cover the extent and pointer fields");
+    static_assert(offsetof(Inode, inlineBytes) == offsetof(Inode, directExtents),
+                  "Inline data must overlay the extent and pointer fields");
+
 } // namespace cse4733
 
-#endif // INODE_HPP
\ No newline at end of file
+#endif // INODE_HPP
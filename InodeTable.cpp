@@ -0,0 +1,121 @@
+#include "InodeTable.hpp"
+#include "NoAvailableInodeException.hpp"
+
+namespace cse4733
+{
+
+    InodeTable::InodeTable(size_t inodeCount)
+        : ownedInodes(inodeCount), inodeCount(inodeCount), freeHead(0), freeCount(inodeCount)
+    {
+        inodes = ownedInodes.data();
+        format(inodes, inodeCount);
+        if (inodeCount == 0)
+        {
+            freeHead = Inode::NO_BLOCK;
+        }
+    }
+
+    InodeTable::InodeTable(Inode *records, size_t inodeCount, uint32_t freeHead, size_t freeCount)
+        : inodes(records), inodeCount(inodeCount), freeHead(freeHead), freeCount(freeCount)
+    {
+    }
+
+    void InodeTable::format(Inode *records, size_t inodeCount)
+    {
+        // Link the inodes so that the lowest index is allocated first
+        uint32_t next = Inode::NO_BLOCK;
+        for (size_t i = inodeCount; i-- > 0;)
+        {
+            records[i] = Inode();
+            records[i].nextFreeInode = next;
+            next = static_cast<uint32_t>(i);
+        }
+    }
+
+    void InodeTable::rebuildFreeList()
+    {
+        // Relink every unallocated record, lowest index first
+        freeHead = Inode::NO_BLOCK;
+        freeCount = 0;
+        for (size_t i = inodeCount; i-- > 0;)
+        {
+            if (!inodes[i].isAllocated())
+            {
+                inodes[i].nextFreeInode = freeHead;
+                freeHead = static_cast<uint32_t>(i);
+                ++freeCount;
+            }
+        }
+    }
+
+    unsigned int InodeTable::allocate()
+    {
+        Result<unsigned int> inodeIndex = tryAllocate();
+        if (!inodeIndex)
+        {
+            throw NoAvailableInodeException();
+        }
+        return inodeIndex.value();
+    }
+
+    Result<unsigned int> InodeTable::tryAllocate()
+    {
+        // 1. If the free stack is empty, report ErrorCode::NoInode
+        // 2. Pop the head of the free stack
+        // 3. Initialize the inode for a new file and return its index
+        if (freeHead == Inode::NO_BLOCK)
+        {
+            return ErrorCode::NoInode;
+        }
+
+        uint32_t inodeIndex = freeHead;
+        Inode &inode = inodes[inodeIndex];
+        freeHead = inode.nextFreeInode;
+        --freeCount;
+
+        inode.allocate();
+        return inodeIndex;
+    }
+
+    void InodeTable::release(unsigned int inodeIndex)
+    {
+        // 1. Ignore out of range or already free inodes
+        // 2. Clear the inode and push it onto the free stack
+        if (inodeIndex >= inodeCount || !inodes[inodeIndex].isAllocated())
+        {
+            return;
+        }
+
+        Inode &inode = inodes[inodeIndex];
+        inode.deallocate();
+        inode.nextFreeInode = freeHead;
+        freeHead = inodeIndex;
+        ++freeCount;
+    }
+
+    Inode &InodeTable::operator[](size_t inodeIndex)
+    {
+        return inodes[inodeIndex];
+    }
+
+    const Inode &InodeTable::operator[](size_t inodeIndex) const
+    {
+        return inodes[inodeIndex];
+    }
+
+    size_t InodeTable::size() const
+    {
+        return inodeCount;
+    }
+
+    size_t InodeTable::getFreeCount() const
+    {
+        return freeCount;
+    }
+
+    uint32_t InodeTable::getFreeHead() const
+    {
+        return freeHead;
+    }
+
+} // namespace cse4733
@@ -0,0 +1,136 @@
+#ifndef INODETABLE_HPP
+#define INODETABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Inode.hpp"
+#include "Result.hpp"
+
+namespace cse4733
+{
+
+    /**
+     * @class InodeTable
+     * @brief Fixed-size array of inode records with an intrusive stack of free inodes.
+     *
+     * Free inodes are linked through their own records, so allocating and releasing
+     * an inode are both O(1) and need no memory beyond the table itself. The records
+     * either belong to the table or live in external memory, such as a memory-mapped
+     * disk image.
+     */
+    class InodeTable
+    {
+    public:
+        /**
+         * @brief Constructs a table of unallocated inodes.
+         *
+         * @param inodeCount The number of inodes in the table.
+         */
+        explicit InodeTable(size_t inodeCount = 0);
+
+        /**
+         * @brief Attaches to inode records in external memory that already hold table state.
+         *
+         * @param records The external records. They must outlive the table.
+         * @param inodeCount The number of records.
+         * @param freeHead Index of the first free inode, or Inode::NO_BLOCK.
+         * @param freeCount The number of free inodes.
+         */
+        InodeTable(Inode *records, size_t inodeCount, uint32_t freeHead, size_t freeCount);
+
+        InodeTable(const InodeTable &) = delete;
+        InodeTable &operator=(const InodeTable &) = delete;
+        InodeTable(InodeTable &&) = default;
+        InodeTable &operator=(InodeTable &&) = default;
+
+        /**
+         * @brief Resets external records to unallocated inodes linked into a free stack starting at index 0.
+         */
+        static void format(Inode *records, size_t inodeCount);
+
+        /**
+         * @brief Pops an inode off the free stack and initializes it for a new, empty file.
+         *
+         * @return The index of the allocated inode.
+         * @throw NoAvailableInodeException if every inode is in use.
+         */
+        unsigned int allocate();
+
+        /**
+         * @brief Allocates an inode like allocate, without throwing.
+         *
+         * @return The index of the allocated inode, or ErrorCode::NoInode.
+         */
+        Result<unsigned int> tryAllocate();
+
+        /**
+         * @brief Clears an inode and pushes it back onto the free stack.
+         *
+         * Releasing an inode that is not allocated, or an index out of range, has no effect.
+         *
+         * @param inodeIndex The index of the inode to release.
+         */
+        void release(unsigned int inodeIndex);
+
+        /**
+         * @brief Returns the inode record at an index. The index must be less than size().
+         */
+        Inode &operator[](size_t inodeIndex);
+        const Inode &operator[](size_t inodeIndex) const;
+
+        /**
+         * @brief Returns the total number of inodes.
+         */
+        size_t size() const;
+
+        /**
+         * @brief Returns the number of inodes not in use.
+         */
+        size_t getFreeCount() const;
+
+        /**
+         * @brief Returns the index of the first free inode, or Inode::NO_BLOCK when none are free.
+         */
+        uint32_t getFreeHead() const;
+
+        /**
+         * @brief Rebuilds the free stack and free count by scanning every record.
+         *
+         * Used to recover when the stored free-stack head cannot be trusted.
+         */
+        void rebuildFreeList();
+
+    private:
+        /**
+         * @brief The inode records, one cache line each.
+         *
+         * Points either into ownedInodes or into external memory.
+         */
+        Inode *inodes;
+
+        /**
+         * @brief Storage for the records when the table owns them.
+         */
+        std::vector<Inode> ownedInodes;
+
+        /**
+         * @brief The number of inode records.
+         */
+        size_t inodeCount;
+
+        /**
+         * @brief Index of the first free inode, or Inode::NO_BLOCK when none are free.
+         */
+        uint32_t freeHead;
+
+        /**
+         * @brief The number of inodes on the free stack.
+         */
+        size_t freeCount;
+    };
+
+} // namespace cse4733
+
+#endif // INODETABLE_HPP
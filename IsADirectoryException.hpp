@@ -0,0 +1,19 @@
+#ifndef IS_A_DIRECTORY_EXCEPTION_HPP
+#define IS_A_DIRECTORY_EXCEPTION_HPP
+
+#include <stdexcept>
+#include <string>
+
+namespace cse4733
+{
+
+    class IsADirectoryException : public std::runtime_error
+    {
+    public:
+        explicit IsADirectoryException(const std::string &path)
+            : std::runtime_error("Is a directory: " + path) {}
+    };
+
+} // namespace cse4733
+
+#endif // IS_A_DIRECTORY_EXCEPTION_HPP
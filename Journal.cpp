@@ -0,0 +1,278 @@
+#include "Journal.hpp"
+#include "JournalException.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cse4733
+{
+
+    namespace
+    {
+        // Every record is a header followed by its payload:
+        //   uint32 payloadSize, uint32 checksum
+        //   uint8 type, uint32 pathLength, path, uint64 offset, uint64 dataLength, data
+        constexpr size_t HEADER_SIZE = 2 * sizeof(uint32_t);
+
+        template <typename T>
+        void appendValue(std::string &out, T value)
+        {
+            out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+
+        template <typename T>
+        bool readValue(const std::string &in, size_t &position, size_t end, T &value)
+        {
+            if (position + sizeof(value) > end)
+            {
+                return false;
+            }
+            std::memcpy(&value, in.data() + position, sizeof(value));
+            position += sizeof(value);
+            return true;
+        }
+    } // namespace
+
+    uint32_t Journal::checksum(const char *data, size_t size)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+        }
+        return hash;
+    }
+
+    bool Journal::append(const Record &record)
+    {
+        // 1. Encode the record outside the lock: the payload after a placeholder header
+        // 2. Fill in the payload size and checksum
+        // 3. Add it to the pending group and report whether the group is full
+        std::string encoded(HEADER_SIZE, '\0');
+        appendValue(encoded, static_cast<uint8_t>(record.type));
+        appendValue(encoded, static_cast<uint32_t>(record.path.size()));
+        encoded += record.path;
+        appendValue(encoded, record.offset);
+        appendValue(encoded, static_cast<uint64_t>(record.data.size()));
+        encoded += record.data;
+
+        uint32_t payloadSize = static_cast<uint32_t>(encoded.size() - HEADER_SIZE);
+        uint32_t sum = checksum(encoded.data() + HEADER_SIZE, payloadSize);
+        std::memcpy(&encoded[0], &payloadSize, sizeof(payloadSize));
+        std::memcpy(&encoded[sizeof(payloadSize)], &sum, sizeof(sum));
+
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pending += encoded;
+        return ++pendingCount >= groupSize;
+    }
+
+    size_t Journal::getGroupSize() const
+    {
+        return groupSize;
+    }
+
+    size_t Journal::getPendingCount() const
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        return pendingCount;
+    }
+
+    size_t Journal::getCommittedCount() const
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        return committedCount;
+    }
+
+    size_t Journal::getCommitCount() const
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        return commitCount;
+    }
+
+#ifndef _WIN32
+
+    Journal::Journal(const std::string &path, size_t groupSize)
+        : path(path), fd(-1), groupSize(groupSize > 0 ? groupSize : 1), pendingCount(0), committedCount(0), commitCount(0)
+    {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (fd < 0)
+        {
+            throw JournalException(path, std::strerror(errno));
+        }
+    }
+
+    Journal::~Journal()
+    {
+        try
+        {
+            commit();
+        }
+        catch (const JournalException &)
+        {
+            // Nothing more can be done for records that cannot be written
+        }
+        ::close(fd);
+    }
+
+    std::vector<Journal::Record> Journal::readRecords()
+    {
+        // 1. Read the whole file
+        // 2. Decode records until one is short or fails its checksum
+        // 3. Cut off anything after the last intact record
+        std::lock_guard<std::mutex> writeLock(writeMutex);
+        std::string contents;
+        char buffer[1 << 16];
+        ssize_t count;
+        while ((count = ::pread(fd, buffer, sizeof(buffer), static_cast<off_t>(contents.size()))) > 0)
+        {
+            contents.append(buffer, static_cast<size_t>(count));
+        }
+        if (count < 0)
+        {
+            throw JournalException(path, std::strerror(errno));
+        }
+
+        std::vector<Record> records;
+        size_t position = 0;
+        while (true)
+        {
+            size_t at = position;
+            uint32_t payloadSize;
+            uint32_t sum;
+            if (!readValue(contents, at, contents.size(), payloadSize) || !readValue(contents, at, contents.size(), sum) ||
+                at + payloadSize > contents.size() || checksum(contents.data() + at, payloadSize) != sum)
+            {
+                break;
+            }
+
+            size_t end = at + payloadSize;
+            uint8_t type;
+            uint32_t pathLength;
+            uint64_t dataLength;
+            Record record{};
+            if (!readValue(contents, at, end, type) || !readValue(contents, at, end, pathLength) || at + pathLength > end)
+            {
+                break;
+            }
+            record.type = static_cast<RecordType>(type);
+            record.path.assign(contents, at, pathLength);
+            at += pathLength;
+            if (!readValue(contents, at, end, record.offset) || !readValue(contents, at, end, dataLength) || at + dataLength != end)
+            {
+                break;
+            }
+            record.data.assign(contents, at, dataLength);
+            records.push_back(std::move(record));
+            position = end;
+        }
+
+        if (position < contents.size() && ::ftruncate(fd, static_cast<off_t>(position)) != 0)
+        {
+            throw JournalException(path, std::strerror(errno));
+        }
+        return records;
+    }
+
+    void Journal::commit()
+    {
+        // 1. Take the whole pending group, so appends carry on into the next one
+        // 2. Write it with one write and one fsync, holding only the write lock
+        // 3. On failure, cut the file back to where the group started and put the group back in front
+        std::lock_guard<std::mutex> writeLock(writeMutex);
+        std::string group;
+        size_t count;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            if (pendingCount == 0)
+            {
+                return;
+            }
+            group.swap(pending);
+            count = pendingCount;
+            pendingCount = 0;
+        }
+
+        off_t start = ::lseek(fd, 0, SEEK_END);
+        auto fail = [&](int error) {
+            if (start >= 0 && ::ftruncate(fd, start) != 0)
+            {
+                // The torn group is cut off by readRecords instead
+            }
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            pending.insert(0, group);
+            pendingCount += count;
+            throw JournalException(path, std::strerror(error));
+        };
+
+        const char *data = group.data();
+        size_t remaining = group.size();
+        while (remaining > 0)
+        {
+            ssize_t written = ::write(fd, data, remaining);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                fail(errno);
+            }
+            data += written;
+            remaining -= static_cast<size_t>(written);
+        }
+        if (::fsync(fd) != 0)
+        {
+            fail(errno);
+        }
+
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        committedCount += count;
+        ++commitCount;
+    }
+
+    void Journal::reset()
+    {
+        std::lock_guard<std::mutex> writeLock(writeMutex);
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pending.clear();
+        pendingCount = 0;
+        if (::ftruncate(fd, 0) != 0 || ::fsync(fd) != 0)
+        {
+            throw JournalException(path, std::strerror(errno));
+        }
+    }
+
+#else
+
+    Journal::Journal(const std::string &path, size_t groupSize)
+        : path(path), fd(-1), groupSize(groupSize), pendingCount(0), committedCount(0), commitCount(0)
+    {
+        throw JournalException(path, "journals are not supported on this platform");
+    }
+
+    Journal::~Journal()
+    {
+    }
+
+    std::vector<Journal::Record> Journal::readRecords()
+    {
+        return {};
+    }
+
+    void Journal::commit()
+    {
+    }
+
+    void Journal::reset()
+    {
+    }
+
+#endif
+
+} // namespace cse4733
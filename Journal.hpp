@@ -0,0 +1,210 @@
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cse4733
+{
+
+    /**
+     * @class Journal
+     * @brief Append-only redo log of filesystem operations, made durable in groups.
+     *
+     * Each record describes one completed operation by absolute path, including the
+     * bytes written, and is protected by a checksum so a torn tail left by a crash is
+     * detected and discarded. Records are buffered and written with a single write and
+     * fsync by commit(); append reports when groupSize of them are pending, so the
+     * caller can commit the group.
+     *
+     * Every record is safe to apply more than once, so the log can be replayed over a
+     * state that already contains some of its operations.
+     *
+     * A disk image also writes its checkpoints through the journal: Page records
+     * holding the image pages about to be overwritten, then a Checkpoint record. A
+     * checkpoint whose Checkpoint record is intact can be finished after a crash by
+     * writing its pages again; one without it never touched the image.
+     *
+     * Every method may be called from several threads at once. Appends only wait for
+     * each other, not for a commit's write and fsync, and groups reach the file in the
+     * order they were appended.
+     */
+    class Journal
+    {
+    public:
+        /**
+         * @brief The operation a record describes.
+         */
+        enum class RecordType : uint8_t
+        {
+            Format = 1,
+            CreateFile,
+            MakeDirectory,
+            DeleteFile,
+            RemoveDirectory,
+            WriteFile,
+            WriteAt,
+            Truncate,
+            CloneFile,
+            SetCompression,
+            Page,
+            Checkpoint
+        };
+
+        /**
+         * @brief One logged operation.
+         */
+        struct Record
+        {
+            /* The operation. */
+            RecordType type;
+
+            /* Absolute path of the file or directory operated on; empty for Page and Checkpoint. */
+            std::string path;
+
+            /* Byte offset for WriteAt, new size for Truncate, the CompressionPreference for SetCompression,
+               the image offset of the first page for Page, otherwise 0. */
+            uint64_t offset;
+
+            /* Bytes written by WriteFile and WriteAt, the absolute source path for CloneFile,
+               the page contents for Page, otherwise empty. */
+            std::string data;
+        };
+
+        /**
+         * @brief Number of records batched into one commit by default.
+         */
+        static constexpr size_t DEFAULT_GROUP_SIZE = 64;
+
+        /**
+         * @brief Opens a journal file, creating it if it does not exist.
+         *
+         * @param path The path of the journal file.
+         * @param groupSize The number of pending records that triggers a commit.
+         * @throw JournalException if the file cannot be opened.
+         */
+        explicit Journal(const std::string &path, size_t groupSize = DEFAULT_GROUP_SIZE);
+
+        /**
+         * @brief Commits any pending records and closes the file.
+         */
+        ~Journal();
+
+        Journal(const Journal &) = delete;
+        Journal &operator=(const Journal &) = delete;
+
+        /**
+         * @brief Reads every intact record in the file, in order. Pending records are not included.
+         *
+         * Reading stops at the first short or corrupt record, and the file is cut back
+         * to the end of the last intact one so new records follow it directly.
+         *
+         * @return The committed records.
+         * @throw JournalException if the file cannot be read.
+         */
+        std::vector<Record> readRecords();
+
+        /**
+         * @brief Buffers a record.
+         *
+         * @param record The record to log.
+         * @return True once groupSize or more records are pending, so a commit is due.
+         */
+        bool append(const Record &record);
+
+        /**
+         * @brief Writes every pending record with a single write and fsync.
+         *
+         * Records appended while the group is being written wait for the next commit.
+         * On failure the file is cut back to where the group started and the records
+         * stay pending.
+         *
+         * @throw JournalException if the write or fsync fails.
+         */
+        void commit();
+
+        /**
+         * @brief Discards the whole log, pending records included, once its operations are durable elsewhere.
+         *
+         * @throw JournalException if the file cannot be truncated.
+         */
+        void reset();
+
+        /**
+         * @brief Returns the number of pending records that triggers a commit.
+         */
+        size_t getGroupSize() const;
+
+        /**
+         * @brief Returns the number of records not yet committed.
+         */
+        size_t getPendingCount() const;
+
+        /**
+         * @brief Returns the number of records committed since the journal was opened.
+         */
+        size_t getCommittedCount() const;
+
+        /**
+         * @brief Returns the number of commits, i.e. fsync calls, since the journal was opened.
+         */
+        size_t getCommitCount() const;
+
+    private:
+        /**
+         * @brief Checksum of a record payload, 32-bit FNV-1a.
+         */
+        static uint32_t checksum(const char *data, size_t size);
+
+        /**
+         * @brief The path of the journal file.
+         */
+        std::string path;
+
+        /**
+         * @brief File descriptor of the open journal file.
+         */
+        int fd;
+
+        /**
+         * @brief The number of pending records that triggers a commit.
+         */
+        size_t groupSize;
+
+        /**
+         * @brief Guards pending, pendingCount and the counters.
+         */
+        mutable std::mutex pendingMutex;
+
+        /**
+         * @brief Held by a commit while it writes and syncs its group, so groups reach the file in order.
+         */
+        std::mutex writeMutex;
+
+        /**
+         * @brief Encoded records waiting for the next commit.
+         */
+        std::string pending;
+
+        /**
+         * @brief The number of records in pending.
+         */
+        size_t pendingCount;
+
+        /**
+         * @brief The number of records committed since the journal was opened.
+         */
+        size_t committedCount;
+
+        /**
+         * @brief The number of commits since the journal was opened.
+         */
+        size_t commitCount;
+    };
+
+} // namespace cse4733
+
+#endif // JOURNAL_HPP
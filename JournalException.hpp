@@ -0,0 +1,19 @@
+#ifndef JOURNAL_EXCEPTION_HPP
+#define JOURNAL_EXCEPTION_HPP
+
+#include <stdexcept>
+#include <string>
+
+namespace cse4733
+{
+
+    class JournalException : public std::runtime_error
+    {
+    public:
+        JournalException(const std::string &path, const std::string &reason)
+            : std::runtime_error("Journal " + path + ": " + reason) {}
+    };
+
+} // namespace cse4733
+
+#endif // JOURNAL_EXCEPTION_HPP
@@ -0,0 +1,28 @@
+#include "LockStripes.hpp"
+
+namespace cse4733
+{
+
+    LockStripes::LockStripes(size_t count)
+    {
+        size_t stripeCount = 1;
+        while (stripeCount < count)
+        {
+            stripeCount <<= 1;
+        }
+        stripes = std::make_unique<Stripe[]>(stripeCount);
+        mask = stripeCount - 1;
+    }
+
+    std::shared_mutex &LockStripes::forIndex(size_t index) const
+    {
+        // Consecutive indexes land on consecutive stripes, so neighbouring inodes never contend
+        return stripes[index & mask].mutex;
+    }
+
+    size_t LockStripes::size() const
+    {
+        return mask + 1;
+    }
+
+} // namespace cse4733
@@ -0,0 +1,70 @@
+#ifndef LOCKSTRIPES_HPP
+#define LOCKSTRIPES_HPP
+
+#include <cstddef>
+#include <memory>
+#include <shared_mutex>
+
+namespace cse4733
+{
+
+    /**
+     * @class LockStripes
+     * @brief A fixed set of reader/writer locks shared by many objects, chosen by index.
+     *
+     * Giving every inode or directory its own lock would cost memory proportional to the
+     * volume; instead objects map onto a power-of-two number of stripes. Two objects on
+     * the same stripe merely contend with each other. Each stripe sits on its own cache
+     * line, so threads using different stripes never share a line.
+     */
+    class LockStripes
+    {
+    public:
+        /**
+         * @brief Constructs the stripes.
+         *
+         * @param count The number of stripes, rounded up to a power of two.
+         */
+        explicit LockStripes(size_t count = DEFAULT_STRIPES);
+
+        LockStripes(const LockStripes &) = delete;
+        LockStripes &operator=(const LockStripes &) = delete;
+
+        /**
+         * @brief Returns the lock guarding an object.
+         *
+         * @param index The object's index, e.g. an inode index.
+         */
+        std::shared_mutex &forIndex(size_t index) const;
+
+        /**
+         * @brief Returns the number of stripes.
+         */
+        size_t size() const;
+
+        /// Stripe count used when none is given.
+        static constexpr size_t DEFAULT_STRIPES = 128;
+
+    private:
+        /**
+         * @brief One lock padded to a cache line.
+         */
+        struct alignas(64) Stripe
+        {
+            std::shared_mutex mutex;
+        };
+
+        /**
+         * @brief The stripes.
+         */
+        std::unique_ptr<Stripe[]> stripes;
+
+        /**
+         * @brief The number of stripes minus one, used to reduce an index to a stripe.
+         */
+        size_t mask;
+    };
+
+} // namespace cse4733
+
+#endif // LOCKSTRIPES_HPP
@@ -0,0 +1,169 @@
+#include "LzCodec.hpp"
+
+#include <cstring>
+#include <vector>
+
+namespace cse4733
+{
+
+    namespace
+    {
+        inline uint32_t read32(const char *p)
+        {
+            uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        // Writes the part of a length that does not fit in its nibble
+        void appendLength(std::string &out, size_t length)
+        {
+            while (length >= 255)
+            {
+                out.push_back(static_cast<char>(255));
+                length -= 255;
+            }
+            out.push_back(static_cast<char>(length));
+        }
+
+        bool readLength(std::string_view in, size_t &position, size_t &length)
+        {
+            unsigned char byte;
+            do
+            {
+                if (position >= in.size())
+                {
+                    return false;
+                }
+                byte = static_cast<unsigned char>(in[position++]);
+                length += byte;
+            } while (byte == 255);
+            return true;
+        }
+
+        void appendSequence(std::string &out, std::string_view literals, size_t offset, size_t matchLength, size_t minMatch)
+        {
+            size_t literalNibble = literals.size() < 15 ? literals.size() : 15;
+            size_t matchNibble = 0;
+            if (matchLength > 0)
+            {
+                matchNibble = matchLength - minMatch < 15 ? matchLength - minMatch : 15;
+            }
+            out.push_back(static_cast<char>((literalNibble << 4) | matchNibble));
+            if (literalNibble == 15)
+            {
+                appendLength(out, literals.size() - 15);
+            }
+            out.append(literals.data(), literals.size());
+            if (matchLength > 0)
+            {
+                out.push_back(static_cast<char>(offset & 0xFF));
+                out.push_back(static_cast<char>(offset >> 8));
+                if (matchNibble == 15)
+                {
+                    appendLength(out, matchLength - minMatch - 15);
+                }
+            }
+        }
+    } // namespace
+
+    uint8_t LzCodec::getId() const
+    {
+        return ID;
+    }
+
+    std::string LzCodec::getName() const
+    {
+        return "lz";
+    }
+
+    std::string LzCodec::compress(std::string_view data) const
+    {
+        // 1. Hash the four bytes at each position and probe the one earlier position with the same hash
+        // 2. On a verified match within the window, extend it and emit the pending literals with it
+        // 3. Emit whatever is left as a final literal-only token
+        std::string out;
+        out.reserve(data.size() / 2 + 16);
+        std::vector<int32_t> table(size_t(1) << HASH_BITS, -1);
+
+        size_t anchor = 0;
+        size_t position = 0;
+        while (position + MIN_MATCH <= data.size())
+        {
+            uint32_t sequence = read32(data.data() + position);
+            uint32_t slot = (sequence * 2654435761u) >> (32 - HASH_BITS);
+            int32_t candidate = table[slot];
+            table[slot] = static_cast<int32_t>(position);
+
+            if (candidate >= 0 && position - static_cast<size_t>(candidate) <= MAX_OFFSET &&
+                read32(data.data() + candidate) == sequence)
+            {
+                size_t length = MIN_MATCH;
+                while (position + length < data.size() && data[candidate + length] == data[position + length])
+                {
+                    ++length;
+                }
+                appendSequence(out, data.substr(anchor, position - anchor), position - static_cast<size_t>(candidate), length, MIN_MATCH);
+                position += length;
+                anchor = position;
+            }
+            else
+            {
+                ++position;
+            }
+        }
+        appendSequence(out, data.substr(anchor), 0, 0, MIN_MATCH);
+        return out;
+    }
+
+    bool LzCodec::decompress(std::string_view data, size_t rawSize, std::string &out) const
+    {
+        // Copy literals, then replay each match byte by byte so overlapping matches repeat correctly
+        out.clear();
+        out.reserve(rawSize);
+        size_t position = 0;
+        while (position < data.size())
+        {
+            unsigned char token = static_cast<unsigned char>(data[position++]);
+            size_t literalLength = token >> 4;
+            if (literalLength == 15 && !readLength(data, position, literalLength))
+            {
+                return false;
+            }
+            if (literalLength > data.size() - position || out.size() + literalLength > rawSize)
+            {
+                return false;
+            }
+            out.append(data.data() + position, literalLength);
+            position += literalLength;
+            if (position == data.size())
+            {
+                break;
+            }
+
+            if (data.size() - position < 2)
+            {
+                return false;
+            }
+            size_t offset = static_cast<unsigned char>(data[position]) | (static_cast<size_t>(static_cast<unsigned char>(data[position + 1])) << 8);
+            position += 2;
+            size_t matchLength = (token & 0x0F);
+            if (matchLength == 15 && !readLength(data, position, matchLength))
+            {
+                return false;
+            }
+            matchLength += MIN_MATCH;
+            if (offset == 0 || offset > out.size() || out.size() + matchLength > rawSize)
+            {
+                return false;
+            }
+            size_t from = out.size() - offset;
+            for (size_t i = 0; i < matchLength; ++i)
+            {
+                out.push_back(out[from + i]);
+            }
+        }
+        return out.size() == rawSize;
+    }
+
+} // namespace cse4733
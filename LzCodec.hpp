@@ -0,0 +1,51 @@
+#ifndef LZCODEC_HPP
+#define LZCODEC_HPP
+
+#include "Codec.hpp"
+
+namespace cse4733
+{
+
+    /**
+     * @class LzCodec
+     * @brief Fast LZ77-style codec with a single-probe hash table and a 64 KiB window.
+     *
+     * The stream is a sequence of tokens. Each token byte holds a literal count in
+     * its high nibble and a match length minus MIN_MATCH in its low nibble; a nibble
+     * of 15 is continued by bytes of 255 and a final byte below 255. The literals
+     * follow, then a two-byte little-endian match offset. The last token has
+     * literals only and ends the stream.
+     */
+    class LzCodec : public Codec
+    {
+    public:
+        /**
+         * @brief The id stored with data compressed by this codec.
+         */
+        static constexpr uint8_t ID = 1;
+
+        uint8_t getId() const override;
+        std::string getName() const override;
+        std::string compress(std::string_view data) const override;
+        bool decompress(std::string_view data, size_t rawSize, std::string &out) const override;
+
+    private:
+        /**
+         * @brief The shortest match worth encoding.
+         */
+        static constexpr size_t MIN_MATCH = 4;
+
+        /**
+         * @brief The largest distance a match may reach back.
+         */
+        static constexpr size_t MAX_OFFSET = 65535;
+
+        /**
+         * @brief log2 of the number of hash table slots.
+         */
+        static constexpr unsigned HASH_BITS = 12;
+    };
+
+} // namespace cse4733
+
+#endif // LZCODEC_HPP
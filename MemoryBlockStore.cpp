@@ -0,0 +1,38 @@
+#include "MemoryBlockStore.hpp"
+
+#include <cstring>
+
+namespace cse4733
+{
+
+    MemoryBlockStore::MemoryBlockStore(size_t blockCount, size_t blockSize)
+        : blockCount(blockCount), blockSize(blockSize), data(new char[blockCount * blockSize])
+    {
+    }
+
+    void MemoryBlockStore::read(uint32_t start, uint32_t count, char *out)
+    {
+        std::memcpy(out, data.get() + static_cast<size_t>(start) * blockSize, static_cast<size_t>(count) * blockSize);
+    }
+
+    void MemoryBlockStore::write(uint32_t start, uint32_t count, const char *bytes)
+    {
+        std::memcpy(data.get() + static_cast<size_t>(start) * blockSize, bytes, static_cast<size_t>(count) * blockSize);
+    }
+
+    void MemoryBlockStore::sync()
+    {
+        // Memory is as durable as it gets
+    }
+
+    size_t MemoryBlockStore::getBlockSize() const
+    {
+        return blockSize;
+    }
+
+    size_t MemoryBlockStore::getBlockCount() const
+    {
+        return blockCount;
+    }
+
+} // namespace cse4733
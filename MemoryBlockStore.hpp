@@ -0,0 +1,50 @@
+#ifndef MEMORYBLOCKSTORE_HPP
+#define MEMORYBLOCKSTORE_HPP
+
+#include <memory>
+
+#include "BlockStore.hpp"
+
+namespace cse4733
+{
+
+    /**
+     * @class MemoryBlockStore
+     * @brief A BlockStore kept in one heap allocation.
+     *
+     * The allocation is left uninitialized, so the OS only commits the pages that are written.
+     */
+    class MemoryBlockStore : public BlockStore
+    {
+    public:
+        /**
+         * @brief Allocates room for blockCount blocks of blockSize bytes.
+         */
+        MemoryBlockStore(size_t blockCount, size_t blockSize);
+
+        void read(uint32_t start, uint32_t count, char *out) override;
+        void write(uint32_t start, uint32_t count, const char *data) override;
+        void sync() override;
+        size_t getBlockSize() const override;
+        size_t getBlockCount() const override;
+
+    private:
+        /**
+         * @brief The number of blocks.
+         */
+        size_t blockCount;
+
+        /**
+         * @brief The size of each block in bytes.
+         */
+        size_t blockSize;
+
+        /**
+         * @brief The blocks, back to back.
+         */
+        std::unique_ptr<char[]> data;
+    };
+
+} // namespace cse4733
+
+#endif // MEMORYBLOCKSTORE_HPP
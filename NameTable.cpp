@@ -0,0 +1,264 @@
+#include "NameTable.hpp"
+#include "EpochReclaimer.hpp"
+
+#include <functional>
+
+namespace cse4733
+{
+
+    NameTable::Table::Table(size_t bucketCount)
+        : mask(bucketCount - 1),
+          buckets(std::make_unique<std::atomic<const Bucket *>[]>(bucketCount))
+    {
+        for (size_t i = 0; i < bucketCount; ++i)
+        {
+            buckets[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    NameTable::Table::~Table()
+    {
+        for (size_t i = 0; i <= mask; ++i)
+        {
+            delete buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    NameTable::~NameTable()
+    {
+        destroy();
+    }
+
+    NameTable::NameTable(NameTable &&other) noexcept
+        : table(other.table.exchange(nullptr, std::memory_order_relaxed)),
+          count(other.count.exchange(0, std::memory_order_relaxed)),
+          version(other.version.load(std::memory_order_relaxed))
+    {
+    }
+
+    NameTable &NameTable::operator=(NameTable &&other) noexcept
+    {
+        if (this != &other)
+        {
+            destroy();
+            table.store(other.table.exchange(nullptr, std::memory_order_relaxed), std::memory_order_relaxed);
+            count.store(other.count.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+            version.fetch_add(1, std::memory_order_relaxed);
+        }
+        return *this;
+    }
+
+    void NameTable::destroy()
+    {
+        Table *current = table.exchange(nullptr, std::memory_order_relaxed);
+        if (current == nullptr)
+        {
+            return;
+        }
+        for (size_t i = 0; i <= current->mask; ++i)
+        {
+            if (const Bucket *bucket = current->buckets[i].load(std::memory_order_relaxed))
+            {
+                for (const Slot &slot : *bucket)
+                {
+                    delete slot.entry;
+                }
+            }
+        }
+        delete current;
+        count.store(0, std::memory_order_relaxed);
+    }
+
+    size_t NameTable::hashOf(std::string_view name)
+    {
+        return std::hash<std::string_view>()(name);
+    }
+
+    const NameTable::Entry *NameTable::findEntry(const Table *current, std::string_view name, size_t hash)
+    {
+        if (current == nullptr)
+        {
+            return nullptr;
+        }
+        const Bucket *bucket = current->buckets[hash & current->mask].load(std::memory_order_acquire);
+        if (bucket == nullptr)
+        {
+            return nullptr;
+        }
+        for (const Slot &slot : *bucket)
+        {
+            if (slot.hash == hash && slot.entry->name == name)
+            {
+                return slot.entry;
+            }
+        }
+        return nullptr;
+    }
+
+    bool NameTable::find(std::string_view name, uint32_t &inodeIndex) const
+    {
+        // The guard keeps every table, bucket and entry reachable from here alive until it ends
+        EpochReclaimer::Guard guard;
+        const Entry *entry = findEntry(table.load(std::memory_order_acquire), name, hashOf(name));
+        if (entry == nullptr)
+        {
+            return false;
+        }
+        inodeIndex = entry->inodeIndex;
+        return true;
+    }
+
+    bool NameTable::contains(std::string_view name) const
+    {
+        uint32_t inodeIndex;
+        return find(name, inodeIndex);
+    }
+
+    const std::string *NameTable::insert(const std::string &name, uint32_t inodeIndex)
+    {
+        // 1. Refuse a name that is already present
+        // 2. Grow the table if the new name would push the load past MAX_LOAD
+        // 3. Publish a copy of the bucket with the new slot appended and retire the old bucket
+        size_t hash = hashOf(name);
+        if (findEntry(table.load(std::memory_order_relaxed), name, hash) != nullptr)
+        {
+            return nullptr;
+        }
+        Table *current = table.load(std::memory_order_relaxed);
+        size_t newCount = count.load(std::memory_order_relaxed) + 1;
+        if (current == nullptr || newCount > (current->mask + 1) * MAX_LOAD)
+        {
+            reserve(newCount);
+            current = table.load(std::memory_order_relaxed);
+        }
+
+        const Entry *entry = new Entry{name, inodeIndex};
+        std::atomic<const Bucket *> &slot = current->buckets[hash & current->mask];
+        const Bucket *old = slot.load(std::memory_order_relaxed);
+        Bucket *updated = old ? new Bucket(*old) : new Bucket();
+        updated->push_back(Slot{hash, entry});
+        slot.store(updated, std::memory_order_release);
+        if (old != nullptr)
+        {
+            EpochReclaimer::instance().retire(const_cast<Bucket *>(old));
+        }
+        count.store(newCount, std::memory_order_relaxed);
+        version.fetch_add(1, std::memory_order_release);
+        return &entry->name;
+    }
+
+    bool NameTable::erase(std::string_view name)
+    {
+        // 1. Find the slot holding the name
+        // 2. Publish a copy of the bucket without it (or an empty bucket)
+        // 3. Retire the old bucket and the entry; readers may still be looking at either
+        Table *current = table.load(std::memory_order_relaxed);
+        if (current == nullptr)
+        {
+            return false;
+        }
+        size_t hash = hashOf(name);
+        std::atomic<const Bucket *> &slot = current->buckets[hash & current->mask];
+        const Bucket *old = slot.load(std::memory_order_relaxed);
+        if (old == nullptr)
+        {
+            return false;
+        }
+        const Entry *entry = nullptr;
+        Bucket *updated = new Bucket();
+        updated->reserve(old->size());
+        for (const Slot &candidate : *old)
+        {
+            if (entry == nullptr && candidate.hash == hash && candidate.entry->name == name)
+            {
+                entry = candidate.entry;
+            }
+            else
+            {
+                updated->push_back(candidate);
+            }
+        }
+        if (entry == nullptr)
+        {
+            delete updated;
+            return false;
+        }
+        if (updated->empty())
+        {
+            delete updated;
+            updated = nullptr;
+        }
+
+        slot.store(updated, std::memory_order_release);
+        EpochReclaimer &reclaimer = EpochReclaimer::instance();
+        reclaimer.retire(const_cast<Bucket *>(old));
+        reclaimer.retire(const_cast<Entry *>(entry));
+        count.fetch_sub(1, std::memory_order_relaxed);
+        version.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+
+    void NameTable::reserve(size_t names)
+    {
+        size_t bucketCount = MIN_BUCKETS;
+        while (bucketCount * MAX_LOAD < names)
+        {
+            bucketCount <<= 1;
+        }
+        Table *current = table.load(std::memory_order_relaxed);
+        if (current == nullptr || bucketCount > current->mask + 1)
+        {
+            rehash(bucketCount);
+        }
+    }
+
+    void NameTable::rehash(size_t bucketCount)
+    {
+        // 1. Redistribute every slot into fresh buckets; the entries are shared, not copied
+        // 2. Publish the new table and retire the old one with its buckets
+        auto fresh = std::make_unique<Table>(bucketCount);
+        std::vector<Bucket *> buckets(bucketCount, nullptr);
+        Table *current = table.load(std::memory_order_relaxed);
+        if (current != nullptr)
+        {
+            for (size_t i = 0; i <= current->mask; ++i)
+            {
+                const Bucket *bucket = current->buckets[i].load(std::memory_order_relaxed);
+                if (bucket == nullptr)
+                {
+                    continue;
+                }
+                for (const Slot &slot : *bucket)
+                {
+                    Bucket *&target = buckets[slot.hash & fresh->mask];
+                    if (target == nullptr)
+                    {
+                        target = new Bucket();
+                    }
+                    target->push_back(slot);
+                }
+            }
+        }
+        for (size_t i = 0; i < bucketCount; ++i)
+        {
+            fresh->buckets[i].store(buckets[i], std::memory_order_relaxed);
+        }
+
+        table.store(fresh.release(), std::memory_order_release);
+        if (current != nullptr)
+        {
+            EpochReclaimer::instance().retire(current);
+        }
+    }
+
+    size_t NameTable::size() const
+    {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    uint64_t NameTable::getVersion() const
+    {
+        return version.load(std::memory_order_acquire);
+    }
+
+} // namespace cse4733
@@ -0,0 +1,176 @@
+#ifndef NAMETABLE_HPP
+#define NAMETABLE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cse4733
+{
+
+    /**
+     * @class NameTable
+     * @brief Hash table from names to inode indexes whose lookups take no lock.
+     *
+     * Each bucket is an immutable array of (hash, entry) slots reached through an
+     * atomic pointer. A writer builds a modified copy of the bucket, publishes it
+     * with a single store and retires the old copy through the EpochReclaimer, so a
+     * reader never sees a half-updated bucket and never blocks. Growing the table
+     * publishes a whole new bucket array the same way. Entries themselves never move,
+     * so the name returned by insert stays valid until the entry is erased.
+     *
+     * find, contains, size and getVersion may run on any number of threads alongside
+     * one writer; insert, erase and reserve must be serialized by the caller. Moving
+     * or destroying the table requires exclusive access.
+     */
+    class NameTable
+    {
+    public:
+        NameTable() = default;
+        ~NameTable();
+
+        NameTable(const NameTable &) = delete;
+        NameTable &operator=(const NameTable &) = delete;
+        NameTable(NameTable &&other) noexcept;
+        NameTable &operator=(NameTable &&other) noexcept;
+
+        /**
+         * @brief Looks up a name.
+         *
+         * @param name The name to find.
+         * @param inodeIndex Set to the name's inode index if it is present.
+         * @return True if the name is present.
+         */
+        bool find(std::string_view name, uint32_t &inodeIndex) const;
+
+        /**
+         * @brief Returns true if a name is present.
+         */
+        bool contains(std::string_view name) const;
+
+        /**
+         * @brief Adds a name.
+         *
+         * @param name The name to add.
+         * @param inodeIndex The inode index to associate with it.
+         * @return The table's own copy of the name, or nullptr if the name is already present.
+         */
+        const std::string *insert(const std::string &name, uint32_t inodeIndex);
+
+        /**
+         * @brief Removes a name. Its entry is destroyed once no reader can still see it.
+         *
+         * @return True if the name was present.
+         */
+        bool erase(std::string_view name);
+
+        /**
+         * @brief Grows the bucket array so that the given number of names fit without further growth.
+         */
+        void reserve(size_t names);
+
+        /**
+         * @brief Returns the number of names.
+         */
+        size_t size() const;
+
+        /**
+         * @brief Returns a counter that every insert and erase increases.
+         *
+         * A reader that sees the same version before and after a lookup knows the
+         * result was still current at the second read.
+         */
+        uint64_t getVersion() const;
+
+    private:
+        /**
+         * @brief A name and its inode index. Immutable once published.
+         */
+        struct Entry
+        {
+            std::string name;
+            uint32_t inodeIndex;
+        };
+
+        /**
+         * @brief One bucket slot: the cached hash of an entry's name and the entry.
+         */
+        struct Slot
+        {
+            size_t hash;
+            const Entry *entry;
+        };
+
+        /**
+         * @brief An immutable bucket. Slots are compared by hash before the name is touched.
+         */
+        using Bucket = std::vector<Slot>;
+
+        /**
+         * @brief A bucket array. Destroying it destroys its buckets but not their entries.
+         */
+        struct Table
+        {
+            explicit Table(size_t bucketCount);
+            ~Table();
+
+            /* The number of buckets minus one; the bucket count is a power of two. */
+            size_t mask;
+
+            /* The buckets; null for an empty bucket. */
+            std::unique_ptr<std::atomic<const Bucket *>[]> buckets;
+        };
+
+        /**
+         * @brief Buckets in the first table.
+         */
+        static constexpr size_t MIN_BUCKETS = 8;
+
+        /**
+         * @brief The table doubles once it holds more than this many names per bucket on average.
+         */
+        static constexpr size_t MAX_LOAD = 2;
+
+        /**
+         * @brief Hashes a name.
+         */
+        static size_t hashOf(std::string_view name);
+
+        /**
+         * @brief Returns the entry for a name in a table, or nullptr. The caller must be pinned or be the writer.
+         */
+        static const Entry *findEntry(const Table *current, std::string_view name, size_t hash);
+
+        /**
+         * @brief Publishes a new table of bucketCount buckets holding every entry and retires the old one.
+         */
+        void rehash(size_t bucketCount);
+
+        /**
+         * @brief Destroys the table and every entry immediately.
+         */
+        void destroy();
+
+        /**
+         * @brief The current bucket array, or null while the table is empty and has never grown.
+         */
+        std::atomic<Table *> table{nullptr};
+
+        /**
+         * @brief The number of names.
+         */
+        std::atomic<size_t> count{0};
+
+        /**
+         * @brief Increased by every insert and erase, after the change is published.
+         */
+        std::atomic<uint64_t> version{0};
+    };
+
+} // namespace cse4733
+
+#endif // NAMETABLE_HPP
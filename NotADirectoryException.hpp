@@ -0,0 +1,19 @@
+#ifndef NOT_A_DIRECTORY_EXCEPTION_HPP
+#define NOT_A_DIRECTORY_EXCEPTION_HPP
+
+#include <stdexcept>
+#include <string>
+
+namespace cse4733
+{
+
+    class NotADirectoryException : public std::runtime_error
+    {
+    public:
+        explicit NotADirectoryException(const std::string &path)
+            : std::runtime_error("Not a directory: " + path) {}
+    };
+
+} // namespace cse4733
+
+#endif // NOT_A_DIRECTORY_EXCEPTION_HPP
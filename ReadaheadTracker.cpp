@@ -0,0 +1,54 @@
+#include "ReadaheadTracker.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace cse4733
+{
+
+    std::pair<size_t, size_t> ReadaheadTracker::recordRead(const void *file, size_t offset, size_t length,
+                                                            size_t minWindow, size_t maxWindow)
+    {
+        // 1. Restart the stream unless the read begins where the file's last read ended
+        // 2. Open or double the window, up to the maximum
+        // 3. Hand out the part of the window past both the read and earlier prefetches
+        //
+        // Inode addresses differ in their low bits only by multiples of the record size, so mix them first
+        uint64_t key = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(file)) * 0x9E3779B97F4A7C15ull;
+        Stream &stream = streams[(key >> 58) % SLOT_COUNT];
+        std::lock_guard<std::mutex> lock(stream.mutex);
+        size_t end = offset + length;
+        if (stream.file != file || stream.next != offset || length == 0)
+        {
+            stream.file = file;
+            stream.next = end;
+            stream.window = 0;
+            stream.prefetchedTo = end;
+            return {0, 0};
+        }
+
+        stream.next = end;
+        stream.window = stream.window == 0 ? minWindow : std::min(stream.window * 2, maxWindow);
+        size_t from = std::max(stream.prefetchedTo, end);
+        size_t to = end + stream.window;
+        if (to <= from)
+        {
+            return {0, 0};
+        }
+        stream.prefetchedTo = to;
+        return {from, to};
+    }
+
+    void ReadaheadTracker::clear()
+    {
+        for (Stream &stream : streams)
+        {
+            std::lock_guard<std::mutex> lock(stream.mutex);
+            stream.file = nullptr;
+            stream.next = 0;
+            stream.window = 0;
+            stream.prefetchedTo = 0;
+        }
+    }
+
+} // namespace cse4733
@@ -0,0 +1,81 @@
+#ifndef READAHEADTRACKER_HPP
+#define READAHEADTRACKER_HPP
+
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+namespace cse4733
+{
+
+    /**
+     * @class ReadaheadTracker
+     * @brief Detects files being read sequentially and sizes how far ahead to prefetch them.
+     *
+     * Each file read by offset has a stream recording where its last read ended. A read
+     * that starts exactly there continues the stream: its readahead window starts small
+     * and doubles with every further sequential read, up to a maximum. Any other read
+     * restarts the stream with no window. Only the part of a window not already
+     * prefetched is handed out, so overlapping windows are never loaded twice.
+     *
+     * Streams live in a fixed number of slots chosen by hashing the file, each with its
+     * own lock; a file whose slot is taken by another file simply starts a new stream.
+     */
+    class ReadaheadTracker
+    {
+    public:
+        /**
+         * @brief Records a read of a file and returns the byte range to prefetch after it.
+         *
+         * @param file Identifies the file, e.g. its inode.
+         * @param offset The byte offset the read started at.
+         * @param length The number of bytes read.
+         * @param minWindow The window of the second sequential read, in bytes.
+         * @param maxWindow The largest window, in bytes.
+         * @return The range [first, second) of the file to prefetch, empty if the read was not sequential.
+         */
+        std::pair<size_t, size_t> recordRead(const void *file, size_t offset, size_t length,
+                                             size_t minWindow, size_t maxWindow);
+
+        /**
+         * @brief Forgets every stream.
+         */
+        void clear();
+
+    private:
+        /**
+         * @brief The number of stream slots.
+         */
+        static constexpr size_t SLOT_COUNT = 64;
+
+        /**
+         * @brief One file's sequential stream, on its own cache line.
+         */
+        struct alignas(64) Stream
+        {
+            /* Guards the other members. */
+            std::mutex mutex;
+
+            /* The file the stream belongs to, or null. */
+            const void *file = nullptr;
+
+            /* Where the next sequential read starts. */
+            size_t next = 0;
+
+            /* The current readahead window in bytes; 0 until the stream is sequential. */
+            size_t window = 0;
+
+            /* The end of the furthest range handed out for prefetching. */
+            size_t prefetchedTo = 0;
+        };
+
+        /**
+         * @brief The stream slots.
+         */
+        std::array<Stream, SLOT_COUNT> streams;
+    };
+
+} // namespace cse4733
+
+#endif // READAHEADTRACKER_HPP
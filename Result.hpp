@@ -0,0 +1,98 @@
+#ifndef RESULT_HPP
+#define RESULT_HPP
+
+#include <utility>
+
+namespace cse4733
+{
+
+    /**
+     * @brief Why an operation of the non-throwing try* API did not succeed.
+     *
+     * Each code corresponds to the exception the throwing API raises for the same failure.
+     */
+    enum class ErrorCode
+    {
+        /* The operation succeeded. */
+        Ok,
+
+        /* The file, or a directory on its path, does not exist (FileMissingException). */
+        NotFound,
+
+        /* A file or directory with the name already exists (FileAlreadyExistsException). */
+        AlreadyExists,
+
+        /* The path names a directory, or ends in "." or ".." (IsADirectoryException). */
+        IsADirectory,
+
+        /* A component of the path is not a directory (NotADirectoryException). */
+        NotADirectory,
+
+        /* Not enough blocks were free (NoFreeBlockAvailableException). */
+        NoSpace,
+
+        /* No inode was free (NoAvailableInodeException). */
+        NoInode,
+
+        /* Data failed its checksum or did not decompress (CorruptDataException). */
+        CorruptData,
+
+        /* The filesystem has not been formatted (UnformattedFilesystemException). */
+        Unformatted
+    };
+
+    /**
+     * @class Result
+     * @brief Either a value or the ErrorCode explaining why there is none.
+     *
+     * Returned by try* methods so that expected misses cost a comparison instead of
+     * a thrown exception. T must be default-constructible; a failed result holds a
+     * default-constructed value.
+     */
+    template <typename T>
+    class Result
+    {
+    public:
+        /**
+         * @brief A successful result holding a value.
+         */
+        Result(T value) : code(ErrorCode::Ok), stored(std::move(value)) {}
+
+        /**
+         * @brief A failed result. The code must not be ErrorCode::Ok.
+         */
+        Result(ErrorCode error) : code(error), stored() {}
+
+        /**
+         * @brief Returns true if the result holds a value.
+         */
+        bool ok() const { return code == ErrorCode::Ok; }
+
+        /**
+         * @brief Returns true if the result holds a value.
+         */
+        explicit operator bool() const { return ok(); }
+
+        /**
+         * @brief Returns ErrorCode::Ok, or why there is no value.
+         */
+        ErrorCode error() const { return code; }
+
+        /**
+         * @brief Returns the value. Only meaningful if ok() is true.
+         */
+        const T &value() const & { return stored; }
+        T &value() & { return stored; }
+        T &&value() && { return std::move(stored); }
+
+    private:
+        /* Ok, or why there is no value. */
+        ErrorCode code;
+
+        /* The value, default-constructed on failure. */
+        T stored;
+    };
+
+} // namespace cse4733
+
+#endif // RESULT_HPP
@@ -0,0 +1,70 @@
+#include "Snapshot.hpp"
+#include "FileMissingException.hpp"
+#include "IsADirectoryException.hpp"
+#include "NotADirectoryException.hpp"
+
+namespace cse4733
+{
+
+    Snapshot::Snapshot(unsigned int rootInode)
+        : rootInode(rootInode)
+    {
+    }
+
+    void Snapshot::addDirectory(unsigned int inodeIndex, const Directory &directory)
+    {
+        directories.emplace(inodeIndex, directory);
+    }
+
+    void Snapshot::addFile(unsigned int inodeIndex, File file)
+    {
+        files.emplace(inodeIndex, std::move(file));
+    }
+
+    unsigned int Snapshot::resolve(const std::string &path) const
+    {
+        // Walk the non-empty components from the root, each through the copied directory
+        unsigned int inodeIndex = rootInode;
+        size_t position = 0;
+        while (position < path.size())
+        {
+            size_t end = path.find('/', position);
+            if (end == std::string::npos)
+            {
+                end = path.size();
+            }
+            if (end > position)
+            {
+                inodeIndex = directory(inodeIndex, path).getInodeIndex(path.substr(position, end - position));
+            }
+            position = end + 1;
+        }
+        return inodeIndex;
+    }
+
+    const Directory &Snapshot::directory(unsigned int inodeIndex, const std::string &path) const
+    {
+        auto it = directories.find(inodeIndex);
+        if (it == directories.end())
+        {
+            throw NotADirectoryException(path);
+        }
+        return it->second;
+    }
+
+    const Snapshot::File &Snapshot::file(unsigned int inodeIndex, const std::string &path) const
+    {
+        auto it = files.find(inodeIndex);
+        if (it == files.end())
+        {
+            throw IsADirectoryException(path);
+        }
+        return it->second;
+    }
+
+    const std::unordered_map<unsigned int, Snapshot::File> &Snapshot::getFiles() const
+    {
+        return files;
+    }
+
+} // namespace cse4733
@@ -0,0 +1,111 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Directory.hpp"
+#include "Extent.hpp"
+
+namespace cse4733
+{
+
+    /**
+     * @class Snapshot
+     * @brief Read-only, point-in-time copy of a filesystem's namespace and file layout.
+     *
+     * A snapshot keeps a copy of every directory and the extent list and size of
+     * every regular file, but no file data other than that of inline files: it shares
+     * the data blocks with the live filesystem, which holds a block reference for each
+     * of its extents and copies a block before writing to it while the snapshot still
+     * references it.
+     */
+    class Snapshot
+    {
+    public:
+        /**
+         * @brief A regular file as it was when the snapshot was taken.
+         */
+        struct File
+        {
+            /* Size of the file in bytes. */
+            uint64_t size;
+
+            /* Whether the extents hold compressed data, see Inode::FLAG_COMPRESSED. */
+            bool compressed;
+
+            /* The file's extents, in file order. */
+            std::vector<Extent> extents;
+
+            /* The file's data if it was stored inline, see Inode::FLAG_INLINE; its extents are then empty. */
+            std::string contents;
+        };
+
+        /**
+         * @brief Constructs an empty snapshot.
+         *
+         * @param rootInode The inode index of the root directory.
+         */
+        explicit Snapshot(unsigned int rootInode);
+
+        /**
+         * @brief Records a directory's entries.
+         */
+        void addDirectory(unsigned int inodeIndex, const Directory &directory);
+
+        /**
+         * @brief Records a regular file's size and extents.
+         */
+        void addFile(unsigned int inodeIndex, File file);
+
+        /**
+         * @brief Resolves an absolute path, one component at a time.
+         *
+         * @param path An absolute path without "." or ".." components.
+         * @return The inode index the path referred to when the snapshot was taken.
+         * @throw FileMissingException if a component does not exist.
+         * @throw NotADirectoryException if a non-final component is not a directory.
+         */
+        unsigned int resolve(const std::string &path) const;
+
+        /**
+         * @brief Returns a recorded directory.
+         *
+         * @throw NotADirectoryException if the inode was not a directory.
+         */
+        const Directory &directory(unsigned int inodeIndex, const std::string &path) const;
+
+        /**
+         * @brief Returns a recorded regular file.
+         *
+         * @throw IsADirectoryException if the inode was a directory.
+         */
+        const File &file(unsigned int inodeIndex, const std::string &path) const;
+
+        /**
+         * @brief Returns every recorded regular file, keyed by inode index.
+         */
+        const std::unordered_map<unsigned int, File> &getFiles() const;
+
+    private:
+        /**
+         * @brief The inode index of the root directory.
+         */
+        unsigned int rootInode;
+
+        /**
+         * @brief Copies of every directory, keyed by inode index.
+         */
+        std::unordered_map<unsigned int, Directory> directories;
+
+        /**
+         * @brief Every regular file, keyed by inode index.
+         */
+        std::unordered_map<unsigned int, File> files;
+    };
+
+} // namespace cse4733
+
+#endif // SNAPSHOT_HPP
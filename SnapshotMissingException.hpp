@@ -0,0 +1,19 @@
+#ifndef SNAPSHOT_MISSING_EXCEPTION_HPP
+#define SNAPSHOT_MISSING_EXCEPTION_HPP
+
+#include <stdexcept>
+#include <string>
+
+namespace cse4733
+{
+
+    class SnapshotMissingException : public std::runtime_error
+    {
+    public:
+        explicit SnapshotMissingException(unsigned int snapshotId)
+            : std::runtime_error("Snapshot not found: " + std::to_string(snapshotId)) {}
+    };
+
+} // namespace cse4733
+
+#endif // SNAPSHOT_MISSING_EXCEPTION_HPP
@@ -0,0 +1,137 @@
+#include "TaskExecutor.hpp"
+
+#include <algorithm>
+
+namespace cse4733
+{
+
+    namespace
+    {
+        // The executor and deque of the worker running on this thread, if any
+        thread_local const TaskExecutor *currentExecutor = nullptr;
+        thread_local size_t currentWorker = 0;
+    } // namespace
+
+    TaskExecutor::TaskExecutor(size_t threadCount)
+    {
+        if (threadCount == 0)
+        {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        workerCount = threadCount;
+        workers = std::make_unique<Worker[]>(workerCount);
+        threads.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; ++i)
+        {
+            threads.emplace_back([this, i]()
+                                 { run(i); });
+        }
+    }
+
+    TaskExecutor::~TaskExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    void TaskExecutor::post(Task task)
+    {
+        // 1. Count the task under the sleep lock before queueing it, so a worker checking
+        //    for work cannot miss it and the count never drops below the queued tasks
+        // 2. Keep the task on the posting worker's own deque, or pick a deque round-robin
+        // 3. Wake one sleeping worker
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            queued.fetch_add(1, std::memory_order_relaxed);
+        }
+        size_t index = currentExecutor == this ? currentWorker
+                                               : nextWorker.fetch_add(1, std::memory_order_relaxed) % workerCount;
+        {
+            std::lock_guard<std::mutex> lock(workers[index].mutex);
+            workers[index].tasks.push_back(std::move(task));
+        }
+        wake.notify_one();
+    }
+
+    bool TaskExecutor::popLocal(size_t index, Task &task)
+    {
+        Worker &worker = workers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty())
+        {
+            return false;
+        }
+        task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+        return true;
+    }
+
+    bool TaskExecutor::steal(size_t thief, Task &task)
+    {
+        for (size_t offset = 1; offset < workerCount; ++offset)
+        {
+            Worker &victim = workers[(thief + offset) % workerCount];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void TaskExecutor::run(size_t index)
+    {
+        // 1. Run the newest local task, or steal the oldest task from another worker
+        // 2. With nothing to run, sleep until a task is posted
+        // 3. Exit once stopping and nothing is left queued
+        currentExecutor = this;
+        currentWorker = index;
+        while (true)
+        {
+            Task task;
+            if (popLocal(index, task) || steal(index, task))
+            {
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                try
+                {
+                    task();
+                }
+                catch (...)
+                {
+                    // Tasks report failure through their own futures
+                }
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this]()
+                      { return stopping || queued.load(std::memory_order_relaxed) > 0; });
+            if (stopping && queued.load(std::memory_order_relaxed) == 0)
+            {
+                return;
+            }
+        }
+    }
+
+    size_t TaskExecutor::getThreadCount() const
+    {
+        return workerCount;
+    }
+
+    size_t TaskExecutor::getStealCount() const
+    {
+        return steals.load(std::memory_order_relaxed);
+    }
+
+} // namespace cse4733
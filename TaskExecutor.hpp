@@ -0,0 +1,161 @@
+#ifndef TASKEXECUTOR_HPP
+#define TASKEXECUTOR_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace cse4733
+{
+
+    /**
+     * @class TaskExecutor
+     * @brief Fixed pool of worker threads that run posted tasks, balancing load by work stealing.
+     *
+     * Every worker owns a task deque. A task posted from inside a worker goes to the
+     * back of that worker's deque and is run from the back, so a task that fans out
+     * into subtasks keeps them hot in its own cache; a task posted from any other
+     * thread is spread over the deques round-robin. An idle worker steals from the
+     * front of the other deques, taking the oldest, typically largest, work first.
+     * Workers with nothing to do sleep until a task is posted.
+     *
+     * Tasks must not block waiting for other tasks of the same executor; completion
+     * should be signalled forward instead, e.g. by the last subtask to finish.
+     */
+    class TaskExecutor
+    {
+    public:
+        /**
+         * @brief A unit of work.
+         */
+        using Task = std::function<void()>;
+
+        /**
+         * @brief Starts the workers.
+         *
+         * @param threadCount The number of worker threads; 0 uses one per hardware thread.
+         */
+        explicit TaskExecutor(size_t threadCount = 0);
+
+        /**
+         * @brief Runs every task still queued, including tasks they post, then stops the workers.
+         */
+        ~TaskExecutor();
+
+        TaskExecutor(const TaskExecutor &) = delete;
+        TaskExecutor &operator=(const TaskExecutor &) = delete;
+
+        /**
+         * @brief Queues a task. Exceptions escaping the task are discarded.
+         */
+        void post(Task task);
+
+        /**
+         * @brief Queues a function and returns a future for its result or exception.
+         */
+        template <typename Function>
+        std::future<std::invoke_result_t<Function>> submit(Function function)
+        {
+            using Result = std::invoke_result_t<Function>;
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::move(function));
+            std::future<Result> result = task->get_future();
+            post([task]()
+                 { (*task)(); });
+            return result;
+        }
+
+        /**
+         * @brief Returns the number of worker threads.
+         */
+        size_t getThreadCount() const;
+
+        /**
+         * @brief Returns the number of tasks workers have taken from other workers' deques.
+         */
+        size_t getStealCount() const;
+
+    private:
+        /**
+         * @brief One worker's deque, on its own cache line.
+         */
+        struct alignas(64) Worker
+        {
+            /* Guards tasks. */
+            std::mutex mutex;
+
+            /* The owner pushes and pops at the back; thieves take from the front. */
+            std::deque<Task> tasks;
+        };
+
+        /**
+         * @brief The worker loop: run local tasks, then stolen ones, then sleep.
+         */
+        void run(size_t index);
+
+        /**
+         * @brief Pops the newest task from a worker's own deque.
+         */
+        bool popLocal(size_t index, Task &task);
+
+        /**
+         * @brief Takes the oldest task from another worker's deque, visiting them in turn.
+         */
+        bool steal(size_t thief, Task &task);
+
+        /**
+         * @brief The workers' deques, one per thread.
+         */
+        std::unique_ptr<Worker[]> workers;
+
+        /**
+         * @brief The number of workers.
+         */
+        size_t workerCount;
+
+        /**
+         * @brief The worker threads.
+         */
+        std::vector<std::thread> threads;
+
+        /**
+         * @brief The deque the next task posted from outside the pool goes to.
+         */
+        std::atomic<size_t> nextWorker{0};
+
+        /**
+         * @brief Tasks queued but not yet taken by a worker.
+         */
+        std::atomic<size_t> queued{0};
+
+        /**
+         * @brief Tasks taken from another worker's deque.
+         */
+        std::atomic<size_t> steals{0};
+
+        /**
+         * @brief Guards stopping, and orders posts against workers going to sleep.
+         */
+        std::mutex sleepMutex;
+
+        /**
+         * @brief Signalled when a task is posted or the executor stops.
+         */
+        std::condition_variable wake;
+
+        /**
+         * @brief Set by the destructor; workers exit once nothing is queued.
+         */
+        bool stopping = false;
+    };
+
+} // namespace cse4733
+
+#endif // TASKEXECUTOR_HPP
@@ -1,9 +1,14 @@
+#include <chrono>
+#include <future>
 #include <iostream>
 #include <vector>
 #include <string>
 #include <sstream>
+#include <thread>
 
+#include "FileBlockStore.hpp"
 #include "FileSystem.hpp"
+#include "MemoryBlockStore.hpp"
 #include "FileAlreadyExistsException.hpp"
 #include "FileMissingException.hpp"
 #include "NoAvailableInodeException.hpp"
@@ -16,9 +21,37 @@ void printHelp() {
               << "  create <filename>             - Create a new empty file\n"
               << "  write <filename> <data...>    - Write data to a file\n"
               << "  read <filename>               - Read and display file content\n"
+              << "  pread <filename> <off> <len>  - Read len bytes starting at offset off\n"
+              << "  pwrite <filename> <off> <data...> - Write data starting at offset off\n"
+              << "  append <filename> <data...>   - Append data to the end of a file\n"
+              << "  truncate <filename> <size>    - Shrink or extend a file to size bytes\n"
               << "  delete <filename>             - Delete a file\n"
-              << "  ls                            - List all files\n"
-              << "  stats                         - Show block usage stats\n"
+              << "  clone <source> <destination>  - Clone a file, sharing its blocks\n"
+              << "  mkdir <path>                  - Create a directory\n"
+              << "  rmdir <path>                  - Remove an empty directory\n"
+              << "  cd <path>                     - Change the current directory\n"
+              << "  pwd                           - Show the current directory\n"
+              << "  ls [path] [prefix]            - List files in a directory, optionally by name prefix\n"
+              << "  stats                         - Show block and inode usage stats\n"
+              << "  bench <file> <threads> <reads> - Read a file from several threads at once and report the throughput\n"
+              << "  abench <file> <reads>         - Issue many asynchronous reads of a file at once and report the throughput\n"
+              << "  ingest <prefix> <count> <bytes> - Create and write count files of bytes bytes each in one batch\n"
+              << "  dedup <on|off>                - Deduplicate identical blocks in whole-file writes\n"
+              << "  compress <on|off>             - Compress files that follow the volume setting\n"
+              << "  compressfile <file> <on|off|default> - Set whether one file is compressed\n"
+              << "  verify <on|off>               - Check block checksums on every read\n"
+              << "  cache <bytes> [file] | cache off - Keep block contents in a store behind a cache of bytes, from the next format\n"
+              << "  readahead <blocks>            - Prefetch up to this many blocks ahead of sequential reads; 0 turns it off\n"
+              << "  scrub [blocks]                - Verify the checksums of allocated blocks, all of them or the next few\n"
+              << "  snapshot                      - Take a read-only snapshot of every file\n"
+              << "  snapls <id> [path]            - List a directory as it was in a snapshot\n"
+              << "  snapread <id> <filename>      - Read a file as it was in a snapshot\n"
+              << "  snapdel <id>                  - Delete a snapshot\n"
+              << "  mkfs <image>                  - Create a disk image file and mount it\n"
+              << "  mount <image>                 - Mount an existing disk image file\n"
+              << "  sync                          - Write all changes to the mounted image\n"
+              << "  unmount                       - Sync and unmount the disk image\n"
+              << "  journal <file> [group]        - Replay a journal file and log every later change to it\n"
               << "  help                          - Show this help menu\n"
               << "  exit                          - Exit the program\n";
 }
@@ -86,6 +119,117 @@ int main() {
                         std::cout << filename << " is empty or does not exist.\n";
                     }
                 }
+            } else if (cmd == "bench") {
+                std::string filename;
+                size_t threads = 0, reads = 0;
+                if (!(iss >> filename >> threads >> reads) || threads == 0) {
+                    std::cout << "Usage: bench <filename> <threads> <reads per thread>\n";
+                } else {
+                    // Every thread reads the whole file into its own buffer, reads times
+                    size_t size = fs.readFile(filename).size();
+                    std::vector<std::thread> workers;
+                    std::vector<size_t> bytes(threads, 0);
+                    auto start = std::chrono::steady_clock::now();
+                    for (size_t t = 0; t < threads; ++t) {
+                        workers.emplace_back([&, t]() {
+                            std::vector<char> buffer(size);
+                            for (size_t i = 0; i < reads; ++i) {
+                                bytes[t] += fs.readInto(filename, buffer.data(), buffer.size());
+                            }
+                        });
+                    }
+                    for (std::thread &worker : workers) {
+                        worker.join();
+                    }
+                    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                    size_t total = 0;
+                    for (size_t count : bytes) {
+                        total += count;
+                    }
+                    std::cout << threads * reads << " reads of " << filename << " (" << total << " bytes) in " << seconds
+                              << " s, " << static_cast<size_t>(threads * reads / seconds) << " reads/s\n";
+                }
+            } else if (cmd == "abench") {
+                std::string filename;
+                size_t reads = 0;
+                if (!(iss >> filename >> reads) || reads == 0) {
+                    std::cout << "Usage: abench <filename> <reads>\n";
+                } else {
+                    // Issue every read up front, then wait for them all
+                    std::vector<std::future<std::string>> pending;
+                    pending.reserve(reads);
+                    auto start = std::chrono::steady_clock::now();
+                    for (size_t i = 0; i < reads; ++i) {
+                        pending.push_back(fs.readAsync(filename));
+                    }
+                    size_t total = 0;
+                    for (std::future<std::string> &result : pending) {
+                        total += result.get().size();
+                    }
+                    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                    std::cout << reads << " async reads of " << filename << " (" << total << " bytes) on "
+                              << fs.getAsyncThreadCount() << " threads in " << seconds << " s, "
+                              << static_cast<size_t>(reads / seconds) << " reads/s\n";
+                }
+            } else if (cmd == "ingest") {
+                std::string prefix;
+                size_t count = 0, bytes = 0;
+                if (!(iss >> prefix >> count >> bytes) || count == 0) {
+                    std::cout << "Usage: ingest <prefix> <count> <bytes per file>\n";
+                } else {
+                    // Create and fill every file in one batch, then count what failed
+                    std::vector<cse4733::BatchOperation> operations;
+                    operations.reserve(count * 2);
+                    for (size_t i = 0; i < count; ++i) {
+                        std::string path = prefix + std::to_string(i);
+                        operations.push_back({cse4733::BatchOperationType::Create, path, ""});
+                        operations.push_back({cse4733::BatchOperationType::Write, path, std::string(bytes, 'a' + i % 26)});
+                    }
+                    auto start = std::chrono::steady_clock::now();
+                    std::vector<cse4733::BatchResult> results = fs.runBatch(operations);
+                    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                    size_t failed = 0;
+                    for (const cse4733::BatchResult &result : results) {
+                        failed += result.status != cse4733::BatchStatus::Ok;
+                    }
+                    std::cout << results.size() << " operations (" << failed << " failed) in " << seconds << " s, "
+                              << static_cast<size_t>(results.size() / seconds) << " ops/s\n";
+                }
+            } else if (cmd == "pread") {
+                std::string filename;
+                size_t offset = 0, length = 0;
+                if (!(iss >> filename >> offset >> length)) {
+                    std::cout << "Usage: pread <filename> <offset> <length>\n";
+                } else {
+                    std::cout << filename << " [" << offset << ", +" << length << "): \""
+                              << fs.readFile(filename, offset, length) << "\"\n";
+                }
+            } else if (cmd == "pwrite" || cmd == "append") {
+                std::string filename;
+                size_t offset = 0;
+                iss >> filename;
+                bool validOffset = cmd == "append" || static_cast<bool>(iss >> offset);
+                std::string data;
+                std::getline(iss, data);
+                if (!data.empty() && data[0] == ' ') data.erase(0,1);
+                if (filename.empty() || !validOffset || data.empty()) {
+                    std::cout << (cmd == "append" ? "Usage: append <filename> <data>\n"
+                                                  : "Usage: pwrite <filename> <offset> <data>\n");
+                } else if (cmd == "append" ? fs.appendFile(filename, data) : fs.writeFile(filename, offset, data)) {
+                    std::cout << "Wrote to " << filename << ": \"" << data << "\"\n";
+                } else {
+                    std::cout << "Failed to write to " << filename << "\n";
+                }
+            } else if (cmd == "truncate") {
+                std::string filename;
+                size_t size = 0;
+                if (!(iss >> filename >> size)) {
+                    std::cout << "Usage: truncate <filename> <size>\n";
+                } else if (fs.truncateFile(filename, size)) {
+                    std::cout << "Truncated " << filename << " to " << size << " bytes\n";
+                } else {
+                    std::cout << "Failed to truncate " << filename << "\n";
+                }
             } else if (cmd == "delete") {
                 std::string filename;
                 iss >> filename;
@@ -96,18 +240,241 @@ int main() {
                 } else {
                     std::cout << "File not found: " << filename << "\n";
                 }
-            } else if (cmd == "ls") {
-                std::vector<std::string> files = fs.listFiles();
-                if (files.empty()) {
-                    std::cout << "(no files)\n";
+            } else if (cmd == "clone") {
+                std::string source, destination;
+                iss >> source >> destination;
+                if (destination.empty()) {
+                    std::cout << "Usage: clone <source> <destination>\n";
+                } else if (fs.cloneFile(source, destination)) {
+                    std::cout << "Cloned " << source << " to " << destination << "\n";
                 } else {
+                    std::cout << "Failed to clone " << source << "\n";
+                }
+            } else if (cmd == "mkdir") {
+                std::string path;
+                iss >> path;
+                if (path.empty()) {
+                    std::cout << "Usage: mkdir <path>\n";
+                } else if (fs.makeDirectory(path)) {
+                    std::cout << "Created directory: " << path << "\n";
+                } else {
+                    std::cout << "Failed to create directory: " << path << "\n";
+                }
+            } else if (cmd == "rmdir") {
+                std::string path;
+                iss >> path;
+                if (path.empty()) {
+                    std::cout << "Usage: rmdir <path>\n";
+                } else if (fs.removeDirectory(path)) {
+                    std::cout << "Removed directory: " << path << "\n";
+                } else {
+                    std::cout << "Failed to remove directory: " << path << "\n";
+                }
+            } else if (cmd == "cd") {
+                std::string path;
+                iss >> path;
+                fs.changeDirectory(path.empty() ? "/" : path);
+            } else if (cmd == "pwd") {
+                std::cout << fs.getCurrentDirectory() << "\n";
+            } else if (cmd == "ls") {
+                std::string path;
+                std::string prefix;
+                iss >> path >> prefix;
+                if (path.empty()) path = ".";
+                // Stream the listing a page at a time instead of materializing every name
+                const size_t pageSize = 256;
+                std::string cursor;
+                bool any = false;
+                while (true) {
+                    std::vector<std::string> files = fs.listFiles(path, cursor, pageSize, prefix);
                     for (const auto& f : files) {
-                        std::cout << f << "\n";
+                        std::cout << f << (fs.isDirectory(path + "/" + f) ? "/" : "") << "\n";
                     }
+                    any = any || !files.empty();
+                    if (files.size() < pageSize) break;
+                    cursor = files.back();
+                }
+                if (!any) {
+                    std::cout << "(no files)\n";
                 }
             } else if (cmd == "stats") {
                 std::cout << "Free blocks: " << fs.getFreeBlockCount()
                           << " / " << fs.getTotalBlockCount() << "\n";
+                std::cout << "Free inodes: " << fs.getFreeInodeCount()
+                          << " / " << fs.getTotalInodeCount() << "\n";
+                cse4733::DedupStats dedup = fs.getDedupStats();
+                if (fs.isDeduplicating() || dedup.logicalBlocks > 0) {
+                    double ratio = dedup.storedBlocks > 0 ? static_cast<double>(dedup.logicalBlocks) / dedup.storedBlocks : 1.0;
+                    std::cout << "Dedup: " << dedup.logicalBlocks << " blocks written, " << dedup.storedBlocks
+                              << " stored (ratio " << ratio << ":1), index " << dedup.indexEntries
+                              << " entries / " << dedup.indexBytes << " bytes\n";
+                }
+                cse4733::CacheStats cache = fs.getCacheStats();
+                if (cache.capacityBlocks > 0) {
+                    size_t accesses = cache.hits + cache.misses;
+                    double hitRate = accesses > 0 ? 100.0 * cache.hits / accesses : 0.0;
+                    std::cout << "Cache: " << cache.residentBlocks << " / " << cache.capacityBlocks
+                              << " blocks resident, hit rate " << hitRate << "%, " << cache.dirtyBlocks
+                              << " dirty, " << cache.evictions << " evictions, " << cache.writeBacks
+                              << " write-backs\n";
+                    std::cout << "Store I/O: " << cache.storeReads << " reads, " << cache.storeWrites
+                              << " writes; readahead " << cache.prefetchedBlocks << " blocks prefetched, "
+                              << cache.prefetchHits << " used, " << cache.prefetchEvictions
+                              << " evicted unused\n";
+                }
+                if (fs.isJournaling()) {
+                    std::cout << "Journal: " << fs.getJournalRecordCount() << " records in "
+                              << fs.getJournalCommitCount() << " commits\n";
+                }
+            } else if (cmd == "dedup") {
+                std::string mode;
+                iss >> mode;
+                if (mode != "on" && mode != "off") {
+                    std::cout << "Usage: dedup <on|off>\n";
+                } else {
+                    fs.setDeduplication(mode == "on");
+                    std::cout << "Deduplication " << mode << "\n";
+                }
+            } else if (cmd == "verify") {
+                std::string mode;
+                iss >> mode;
+                if (mode != "on" && mode != "off") {
+                    std::cout << "Usage: verify <on|off>\n";
+                } else {
+                    fs.setChecksumVerification(mode == "on");
+                    std::cout << "Checksum verification " << mode << "\n";
+                }
+            } else if (cmd == "cache") {
+                // The store is chosen now but only created by the next format
+                std::string budget, path;
+                iss >> budget >> path;
+                if (budget == "off") {
+                    fs.setBlockStore(nullptr, 0);
+                    std::cout << "Block cache off from the next format\n";
+                } else if (budget.empty() || budget.find_first_not_of("0123456789") != std::string::npos) {
+                    std::cout << "Usage: cache <bytes> [file] | cache off\n";
+                } else {
+                    size_t bytes = std::stoull(budget);
+                    if (path.empty()) {
+                        fs.setBlockStore([](size_t blockCount, size_t blockSize) {
+                            return std::make_unique<cse4733::MemoryBlockStore>(blockCount, blockSize);
+                        }, bytes);
+                    } else {
+                        fs.setBlockStore([path](size_t blockCount, size_t blockSize) {
+                            return std::make_unique<cse4733::FileBlockStore>(path, blockCount, blockSize);
+                        }, bytes);
+                    }
+                    std::cout << "Block cache of " << bytes << " bytes over "
+                              << (path.empty() ? std::string("memory") : path) << " from the next format\n";
+                }
+            } else if (cmd == "readahead") {
+                size_t blocks = 0;
+                if (!(iss >> blocks)) {
+                    std::cout << "Usage: readahead <blocks>\n";
+                } else {
+                    fs.setReadahead(blocks);
+                    std::cout << "Readahead window " << blocks << " blocks\n";
+                }
+            } else if (cmd == "scrub") {
+                size_t budget = 0;
+                bool step = static_cast<bool>(iss >> budget);
+                size_t checked = 0;
+                std::vector<uint32_t> corrupt;
+                cse4733::ScrubResult result;
+                do {
+                    result = fs.scrub(step ? budget : fs.getTotalBlockCount());
+                    checked += result.blocksChecked;
+                    corrupt.insert(corrupt.end(), result.corruptBlocks.begin(), result.corruptBlocks.end());
+                } while (!step && !result.passComplete);
+                std::cout << "Scrubbed " << checked << " blocks, " << corrupt.size() << " corrupt";
+                for (uint32_t block : corrupt) {
+                    std::cout << " " << block;
+                }
+                std::cout << (result.passComplete ? " (pass complete)\n" : "\n");
+            } else if (cmd == "compress") {
+                std::string mode;
+                iss >> mode;
+                if (mode != "on" && mode != "off") {
+                    std::cout << "Usage: compress <on|off>\n";
+                } else {
+                    fs.setCompression(mode == "on");
+                    std::cout << "Compression " << mode << "\n";
+                }
+            } else if (cmd == "compressfile") {
+                std::string filename, mode;
+                iss >> filename >> mode;
+                if (filename.empty() || (mode != "on" && mode != "off" && mode != "default")) {
+                    std::cout << "Usage: compressfile <filename> <on|off|default>\n";
+                } else {
+                    cse4733::CompressionPreference preference = mode == "on" ? cse4733::CompressionPreference::Always
+                                                              : mode == "off" ? cse4733::CompressionPreference::Never
+                                                                              : cse4733::CompressionPreference::Volume;
+                    if (fs.setFileCompression(filename, preference)) {
+                        std::cout << filename << " is " << (fs.isCompressed(filename) ? "compressed" : "not compressed") << "\n";
+                    } else {
+                        std::cout << "Failed to rewrite " << filename << "\n";
+                    }
+                }
+            } else if (cmd == "snapshot") {
+                std::cout << "Created snapshot " << fs.snapshot() << "\n";
+            } else if (cmd == "snapls") {
+                unsigned int id = 0;
+                std::string path;
+                if (!(iss >> id)) {
+                    std::cout << "Usage: snapls <id> [path]\n";
+                } else {
+                    iss >> path;
+                    std::vector<std::string> files = fs.listSnapshotFiles(id, path.empty() ? "." : path);
+                    for (const auto& f : files) {
+                        std::cout << f << "\n";
+                    }
+                    if (files.empty()) {
+                        std::cout << "(no files)\n";
+                    }
+                }
+            } else if (cmd == "snapread") {
+                unsigned int id = 0;
+                std::string filename;
+                if (!(iss >> id >> filename)) {
+                    std::cout << "Usage: snapread <id> <filename>\n";
+                } else {
+                    std::string content = fs.readSnapshotFile(id, filename);
+                    std::cout << filename << " in snapshot " << id << ": \"" << content << "\"\n";
+                }
+            } else if (cmd == "snapdel") {
+                unsigned int id = 0;
+                if (!(iss >> id)) {
+                    std::cout << "Usage: snapdel <id>\n";
+                } else {
+                    std::cout << (fs.deleteSnapshot(id) ? "Deleted snapshot " : "No such snapshot: ") << id << "\n";
+                }
+            } else if (cmd == "mkfs" || cmd == "mount") {
+                std::string path;
+                iss >> path;
+                if (path.empty()) {
+                    std::cout << "Usage: " << cmd << " <image>\n";
+                } else {
+                    if (cmd == "mkfs") {
+                        fs.createImage(path);
+                    } else {
+                        fs.mount(path);
+                    }
+                    std::cout << "Mounted image: " << path << "\n";
+                }
+            } else if (cmd == "sync") {
+                std::cout << (fs.sync() ? "Changes synced.\n" : "Failed to sync: no image, journal or block store, or out of space.\n");
+            } else if (cmd == "unmount") {
+                std::cout << (fs.unmount() ? "Image unmounted.\n" : "No image mounted.\n");
+            } else if (cmd == "journal") {
+                std::string path;
+                size_t groupSize = cse4733::Journal::DEFAULT_GROUP_SIZE;
+                iss >> path >> groupSize;
+                if (path.empty()) {
+                    std::cout << "Usage: journal <file> [group size]\n";
+                } else {
+                    fs.openJournal(path, groupSize);
+                    std::cout << "Journaling to: " << path << "\n";
+                }
             } else if (!cmd.empty()) {
                 std::cout << "Unknown command: " << cmd << "\n";
             }
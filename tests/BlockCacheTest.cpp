@@ -0,0 +1,110 @@
+#include "../BlockCache.hpp"
+#include "../MemoryBlockStore.hpp"
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace cse4733;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition "\n"; \
+            return 1; \
+        } \
+    } while (0)
+
+namespace
+{
+    const size_t BLOCK_SIZE = 512;
+    const size_t FRAMES = 256;
+
+    /**
+     * @brief Reads every block of a working set repeatedly and returns the fraction of accesses that hit.
+     */
+    double hitRate(BlockCache &cache, const std::vector<uint32_t> &blocks, size_t passes)
+    {
+        std::vector<char> buffer(BLOCK_SIZE);
+        CacheStats before = cache.getStats();
+        for (size_t pass = 0; pass < passes; pass++) {
+            for (uint32_t block: blocks) {
+                cache.read(block, 0, buffer.data(), BLOCK_SIZE);
+            }
+        }
+        CacheStats after = cache.getStats();
+        size_t hits = after.hits - before.hits;
+        size_t misses = after.misses - before.misses;
+        return static_cast<double>(hits) / static_cast<double>(hits + misses);
+    }
+}
+
+/**
+ * @brief A run of consecutive blocks smaller than the cache must stay resident, whatever shards it maps to.
+ */
+int testContiguousWorkingSet()
+{
+    BlockCache cache(std::make_unique<MemoryBlockStore>(4096, BLOCK_SIZE), FRAMES * BLOCK_SIZE);
+    CHECK(cache.getCapacity() == FRAMES);
+    for (size_t size: {47, 100, 192}) {
+        std::vector<uint32_t> blocks;
+        for (size_t i = 0; i < size; i++) {
+            blocks.push_back(static_cast<uint32_t>(1000 + i));
+        }
+        CHECK(hitRate(cache, blocks, 100) > 0.95);
+    }
+    return 0;
+}
+
+/**
+ * @brief A working set of scattered blocks smaller than the cache must stay resident too.
+ */
+int testScatteredWorkingSet()
+{
+    BlockCache cache(std::make_unique<MemoryBlockStore>(4096, BLOCK_SIZE), FRAMES * BLOCK_SIZE);
+    std::vector<uint32_t> blocks;
+    for (uint32_t i = 0; i < FRAMES / 4; i++) {
+        blocks.push_back(i * 37 % 4096);
+    }
+    CHECK(hitRate(cache, blocks, 100) > 0.95);
+    return 0;
+}
+
+/**
+ * @brief Everything one prefetch loads must still be resident when it is read, and prefetched
+ * blocks dropped unread must be counted.
+ */
+int testPrefetch()
+{
+    BlockCache cache(std::make_unique<MemoryBlockStore>(4096, BLOCK_SIZE), FRAMES * BLOCK_SIZE);
+    size_t limit = cache.getPrefetchLimit();
+    CHECK(limit >= FRAMES / 4 && limit <= FRAMES / 2);
+
+    cache.prefetch(1000, 4096);
+    CacheStats stats = cache.getStats();
+    CHECK(stats.prefetchedBlocks == limit);
+    std::vector<uint32_t> blocks;
+    for (size_t i = 0; i < limit; i++) {
+        blocks.push_back(static_cast<uint32_t>(1000 + i));
+    }
+    CHECK(hitRate(cache, blocks, 1) == 1.0);
+    CHECK(cache.getStats().prefetchHits == limit);
+
+    cache.prefetch(3000, static_cast<uint32_t>(limit));
+    blocks.clear();
+    for (size_t i = 0; i < 2 * FRAMES; i++) {
+        blocks.push_back(static_cast<uint32_t>(i));
+    }
+    hitRate(cache, blocks, 2);
+    stats = cache.getStats();
+    CHECK(stats.prefetchedBlocks == 2 * limit);
+    CHECK(stats.prefetchEvictions == limit);
+    return 0;
+}
+
+int main()
+{
+    int failures = testContiguousWorkingSet() + testScatteredWorkingSet() + testPrefetch();
+    std::cout << (failures == 0 ? "BlockCacheTest passed" : "BlockCacheTest failed") << "\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+#include "../FileSystem.hpp"
+
+#include <iostream>
+#include <string>
+
+using namespace cse4733;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition "\n"; \
+            return 1; \
+        } \
+    } while (0)
+
+namespace
+{
+    const size_t BLOCK_SIZE = 512;
+
+    /**
+     * @brief Writes a file of two-block extents, by interleaving its blocks with another file's.
+     */
+    std::string writeFragmented(FileSystem &fs, const std::string &filename, size_t extents)
+    {
+        std::string contents;
+        fs.createFile(filename);
+        fs.createFile("spacer");
+        for (size_t i = 0; i < extents; i++) {
+            std::string chunk(2 * BLOCK_SIZE, static_cast<char>('a' + i % 26));
+            fs.appendFile(filename, chunk);
+            fs.appendFile("spacer", chunk);
+            contents += chunk;
+        }
+        fs.deleteFile("spacer");
+        return contents;
+    }
+
+    /**
+     * @brief Fills the volume with a filler file, then one-block files, until exactly one block is left free.
+     */
+    bool leaveOneFreeBlock(FileSystem &fs)
+    {
+        fs.createFile("filler");
+        while (fs.getFreeBlockCount() > 1 && fs.appendFile("filler", std::string(BLOCK_SIZE, 'f'))) {
+        }
+        for (int i = 0; fs.getFreeBlockCount() > 1; i++) {
+            std::string filename = "filler" + std::to_string(i);
+            if (!fs.createFile(filename) || !fs.writeFile(filename, std::string(BLOCK_SIZE, 'f'))) {
+                return false;
+            }
+        }
+        return fs.getFreeBlockCount() == 1;
+    }
+
+    /**
+     * @brief Deletes the files leaveOneFreeBlock created.
+     */
+    void removeFillers(FileSystem &fs)
+    {
+        fs.deleteFile("filler");
+        for (int i = 0; fs.tryDeleteFile("filler" + std::to_string(i)) == ErrorCode::Ok; i++) {
+        }
+    }
+}
+
+/**
+ * @brief Copying a shared block succeeds, but splitting an extent pushes the file's extent records
+ * from the indirect block into double-indirect blocks that cannot be allocated; the write must fail
+ * and leave both files and the free space as they were.
+ */
+int testUnshareRollback()
+{
+    // Three direct extents and a full indirect block of 512-byte blocks
+    const size_t extents = 3 + BLOCK_SIZE / sizeof(Extent);
+    const size_t offset = 2 * BLOCK_SIZE * (extents - 1);
+
+    FileSystem fs(512 * BLOCK_SIZE, BLOCK_SIZE);
+    fs.format();
+    size_t initialFree = fs.getFreeBlockCount();
+    std::string contents = writeFragmented(fs, "a", extents);
+    CHECK(fs.cloneFile("a", "b"));
+    CHECK(leaveOneFreeBlock(fs));
+
+    CHECK(!fs.writeFile("a", offset, "x"));
+    CHECK(fs.getFreeBlockCount() == 1);
+    CHECK(fs.readFile("a") == contents);
+    CHECK(fs.readFile("b") == contents);
+
+    removeFillers(fs);
+    CHECK(fs.writeFile("a", offset, "x"));
+    contents[offset] = 'x';
+    CHECK(fs.readFile("a") == contents);
+    CHECK(fs.readFile("b") != contents);
+
+    fs.deleteFile("a");
+    fs.deleteFile("b");
+    CHECK(fs.getFreeBlockCount() == initialFree);
+    return 0;
+}
+
+/**
+ * @brief Growing a file by one block succeeds, but its extent records then need a pointer block
+ * that cannot be allocated; the append must fail and leave the file and the free space as they were.
+ */
+int testResizeRollback()
+{
+    FileSystem fs(256 * BLOCK_SIZE, BLOCK_SIZE);
+    fs.format();
+    std::string contents = writeFragmented(fs, "a", 3);
+    CHECK(leaveOneFreeBlock(fs));
+
+    CHECK(!fs.appendFile("a", std::string(BLOCK_SIZE, 'z')));
+    CHECK(fs.getFreeBlockCount() == 1);
+    CHECK(fs.readFile("a") == contents);
+    return 0;
+}
+
+int main()
+{
+    int failures = testUnshareRollback() + testResizeRollback();
+    std::cout << (failures == 0 ? "ExtentRollbackTest passed" : "ExtentRollbackTest failed") << "\n";
+    return failures == 0 ? 0 : 1;
+}